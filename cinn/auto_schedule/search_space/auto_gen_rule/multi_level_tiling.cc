@@ -119,12 +119,25 @@ std::vector<SearchState> MultiLevelTiling::ApplyOnBlock(SearchState state, const
   return {new_state};
 }
 
+int MultiLevelTiling::MaxInnermostFactor(const ir::Expr& block_expr) const {
+  if (target_->arch != common::Target::Arch::X86) {
+    return 64;
+  }
+  // the innermost tiles on X86 are vectorized, so they are bounded by a few vectors of the host CPU, e.g. 64 floats
+  // with AVX-512 and 32 floats with AVX2
+  auto stores = ir::CollectIRNodesWithoutTensor(
+      block_expr, [&](const Expr* x) { return x->As<ir::Store>(); }, true);
+  int type_bits = stores.empty() ? 32 : stores.begin()->As<ir::Store>()->tensor.as_tensor()->type().bits();
+  return std::max(target_->vector_bits() / std::max(type_bits, 8) * 4, 4);
+}
+
 void MultiLevelTiling::ApplyTiling(ir::IRSchedule* ir_schedule, ir::Expr& block_expr) {
   ir::ScheduleBlockRealize* sche_block_realize = block_expr.As<ir::ScheduleBlockRealize>();
   ir::ScheduleBlock* sche_block                = sche_block_realize->schedule_block.As<ir::ScheduleBlock>();
   tile_loops_.clear();
   tile_loops_.resize(config_.tile_struct.size());
   std::vector<Expr> for_exprs = ir_schedule->GetLoops(block_expr);
+  int max_innermost_factor    = MaxInnermostFactor(block_expr);
 
   VLOG(5) << "The number of loops to split in MultiLevelTiling is " << for_exprs.size();
   for (int i = for_exprs.size() - 1; i >= 0; --i) {
@@ -141,7 +154,8 @@ void MultiLevelTiling::ApplyTiling(ir::IRSchedule* ir_schedule, ir::Expr& block_
 
     int num_split = idx->size();
     if (num_split > 1) {
-      std::vector<Expr> tile_split_factor = ir_schedule->SamplePerfectTile(Expr(ir_for), num_split, 64);
+      std::vector<Expr> tile_split_factor =
+          ir_schedule->SamplePerfectTile(Expr(ir_for), num_split, max_innermost_factor);
       std::vector<Expr> splited           = ir_schedule->Split(Expr(ir_for), tile_split_factor);
       VLOG(6) << "Finish Split for MultiLevelTiling on above loop";
       for (int j = 0; j < num_split; ++j) {
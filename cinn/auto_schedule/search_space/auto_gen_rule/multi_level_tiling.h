@@ -118,6 +118,8 @@ class MultiLevelTiling : public AutoGenRule {
 
  private:
   void ApplyTiling(ir::IRSchedule* ir_schedule, ir::Expr& block_expr);
+  // the max factor of the innermost tile of a loop, which depends on the vector width on X86
+  int MaxInnermostFactor(const ir::Expr& block_expr) const;
   void ApplyCacheRead(ir::IRSchedule* ir_schedule, ir::Expr& block_expr);
   void ApplyCacheWrite(ir::IRSchedule* ir_schedule, ir::Expr& block_expr);
 
@@ -17,6 +17,18 @@
 namespace cinn {
 namespace backends {
 
+CodeGenCX86::Feature CodeGenCX86::GetFeature(const Target &target) {
+  int bits = target.vector_bits();
+  if (bits >= 512) {
+    return static_cast<Feature>(static_cast<int>(Feature::SSE) | static_cast<int>(Feature::AVX256) |
+                                static_cast<int>(Feature::AVX512));
+  }
+  if (bits >= 256) {
+    return static_cast<Feature>(static_cast<int>(Feature::SSE) | static_cast<int>(Feature::AVX256));
+  }
+  return Feature::SSE;
+}
+
 void CodeGenCX86::Visit(const ir::Add *op) { VisitBinaryOp(op, op->a(), op->b(), "add"); }
 void CodeGenCX86::Visit(const ir::Sub *op) { VisitBinaryOp(op, op->a(), op->b(), "sub"); }
 void CodeGenCX86::Visit(const ir::Mul *op) { VisitBinaryOp(op, op->a(), op->b(), "mul"); }
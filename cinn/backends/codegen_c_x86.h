@@ -46,6 +46,9 @@ class CodeGenCX86 : public CodeGenC {
    */
   CodeGenCX86(Target target, Feature feature) : CodeGenC(target), feature(feature) {}
 
+  //! Get the features of the vector width of \p target.
+  static Feature GetFeature(const Target &target);
+
  protected:
   void Visit(const ir::Add *op) override;
   void Visit(const ir::Sub *op) override;
@@ -141,7 +141,7 @@ void Compiler::CompileCudaModule(const Module& module, const std::string& code)
     symbols.RegisterVar(kernel_fn_name + "_ptr_", reinterpret_cast<void*>(fn_kernel));
   }
 
-  engine_ = ExecutionEngine::Create(ExecutionOptions(), std::move(symbols));
+  engine_ = ExecutionEngine::Create(options_, std::move(symbols));
   engine_->Link<CodeGenCUDA_Host>(host_module);
 
 #else
@@ -151,7 +151,7 @@ void Compiler::CompileCudaModule(const Module& module, const std::string& code)
 
 void Compiler::CompileX86Module(const Module& module) { engine_->Link<CodeGenX86>(module); }
 
-void Compiler::ExportObject(const std::string& path) { engine_->ExportObject(path); }
+bool Compiler::ExportObject(const std::string& path) { return engine_->ExportObject(path); }
 
 void* Compiler::Lookup(absl::string_view fn_name) {
   CHECK(engine_);
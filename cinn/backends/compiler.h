@@ -51,8 +51,8 @@ class SourceCodePrint {
 
 class Compiler final {
  public:
-  static std::unique_ptr<Compiler> Create(const Target& target) {
-    return std::unique_ptr<Compiler>(new Compiler(target));
+  static std::unique_ptr<Compiler> Create(const Target& target, const ExecutionOptions& options = ExecutionOptions()) {
+    return std::unique_ptr<Compiler>(new Compiler(target, options));
   }
 
   /**
@@ -60,7 +60,7 @@ class Compiler final {
    */
   void Build(const ir::Module& module, const std::string& code = "");
 
-  void ExportObject(const std::string& path);
+  bool ExportObject(const std::string& path);
 
   std::string GetSourceCode(const ir::Module& module);
 
@@ -77,12 +77,14 @@ class Compiler final {
 
   void CompileX86Module(const ir::Module& module);
 
-  explicit Compiler(const Target& target) : target_(target), engine_(ExecutionEngine::Create(ExecutionOptions())) {}
+  Compiler(const Target& target, const ExecutionOptions& options)
+      : target_(target), options_(options), engine_(ExecutionEngine::Create(options)) {}
 
   CINN_DISALLOW_COPY_AND_ASSIGN(Compiler);
 
  private:
   Target target_;
+  ExecutionOptions options_;
   std::unique_ptr<ExecutionEngine> engine_;
 
 #ifdef CINN_WITH_CUDA
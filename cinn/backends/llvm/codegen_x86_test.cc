@@ -14,12 +14,23 @@
 
 #include "cinn/backends/llvm/codegen_x86.h"
 
+#include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "cinn/backends/llvm/execution_engine.h"
+#include "cinn/backends/llvm/jit_event_listener.h"
 #include "cinn/backends/llvm/simple_jit.h"
 #include "cinn/cinn.h"
 #include "cinn/common/test_helper.h"
 #include "cinn/runtime/cinn_runtime.h"
+#include "cinn/utils/timer.h"
+
+DECLARE_bool(cinn_llvm_perf_map);
 
 namespace cinn {
 namespace backends {
@@ -69,5 +80,175 @@ TEST(Vectorize, basic) {
   }
 }
 
+// compare the time linking a module of many functions by different numbers of compile threads
+TEST(ExecutionEngine, CompileThreads) {
+  constexpr int kNumFuncs = 32;
+  Expr M(1024);
+  Placeholder<float> A("A", {M});
+  Placeholder<float> B("B", {M});
+  Module::Builder builder("module", common::DefaultHostTarget());
+  for (int i = 0; i < kNumFuncs; ++i) {
+    auto C = Compute(
+        {M}, [&](Expr j) { return A(j) * B(j) + Expr(static_cast<float>(i)); }, "C_" + std::to_string(i));
+    auto stages = CreateStages({C});
+    stages[C]->Vectorize(0, 8);
+    builder.AddFunction(Lower("fn_" + std::to_string(i), stages, {A, B, C}));
+  }
+  auto module = builder.Build();
+
+  auto* A_buf = common::BufferBuilder(Float(32), {1024}).set_random().set_align(64).Build();
+  auto* B_buf = common::BufferBuilder(Float(32), {1024}).set_random().set_align(64).Build();
+  auto* C_buf = common::BufferBuilder(Float(32), {1024}).set_zero().set_align(64).Build();
+  auto args   = common::ArgsBuilder().Add(A_buf).Add(B_buf).Add(C_buf).Build();
+
+  utils::Timer timer;
+  for (int num_threads : {1, 2, 4, 8}) {
+    ExecutionOptions options;
+    options.num_compile_threads = num_threads;
+    auto engine                 = ExecutionEngine::Create(options);
+    timer.Start();
+    engine->Link<CodeGenX86>(module);
+    std::vector<lower_func_ptr_t> fn_ptrs;
+    for (int i = 0; i < kNumFuncs; ++i) {
+      fn_ptrs.push_back(reinterpret_cast<lower_func_ptr_t>(engine->Lookup("fn_" + std::to_string(i))));
+    }
+    LOG(INFO) << "Compile " << kNumFuncs << " functions by " << num_threads << " threads in " << timer.Stop() << " ms";
+
+    fn_ptrs.back()(reinterpret_cast<void**>(args.data()), args.size());
+    auto* A_data = reinterpret_cast<float*>(A_buf->memory);
+    auto* B_data = reinterpret_cast<float*>(B_buf->memory);
+    auto* C_data = reinterpret_cast<float*>(C_buf->memory);
+    for (int i = 0; i < C_buf->num_elements(); i++) {
+      ASSERT_NEAR(A_data[i] * B_data[i] + kNumFuncs - 1, C_data[i], 1e-5);
+    }
+
+    // the object code of the modules linked by several compile threads isn't kept for exporting
+    std::string path = "./test_compile_threads.o";
+    ASSERT_EQ(engine->ExportObject(path), num_threads == 1);
+    std::remove(path.c_str());
+  }
+}
+
+TEST(ExecutionEngine, OptimizeOptions) {
+  Expr M(1024);
+  Placeholder<float> A("A", {M});
+  Placeholder<float> B("B", {M});
+  auto C = Compute(
+      {M}, [&](Expr i) { return A(i) * B(i) + A(i); }, "C");
+  auto stages = CreateStages({C});
+  Module::Builder builder("module", common::DefaultHostTarget());
+  builder.AddFunction(Lower("fn", stages, {A, B, C}));
+  auto module = builder.Build();
+
+  auto* A_buf = common::BufferBuilder(Float(32), {1024}).set_random().set_align(64).Build();
+  auto* B_buf = common::BufferBuilder(Float(32), {1024}).set_random().set_align(64).Build();
+  auto* C_buf = common::BufferBuilder(Float(32), {1024}).set_zero().set_align(64).Build();
+  auto args   = common::ArgsBuilder().Add(A_buf).Add(B_buf).Add(C_buf).Build();
+
+  std::vector<ExecutionOptions> configs(5);
+  configs[0].opt_level                             = 0;
+  configs[1].optimize_options.quick                = true;
+  configs[2].optimize_options.use_new_pass_manager = true;
+  configs[3].enable_fast_math                      = true;
+  configs[4].optimize_options.loop_vectorize       = false;
+  configs[4].optimize_options.slp_vectorize        = false;
+  configs[4].optimize_options.unroll_threshold     = 0;
+  utils::Timer timer;
+  for (auto& options : configs) {
+    auto engine = ExecutionEngine::Create(options);
+    timer.Start();
+    engine->Link<CodeGenX86>(module);
+    auto fn_ptr = reinterpret_cast<lower_func_ptr_t>(engine->Lookup("fn"));
+    LOG(INFO) << "Compile with " << options.ToString() << " in " << timer.Stop() << " ms";
+
+    fn_ptr(reinterpret_cast<void**>(args.data()), args.size());
+    auto* A_data = reinterpret_cast<float*>(A_buf->memory);
+    auto* B_data = reinterpret_cast<float*>(B_buf->memory);
+    auto* C_data = reinterpret_cast<float*>(C_buf->memory);
+    for (int i = 0; i < C_buf->num_elements(); i++) {
+      ASSERT_NEAR(A_data[i] * B_data[i] + A_data[i], C_data[i], 1e-5);
+    }
+  }
+}
+
+TEST(ExecutionEngine, ExportIsaVariants) {
+  Expr M(1024);
+  Placeholder<float> A("A", {M});
+  Placeholder<float> B("B", {M});
+  auto C = Compute(
+      {M}, [&](Expr i) { return A(i) * B(i) + B(i); }, "C");
+  auto stages = CreateStages({C});
+  stages[C]->Vectorize(0, 16);
+  Module::Builder builder("module", common::DefaultHostTarget());
+  builder.AddFunction(Lower("fn", stages, {A, B, C}));
+  auto module = builder.Build();
+
+  ExecutionOptions options;
+  options.export_isa_variants = {common::Target::Feature::SSE,
+                                 common::Target::Feature::AVX2,
+                                 common::Target::Feature::AVX512};
+  auto engine = ExecutionEngine::Create(options);
+  engine->Link<CodeGenX86>(module);
+  std::string path = "./test_export_isa_variants.o";
+  ASSERT_TRUE(engine->ExportObject(path));
+  // an unwritable path is reported rather than crashing
+  ASSERT_FALSE(engine->ExportObject("./not_existing_dir/test_export_isa_variants.o"));
+
+  // the exported object dispatches the function to the variant of the host CPU
+  auto loaded = ExecutionEngine::Create(ExecutionOptions());
+  ASSERT_TRUE(loaded->AddObjectFile(path));
+  auto* A_buf = common::BufferBuilder(Float(32), {1024}).set_random().set_align(64).Build();
+  auto* B_buf = common::BufferBuilder(Float(32), {1024}).set_random().set_align(64).Build();
+  auto* C_buf = common::BufferBuilder(Float(32), {1024}).set_zero().set_align(64).Build();
+  auto args   = common::ArgsBuilder().Add(A_buf).Add(B_buf).Add(C_buf).Build();
+  for (auto* fn : {engine->Lookup("fn"), loaded->Lookup("fn")}) {
+    ASSERT_NE(fn, nullptr);
+    reinterpret_cast<lower_func_ptr_t>(fn)(reinterpret_cast<void**>(args.data()), args.size());
+    auto* A_data = reinterpret_cast<float*>(A_buf->memory);
+    auto* B_data = reinterpret_cast<float*>(B_buf->memory);
+    auto* C_data = reinterpret_cast<float*>(C_buf->memory);
+    for (int i = 0; i < C_buf->num_elements(); i++) {
+      ASSERT_NEAR(A_data[i] * B_data[i] + B_data[i], C_data[i], 1e-5);
+    }
+  }
+  // only the trampolines are visible
+  ASSERT_EQ(loaded->Lookup("fn.avx2"), nullptr);
+  std::remove(path.c_str());
+}
+
+TEST(ExecutionEngine, PerfMap) {
+  FLAGS_cinn_llvm_perf_map = true;
+  Expr M(128);
+  Placeholder<float> A("A", {M});
+  auto B = Compute(
+      {M}, [&](Expr i) { return A(i) * A(i); }, "B");
+  auto stages = CreateStages({B});
+  Module::Builder builder("module", common::DefaultHostTarget());
+  builder.AddFunction(Lower("perf_map_fn", stages, {A, B}));
+
+  auto engine = ExecutionEngine::Create(ExecutionOptions());
+  engine->Link<CodeGenX86>(builder.Build());
+  auto* fn = engine->Lookup("perf_map_fn");
+  ASSERT_NE(fn, nullptr);
+  FLAGS_cinn_llvm_perf_map = false;
+
+  // the map holds "<start> <size> <name>" in hex, and the function starts at the address looked up
+  std::ifstream ifs(PerfMapListener::Global()->path());
+  std::string line;
+  bool found = false;
+  while (std::getline(ifs, line)) {
+    std::stringstream ss(line);
+    uint64_t start, size;
+    std::string name;
+    ss >> std::hex >> start >> size >> name;
+    if (name == "perf_map_fn") {
+      found = true;
+      ASSERT_EQ(start, reinterpret_cast<uint64_t>(fn));
+      ASSERT_GT(size, 0u);
+    }
+  }
+  ASSERT_TRUE(found);
+}
+
 }  // namespace backends
 }  // namespace cinn
@@ -30,6 +30,7 @@
 #include <llvm/IR/PassManager.h>
 #include <llvm/IR/Verifier.h>
 #include <llvm/IRReader/IRReader.h>
+#include <llvm/Linker/Linker.h>
 #include <llvm/InitializePasses.h>
 #include <llvm/PassRegistry.h>
 #include <llvm/Passes/PassBuilder.h>
@@ -47,22 +48,36 @@
 #include <llvm/Transforms/Scalar/NewGVN.h>
 #include <llvm/Transforms/Scalar/Reassociate.h>
 #include <llvm/Transforms/Scalar/SimplifyCFG.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <cmath>
+#include <cstdio>
+#include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <numeric>
+#include <sstream>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 
 #include "cinn/backends/codegen_cuda_host.h"
 #include "cinn/backends/llvm/cinn_runtime_llvm_ir.h"
 #include "cinn/backends/llvm/codegen_llvm.h"
 #include "cinn/backends/llvm/codegen_x86.h"
+#include "cinn/backends/llvm/isa_dispatch.h"
+#include "cinn/backends/llvm/jit_event_listener.h"
 #include "cinn/backends/llvm/llvm_optimizer.h"
 #include "cinn/backends/llvm/llvm_util.h"
 #include "cinn/backends/llvm/runtime_symbol_registry.h"
+#include "cinn/common/target.h"
+#include "cinn/ir/collect_ir_nodes.h"
 #include "cinn/ir/ir_printer.h"
 #include "cinn/runtime/intrinsic.h"
+#include "cinn/utils/multi_threading.h"
 #include "cinn/utils/profiler.h"
 
 namespace cinn::backends {
@@ -86,13 +101,215 @@ void InitializeLLVMPasses() {
   // llvm::initializeTarget(registry);
   // llvm::initializeCodeGenPreparePass(registry);
 }
+
+// the object code is position independent, so that the exported objects can be linked into a shared library, and
+// the objects generated by the JIT and for exporting are the same
+llvm::orc::JITTargetMachineBuilder HostTargetMachineBuilder(const ExecutionOptions &options) {
+  auto jtmb = llvm::cantFail(llvm::orc::JITTargetMachineBuilder::detectHost());
+  jtmb.setRelocationModel(llvm::Reloc::PIC_);
+  jtmb.setCodeGenOptLevel(GetCodeGenOptLevel(options.opt_level, options.optimize_options));
+  return jtmb;
+}
+
+std::unique_ptr<llvm::TargetMachine> CreateHostTargetMachine(const ExecutionOptions &options) {
+  return llvm::cantFail(HostTargetMachineBuilder(options).createTargetMachine());
+}
+
+// the options of the target machine affecting the object code, which is a part of the key of the object cache
+std::string TargetKey(const llvm::orc::JITTargetMachineBuilder &jtmb, const ExecutionOptions &options) {
+  std::stringstream ss;
+  ss << jtmb.getTargetTriple().str() << " cpu=" << jtmb.getCPU() << " features=" << jtmb.getFeatures().getString()
+     << " " << options.ToString() << " pic";
+  return ss.str();
+}
+
+void EmitObject(llvm::TargetMachine *machine, llvm::Module *m, llvm::SmallString<0> *buffer) {
+  llvm::raw_svector_ostream rawstream(*buffer);
+  llvm::legacy::PassManager pass_manager;
+  machine->addPassesToEmitFile(pass_manager, rawstream, nullptr, llvm::CGFT_ObjectFile);
+  pass_manager.run(*m);
+}
+
+/**
+ * Split the functions of a module into at most num_partitions modules. The functions calling each other are kept in
+ * the same module, since a call is resolved in the LLVM module it is emitted into.
+ */
+std::vector<ir::Module> SplitModule(const ir::Module &module, int num_partitions) {
+  auto functions = module.functions();
+  int num_funcs  = functions.size();
+  std::unordered_map<std::string, int> func_idx;
+  for (int i = 0; i < num_funcs; ++i) {
+    func_idx[functions[i]->name] = i;
+  }
+
+  // union the functions by the calls between them
+  std::vector<int> parent(num_funcs);
+  std::iota(parent.begin(), parent.end(), 0);
+  std::function<int(int)> find_root = [&](int idx) {
+    return parent[idx] == idx ? idx : parent[idx] = find_root(parent[idx]);
+  };
+  for (int i = 0; i < num_funcs; ++i) {
+    ir::CollectIRNodesWithoutTensor(functions[i]->body, [&](const Expr *x) {
+      auto *call = x->As<ir::Call>();
+      if (call && func_idx.count(call->name)) {
+        parent[find_root(i)] = find_root(func_idx.at(call->name));
+      }
+      return false;
+    });
+  }
+
+  // assign the connected functions to the partitions in turn
+  std::vector<ir::Module::Builder> builders;
+  std::unordered_map<int, int> partition_of_root;
+  for (int i = 0; i < num_funcs; ++i) {
+    int root = find_root(i);
+    if (!partition_of_root.count(root)) {
+      int partition = partition_of_root.size() % num_partitions;
+      partition_of_root.emplace(root, partition);
+      if (partition == builders.size()) {
+        builders.emplace_back(module.name() + "_" + std::to_string(partition), module.target());
+      }
+    }
+    builders[partition_of_root.at(root)].AddFunction(functions[i]);
+  }
+
+  std::vector<ir::Module> modules;
+  for (auto &builder : builders) {
+    modules.emplace_back(builder.Build());
+  }
+  return modules;
+}
+
+/**
+ * Lower a module to an optimized LLVM module in \p ctx. The runtime functions in the LLVM module are made internal
+ * if \p internalize_runtime, so that the LLVM modules split from one module, or the objects of several modules
+ * linked into one library, don't define them repeatedly. The module is compiled for the host, or for the
+ * instruction set of \p variant if it is given.
+ */
+template <typename CodeGenT>
+std::unique_ptr<llvm::Module> EmitLLVMModule(const ir::Module &module,
+                                             llvm::LLVMContext *ctx,
+                                             llvm::TargetMachine *machine,
+                                             const ExecutionOptions &options,
+                                             bool internalize_runtime,
+                                             const IsaVariant *variant = nullptr) {
+  llvm::SMDiagnostic error;
+  auto m = llvm::parseAssemblyString(AsStringRef(backends::kRuntimeLlvmIr), error, *ctx);
+  if (internalize_runtime) {
+    for (auto &gv : m->global_values()) {
+      if (gv.isDeclaration()) continue;
+      if (auto *go = llvm::dyn_cast<llvm::GlobalObject>(&gv)) go->setComdat(nullptr);
+      gv.setLinkage(llvm::GlobalValue::InternalLinkage);
+    }
+  }
+  auto b = std::make_unique<llvm::IRBuilder<>>(*ctx);
+  // the instructions of kernels are created by the builder, so the flags don't affect the runtime functions
+  b->setFastMathFlags(options.GetFastMathFlags());
+  auto ir_emitter = std::make_unique<CodeGenT>(m.get(), b.get());
+  VLOG(3) << "ir_emitter->Compile(module) Begin";
+  ir_emitter->Compile(module);
+  VLOG(3) << "ir_emitter->Compile(module) Succeed!";
+  CHECK(!llvm::verifyModule(*m, &llvm::errs())) << "Invalid module found";
+
+  if (variant) {
+    std::vector<std::string> fn_names;
+    for (auto &fn : module.functions()) {
+      fn_names.push_back(fn->name);
+    }
+    SetIsaVariant(m.get(), fn_names, *variant);
+  } else {
+    // keep the vectors of the kernels in the registers of the vector width of the host, LLVM splits the 512-bit
+    // vectors into 256-bit ones on some AVX-512 CPUs by default
+    auto vector_bits = std::to_string(common::DefaultHostTarget().vector_bits());
+    for (auto &f : *m) {
+      if (f.isDeclaration()) continue;
+      f.addFnAttr("prefer-vector-width", vector_bits);
+      f.addFnAttr("min-legal-vector-width", vector_bits);
+    }
+  }
+
+  LLVMModuleOptimizer optimize(machine, options.opt_level, options.optimize_options, true);
+  optimize(m.get());
+  CHECK(!llvm::verifyModule(*m, &llvm::errs())) << "Invalid optimized module detected";
+  for (auto &f : *m) {
+    VLOG(5) << "function: " << DumpToString(f);
+  }
+  return m;
+}
+
+std::unique_ptr<llvm::TargetMachine> CreateIsaTargetMachine(const std::string &cpu, const ExecutionOptions &options) {
+  llvm::orc::JITTargetMachineBuilder jtmb(llvm::Triple(llvm::sys::getProcessTriple()));
+  jtmb.setCPU(cpu);
+  jtmb.setRelocationModel(llvm::Reloc::PIC_);
+  jtmb.setCodeGenOptLevel(GetCodeGenOptLevel(options.opt_level, options.optimize_options));
+  return llvm::cantFail(jtmb.createTargetMachine());
+}
+
+/**
+ * Emit the object code of a module with the kernels compiled for each of options.export_isa_variants, which are
+ * dispatched by the trampolines named as the kernels.
+ */
+template <typename CodeGenT>
+void EmitMultiVersionedObject(const ir::Module &module,
+                              const ExecutionOptions &options,
+                              llvm::SmallString<0> *buffer) {
+  utils::RecordEvent("ExecutionEngine EmitMultiVersionedObject", utils::EventType::kOrdinary);
+  auto variants = GetIsaVariants(options.export_isa_variants);
+  std::vector<std::string> fn_names;
+  for (auto &fn : module.functions()) {
+    fn_names.push_back(fn->name);
+  }
+
+  // the generic machine emits the trampolines, and the variants by the target-cpu attributes of their functions
+  auto machine = CreateIsaTargetMachine("x86-64", options);
+  llvm::LLVMContext ctx;
+  std::unique_ptr<llvm::Module> linked;
+  for (auto &variant : variants) {
+    auto variant_machine = CreateIsaTargetMachine(variant.cpu, options);
+    auto m               = EmitLLVMModule<CodeGenT>(module, &ctx, variant_machine.get(), options, true, &variant);
+    m->setDataLayout(machine->createDataLayout());
+    m->setTargetTriple(machine->getTargetTriple().str());
+    if (!linked) {
+      linked = std::move(m);
+    } else {
+      CHECK(!llvm::Linker::linkModules(*linked, std::move(m))) << "Failed to link the " << variant.suffix << " variant";
+    }
+  }
+  AddIsaDispatchers(linked.get(), fn_names, variants);
+  CHECK(!llvm::verifyModule(*linked, &llvm::errs())) << "Invalid multi-versioned module detected";
+  EmitObject(machine.get(), linked.get(), buffer);
+  VLOG(3) << "Emit " << fn_names.size() << " functions in " << variants.size() << " instruction set variants";
+}
 }  // namespace
+
+llvm::FastMathFlags ExecutionOptions::GetFastMathFlags() const {
+  auto flags = optimize_options.GetFastMathFlags();
+  if (enable_fast_math) {
+    flags.setFast();
+  }
+  return flags;
+}
+
+std::string ExecutionOptions::ToString() const {
+  std::stringstream ss;
+  ss << "opt_level=" << opt_level << " fast_math=" << enable_fast_math << " " << optimize_options.ToString();
+  if (!export_isa_variants.empty()) {
+    ss << " export_isa_variants=";
+    for (auto feature : export_isa_variants) {
+      ss << static_cast<int>(feature) << ",";
+    }
+  }
+  return ss.str();
+}
+
 void NaiveObjectCache::notifyObjectCompiled(const llvm::Module *m, llvm::MemoryBufferRef obj_buffer) {
+  std::lock_guard<std::mutex> lock(mu_);
   cached_objects_[m->getModuleIdentifier()] =
       llvm::MemoryBuffer::getMemBufferCopy(obj_buffer.getBuffer(), obj_buffer.getBufferIdentifier());
 }
 
 std::unique_ptr<llvm::MemoryBuffer> NaiveObjectCache::getObject(const llvm::Module *m) {
+  std::lock_guard<std::mutex> lock(mu_);
   auto it = cached_objects_.find(m->getModuleIdentifier());
   if (it == cached_objects_.end()) {
     VLOG(1) << "No object for " << m->getModuleIdentifier() << " in cache. Compiling.";
@@ -118,19 +335,34 @@ std::unique_ptr<llvm::MemoryBuffer> NaiveObjectCache::getObject(const llvm::Modu
   std::call_once(flag, InitializeLLVMPasses);
 
   auto engine = std::make_unique<ExecutionEngine>(/*enable_object_cache=*/true, std::move(module_symbols));
+  engine->options_             = config;
+  engine->num_compile_threads_ = std::max(config.num_compile_threads, 1);
+  auto jtmb                    = HostTargetMachineBuilder(config);
+  engine->disk_cache_          = DiskObjectCache::CreateFromFlags(TargetKey(jtmb, config));
+  llvm::ObjectCache *cache     = engine->disk_cache_ ? static_cast<llvm::ObjectCache *>(engine->disk_cache_.get())
+                                                     : static_cast<llvm::ObjectCache *>(engine->cache_.get());
 
-  auto compile_layer_creator = [&engine](llvm::orc::JITTargetMachineBuilder jtmb)
+  auto compile_layer_creator = [&engine, cache](llvm::orc::JITTargetMachineBuilder jtmb)
       -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+    if (engine->num_compile_threads_ > 1) {
+      // the compiler is called by the compile threads concurrently, and creates a target machine for each module
+      VLOG(1) << "create llvm concurrent compile layer with " << engine->num_compile_threads_ << " threads";
+      return std::make_unique<llvm::orc::ConcurrentIRCompiler>(std::move(jtmb), cache);
+    }
     auto machine = llvm::cantFail(jtmb.createTargetMachine());
     VLOG(1) << "create llvm compile layer";
     VLOG(1) << "Target Name: " << machine->getTarget().getName();
     VLOG(1) << "Target CPU: " << machine->getTargetCPU().str() << std::endl;
-    return std::make_unique<llvm::orc::TMOwningSimpleCompiler>(std::move(machine), engine->cache_.get());
+    return std::make_unique<llvm::orc::TMOwningSimpleCompiler>(std::move(machine), cache);
   };
 
   auto object_layer_creator = [&](llvm::orc::ExecutionSession &session, const llvm::Triple &triple) {
     auto object_layer = std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(
         session, []() { return std::make_unique<llvm::SectionMemoryManager>(); });
+    // the profilers and debuggers resolve the code of kernels by the listeners
+    for (auto *listener : GetJITEventListenersFromFlags()) {
+      object_layer->registerJITEventListener(*listener);
+    }
     llvm::orc::JITDylib *main_jd = session.getJITDylibByName("<main>");
     if (!main_jd) {
       main_jd = &llvm::cantFail(session.createJITDylib("<main>"));
@@ -139,10 +371,14 @@ std::unique_ptr<llvm::MemoryBuffer> NaiveObjectCache::getObject(const llvm::Modu
   };
 
   VLOG(2) << "create jit execution engine";
-  engine->jit_ = llvm::cantFail(llvm::orc::LLJITBuilder()
-                                    .setCompileFunctionCreator(compile_layer_creator)
-                                    .setObjectLinkingLayerCreator(object_layer_creator)
-                                    .create());
+  llvm::orc::LLJITBuilder jit_builder;
+  jit_builder.setJITTargetMachineBuilder(std::move(jtmb))
+      .setCompileFunctionCreator(compile_layer_creator)
+      .setObjectLinkingLayerCreator(object_layer_creator);
+  if (engine->num_compile_threads_ > 1) {
+    jit_builder.setNumCompileThreads(engine->num_compile_threads_);
+  }
+  engine->jit_ = llvm::cantFail(jit_builder.create());
   engine->jit_->getMainJITDylib().addGenerator(llvm::cantFail(
       llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(engine->jit_->getDataLayout().getGlobalPrefix())));
 
@@ -157,32 +393,56 @@ std::unique_ptr<llvm::MemoryBuffer> NaiveObjectCache::getObject(const llvm::Modu
 template <typename CodeGenT>
 void ExecutionEngine::Link(const ir::Module &module) {
   utils::RecordEvent("ExecutionEngine Link", utils::EventType::kOrdinary);
-  llvm::SMDiagnostic error;
-  auto ctx        = std::make_unique<llvm::LLVMContext>();
-  auto m          = llvm::parseAssemblyString(AsStringRef(backends::kRuntimeLlvmIr), error, *ctx);
-  auto b          = std::make_unique<llvm::IRBuilder<>>(*ctx);
-  auto ir_emitter = std::make_unique<CodeGenT>(m.get(), b.get());
-  VLOG(3) << "ir_emitter->Compile(module) Begin";
-  ir_emitter->Compile(module);
-  VLOG(3) << "ir_emitter->Compile(module) Succeed!";
-  CHECK(!llvm::verifyModule(*m, &llvm::errs())) << "Invalid module found";
+  auto partitions = num_compile_threads_ > 1 ? SplitModule(module, num_compile_threads_) : std::vector<ir::Module>();
+  if (partitions.size() > 1) {
+    // lower and optimize the partitions concurrently, each in a context of its own
+    int num_partitions = partitions.size();
+    std::vector<std::unique_ptr<llvm::LLVMContext>> contexts(num_partitions);
+    std::vector<std::unique_ptr<llvm::Module>> llvm_modules(num_partitions);
+    utils::parallel_run(
+        [&](int idx) {
+          contexts[idx]     = std::make_unique<llvm::LLVMContext>();
+          auto machine      = CreateHostTargetMachine(options_);
+          llvm_modules[idx] =
+              EmitLLVMModule<CodeGenT>(partitions[idx], contexts[idx].get(), machine.get(), options_, true);
+          llvm_modules[idx]->setModuleIdentifier(partitions[idx].name());
+        },
+        utils::SequenceDispatcher(0, num_partitions),
+        num_partitions);
+    LinkPartitions(module, std::move(llvm_modules), std::move(contexts));
+  } else {
+    auto ctx     = std::make_unique<llvm::LLVMContext>();
+    auto machine = CreateHostTargetMachine(options_);
+    auto m       = EmitLLVMModule<CodeGenT>(module, ctx.get(), machine.get(), options_, true);
 
-  auto machine =
-      std::move(llvm::cantFail(llvm::cantFail(llvm::orc::JITTargetMachineBuilder::detectHost()).createTargetMachine()));
-  LLVMModuleOptimizer optimize(machine.get(), 3, {}, true);
-  optimize(m.get());
-  CHECK(!llvm::verifyModule(*m, &llvm::errs())) << "Invalid optimized module detected";
-  for (auto &f : *m) {
-    VLOG(5) << "function: " << DumpToString(f);
+    // the JIT runs the code for the host, and the object to export holds the variants of the instruction sets if
+    // they are given
+    bool multi_versioned = !options_.export_isa_variants.empty() && std::is_same<CodeGenT, CodeGenX86>::value;
+    if (multi_versioned) {
+      EmitMultiVersionedObject<CodeGenT>(module, options_, &buffer_);
+    }
+    if (disk_cache_) {
+      // the object emitted for exporting is added to the JIT as well, so the module is compiled at most once
+      llvm::SmallString<0> object;
+      if (auto cached = disk_cache_->getObject(m.get())) {
+        object.append(cached->getBufferStart(), cached->getBufferEnd());
+      } else {
+        EmitObject(machine.get(), m.get(), &object);
+        disk_cache_->notifyObjectCompiled(m.get(), llvm::MemoryBufferRef(object.str(), m->getModuleIdentifier()));
+      }
+      if (!multi_versioned) {
+        buffer_.append(object.begin(), object.end());
+      }
+      std::lock_guard<std::mutex> lock(mu_);
+      llvm::cantFail(jit_->addObjectFile(llvm::MemoryBuffer::getMemBufferCopy(object.str(), m->getModuleIdentifier())));
+    } else {
+      if (!multi_versioned) {
+        EmitObject(machine.get(), m.get(), &buffer_);
+      }
+      CHECK(AddModule(std::move(m), std::move(ctx)));
+    }
   }
 
-  llvm::raw_svector_ostream rawstream(buffer_);
-  llvm::legacy::PassManager pass_manager;
-  machine->addPassesToEmitFile(pass_manager, rawstream, nullptr, llvm::CGFT_ObjectFile);
-  pass_manager.run(*m);
-
-  CHECK(AddModule(std::move(m), std::move(ctx)));
-
   if (VLOG_IS_ON(5)) {
     VLOG(5) << "======= dump jit execution session ======";
     std::string buffer;
@@ -194,6 +454,27 @@ void ExecutionEngine::Link(const ir::Module &module) {
   }
 }
 
+void ExecutionEngine::LinkPartitions(const ir::Module &module,
+                                     std::vector<std::unique_ptr<llvm::Module>> &&llvm_modules,
+                                     std::vector<std::unique_ptr<llvm::LLVMContext>> &&contexts) {
+  utils::RecordEvent("ExecutionEngine LinkPartitions", utils::EventType::kOrdinary);
+  for (int idx = 0; idx < llvm_modules.size(); ++idx) {
+    CHECK(AddModule(std::move(llvm_modules[idx]), std::move(contexts[idx])));
+  }
+  linked_partitions_ = true;
+
+  // look up all the functions at once, so that the modules are materialized by the compile threads concurrently
+  // instead of one by one on the later lookups
+  llvm::orc::SymbolLookupSet symbols;
+  for (auto &fn : module.functions()) {
+    symbols.add(jit_->mangleAndIntern(fn->name));
+  }
+  std::lock_guard<std::mutex> lock(mu_);
+  llvm::cantFail(jit_->getExecutionSession().lookup(
+      llvm::orc::makeJITDylibSearchOrder(&jit_->getMainJITDylib()), std::move(symbols)));
+  VLOG(3) << "Link " << llvm_modules.size() << " partitions of module " << module.name() << " concurrently";
+}
+
 bool ExecutionEngine::AddModule(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context) {
   utils::RecordEvent("ExecutionEngine AddModule", utils::EventType::kOrdinary);
   module->setDataLayout(jit_->getDataLayout());
@@ -212,10 +493,42 @@ bool ExecutionEngine::AddModule(std::unique_ptr<llvm::Module> module, std::uniqu
   return true;
 }
 
-void ExecutionEngine::ExportObject(const std::string &path) {
-  FILE *of = fopen(path.c_str(), "w");
-  fwrite(buffer_.data(), 1, buffer_.size(), of);
-  fclose(of);
+bool ExecutionEngine::ExportObject(const std::string &path) {
+  if (linked_partitions_) {
+    LOG(WARNING) << "The module linked by several compile threads can't be exported to " << path
+                 << ", set ExecutionOptions::num_compile_threads to 1";
+    return false;
+  }
+  // write into a temporary file and rename it, so a reader never observes a truncated object
+  std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+  FILE *of             = fopen(tmp_path.c_str(), "wb");
+  if (!of) {
+    LOG(WARNING) << "Failed to open " << tmp_path << " to export the object, errno = " << errno;
+    return false;
+  }
+  bool written = fwrite(buffer_.data(), 1, buffer_.size(), of) == buffer_.size();
+  written      = (fclose(of) == 0) && written;
+  if (!written || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to export the object to " << path << ", errno = " << errno;
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ExecutionEngine::AddObjectFile(const std::string &path) {
+  utils::RecordEvent("ExecutionEngine AddObjectFile", utils::EventType::kOrdinary);
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    LOG(WARNING) << "Failed to read object file " << path << ": " << buffer.getError().message();
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mu_);
+  if (auto err = jit_->addObjectFile(std::move(*buffer))) {
+    LOG(WARNING) << "Failed to add object file " << path << ": " << llvm::toString(std::move(err));
+    return false;
+  }
+  return true;
 }
 
 void *ExecutionEngine::Lookup(absl::string_view name) {
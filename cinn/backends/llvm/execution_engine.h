@@ -44,8 +44,11 @@
 #include <vector>
 
 #include "cinn/backends/llvm/codegen_x86.h"
+#include "cinn/backends/llvm/llvm_optimizer.h"
 #include "cinn/backends/llvm/llvm_util.h"
+#include "cinn/backends/llvm/object_cache.h"
 #include "cinn/backends/llvm/runtime_symbol_registry.h"
+#include "cinn/common/target.h"
 #include "cinn/ir/module.h"
 
 namespace cinn::backends {
@@ -56,15 +59,31 @@ class NaiveObjectCache : public llvm::ObjectCache {
   std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *) override;
 
  private:
+  // the modules may be compiled by several threads
+  std::mutex mu_;
   llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> cached_objects_;
 };
 
 struct ExecutionOptions {
   int opt_level{3};
   bool enable_debug_info{false};
-  // TODO(fc500110)
-  // int num_compile_threads{1};
-  // bool enable_fast_math;
+  // the threads compiling a module, which is split by its functions into up to num_compile_threads LLVM modules
+  // compiled concurrently. The modules linked by several threads can't be exported by ExportObject.
+  int num_compile_threads{1};
+  // set all the fast-math flags on the floating-point instructions of kernels, besides the ones in optimize_options
+  bool enable_fast_math{false};
+  // the LLVM optimization pipeline run at opt_level
+  OptimizeOptions optimize_options;
+  // the x86 instruction sets, i.e. Target::Feature::SSE, AVX2 and AVX512, which the object code for ExportObject is
+  // generated for besides a baseline x86-64 one. Each kernel in the object dispatches to the variant of the best
+  // instruction set supported by the CPU running it, so one exported object runs across CPU generations. Empty means
+  // the object code of the host CPU, which the JIT always runs.
+  std::vector<common::Target::Feature> export_isa_variants;
+
+  llvm::FastMathFlags GetFastMathFlags() const;
+
+  // the options affecting the generated code, to be a part of the cache keys
+  std::string ToString() const;
 };
 
 class ExecutionEngine {
@@ -78,7 +97,19 @@ class ExecutionEngine {
   template <typename CodeGenT = CodeGenLLVM>
   void Link(const ir::Module &module);
 
-  void ExportObject(const std::string &path);
+  /**
+   * Write the object code of the linked module to \p path, which is only supported when the module is linked by one
+   * compile thread.
+   * @return false if the module is linked by several compile threads or the file can't be written, in which case
+   * \p path is left untouched.
+   */
+  bool ExportObject(const std::string &path);
+
+  /**
+   * Load a relocatable object file previously written by ExportObject into the JIT.
+   * @return false if the file can't be read or linked.
+   */
+  bool AddObjectFile(const std::string &path);
 
   bool AddModule(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context);
 
@@ -90,6 +121,11 @@ class ExecutionEngine {
 
   bool SetupTargetTriple(llvm::Module *module);
 
+  // link the modules split from a module, and compile them concurrently by the compile threads of LLJIT
+  void LinkPartitions(const ir::Module &module,
+                      std::vector<std::unique_ptr<llvm::Module>> &&llvm_modules,
+                      std::vector<std::unique_ptr<llvm::LLVMContext>> &&contexts);
+
   // This may not be a compatible implementation.
   friend std::unique_ptr<ExecutionEngine> std::make_unique<ExecutionEngine>(bool &&, cinn::backends::RuntimeSymbols &&);
 
@@ -98,7 +134,13 @@ class ExecutionEngine {
   llvm::SmallString<0> buffer_;
   std::unique_ptr<llvm::orc::LLJIT> jit_;
   std::unique_ptr<NaiveObjectCache> cache_;
+  // persists the objects across processes if FLAGS_cinn_llvm_object_cache_dir is set, it is used instead of cache_
+  std::unique_ptr<DiskObjectCache> disk_cache_;
   RuntimeSymbols module_symbols_;
+  ExecutionOptions options_;
+  int num_compile_threads_{1};
+  // whether a module is linked by several compile threads, whose object code isn't kept in buffer_
+  bool linked_partitions_{false};
 };
 
 }  // namespace cinn::backends
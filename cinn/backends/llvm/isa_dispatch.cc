@@ -0,0 +1,157 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/backends/llvm/isa_dispatch.h"
+
+#include <glog/logging.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+
+#include <algorithm>
+
+#include "cinn/runtime/cpu/host_intrinsics.h"
+
+namespace cinn::backends {
+
+namespace {
+constexpr char kIsaLevelName[]    = "__cinn_isa_level";
+constexpr char kGetIsaLevelName[] = "__cinn_get_isa_level";
+}  // namespace
+
+std::vector<IsaVariant> GetIsaVariants(const std::vector<common::Target::Feature> &features) {
+  std::vector<IsaVariant> variants = {{cinn_x86_isa_baseline, "generic", "x86-64", 128}};
+  for (auto feature : features) {
+    switch (feature) {
+      case common::Target::Feature::SSE:
+        variants.push_back({cinn_x86_isa_sse4_2, "sse4_2", "nehalem", 128});
+        break;
+      case common::Target::Feature::AVX2:
+        variants.push_back({cinn_x86_isa_avx2, "avx2", "haswell", 256});
+        break;
+      case common::Target::Feature::AVX512:
+        variants.push_back({cinn_x86_isa_avx512, "avx512", "skylake-avx512", 512});
+        break;
+      default:
+        LOG(FATAL) << "Feature " << static_cast<int>(feature) << " is not an x86 instruction set";
+    }
+  }
+  std::sort(variants.begin(), variants.end(), [](auto &a, auto &b) { return a.isa_level < b.isa_level; });
+  variants.erase(std::unique(variants.begin(),
+                             variants.end(),
+                             [](auto &a, auto &b) { return a.isa_level == b.isa_level; }),
+                 variants.end());
+  return variants;
+}
+
+void SetIsaVariant(llvm::Module *m, const std::vector<std::string> &fn_names, const IsaVariant &variant) {
+  auto vector_bits = std::to_string(variant.vector_bits);
+  for (auto &f : *m) {
+    if (f.isDeclaration()) continue;
+    // the runtime functions are compiled with the features of the build machine, which are dropped for the ones of
+    // the CPU of the variant
+    f.removeFnAttr("target-features");
+    f.addFnAttr("target-cpu", variant.cpu);
+    f.addFnAttr("prefer-vector-width", vector_bits);
+    f.addFnAttr("min-legal-vector-width", vector_bits);
+  }
+  for (auto &name : fn_names) {
+    auto *f = m->getFunction(name);
+    CHECK(f) << "Function " << name << " is not found in the LLVM module";
+    f->setName(name + "." + variant.suffix);
+  }
+}
+
+void AddIsaDispatchers(llvm::Module *m,
+                       const std::vector<std::string> &fn_names,
+                       const std::vector<IsaVariant> &variants) {
+  CHECK(!variants.empty());
+  auto &ctx      = m->getContext();
+  auto *i32_ty   = llvm::Type::getInt32Ty(ctx);
+  auto *void_ty  = llvm::Type::getVoidTy(ctx);
+  auto *neg_one  = llvm::ConstantInt::getSigned(i32_ty, -1);
+  auto *isa_func = m->getOrInsertFunction("cinn_x86_isa_level", llvm::FunctionType::get(i32_ty, false)).getCallee();
+
+  // the isa level is cached in a global, which is -1 before the query
+  auto *isa_level =
+      new llvm::GlobalVariable(*m, i32_ty, false, llvm::GlobalValue::InternalLinkage, neg_one, kIsaLevelName);
+  auto *get_level = llvm::Function::Create(
+      llvm::FunctionType::get(i32_ty, false), llvm::GlobalValue::InternalLinkage, kGetIsaLevelName, m);
+  {
+    auto *entry = llvm::BasicBlock::Create(ctx, "entry", get_level);
+    auto *query = llvm::BasicBlock::Create(ctx, "query", get_level);
+    auto *done  = llvm::BasicBlock::Create(ctx, "done", get_level);
+    llvm::IRBuilder<> b(entry);
+    auto *cached = b.CreateAlignedLoad(i32_ty, isa_level, llvm::MaybeAlign(4));
+    cached->setAtomic(llvm::AtomicOrdering::Monotonic);
+    b.CreateCondBr(b.CreateICmpSGE(cached, llvm::ConstantInt::get(i32_ty, 0)), done, query);
+    b.SetInsertPoint(query);
+    auto *queried = b.CreateCall(llvm::FunctionType::get(i32_ty, false), isa_func);
+    // the racing threads store the same value
+    b.CreateAlignedStore(queried, isa_level, llvm::MaybeAlign(4))->setAtomic(llvm::AtomicOrdering::Monotonic);
+    b.CreateBr(done);
+    b.SetInsertPoint(done);
+    auto *level = b.CreatePHI(i32_ty, 2);
+    level->addIncoming(cached, entry);
+    level->addIncoming(queried, query);
+    b.CreateRet(level);
+  }
+  {
+    auto *init = llvm::Function::Create(
+        llvm::FunctionType::get(void_ty, false), llvm::GlobalValue::InternalLinkage, "__cinn_init_isa_level", m);
+    llvm::IRBuilder<> b(llvm::BasicBlock::Create(ctx, "entry", init));
+    b.CreateCall(get_level);
+    b.CreateRetVoid();
+    llvm::appendToGlobalCtors(*m, init, 65535);
+  }
+
+  for (auto &name : fn_names) {
+    std::vector<llvm::Function *> impls;
+    for (auto &variant : variants) {
+      auto *impl = m->getFunction(name + "." + variant.suffix);
+      CHECK(impl) << "The " << variant.suffix << " variant of function " << name << " is not found";
+      impl->setLinkage(llvm::GlobalValue::InternalLinkage);
+      impls.push_back(impl);
+    }
+    auto *fn_ty = impls.front()->getFunctionType();
+    auto *fn    = llvm::Function::Create(fn_ty, llvm::GlobalValue::ExternalLinkage, name, m);
+    std::vector<llvm::Value *> args;
+    for (auto &arg : fn->args()) {
+      args.push_back(&arg);
+    }
+
+    // check the variants from the highest isa level, the baseline one is called unconditionally
+    llvm::IRBuilder<> b(llvm::BasicBlock::Create(ctx, "entry", fn));
+    auto *level = b.CreateCall(get_level);
+    for (int i = variants.size() - 1; i >= 0; --i) {
+      llvm::BasicBlock *next = nullptr;
+      if (i > 0) {
+        auto *call_bb = llvm::BasicBlock::Create(ctx, variants[i].suffix, fn);
+        next          = llvm::BasicBlock::Create(ctx, "next", fn);
+        b.CreateCondBr(b.CreateICmpSGE(level, llvm::ConstantInt::get(i32_ty, variants[i].isa_level)), call_bb, next);
+        b.SetInsertPoint(call_bb);
+      }
+      auto *call = b.CreateCall(fn_ty, impls[i], args);
+      call->setTailCall();
+      if (fn_ty->getReturnType()->isVoidTy()) {
+        b.CreateRetVoid();
+      } else {
+        b.CreateRet(call);
+      }
+      if (next) b.SetInsertPoint(next);
+    }
+  }
+}
+
+}  // namespace cinn::backends
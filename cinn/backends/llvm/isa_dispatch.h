@@ -0,0 +1,61 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <llvm/IR/Module.h>
+
+#include <string>
+#include <vector>
+
+#include "cinn/common/target.h"
+
+namespace cinn::backends {
+
+/**
+ * A variant of the kernels compiled for an x86 instruction set, which runs on the CPUs whose cinn_x86_isa_level()
+ * is isa_level or above.
+ */
+struct IsaVariant {
+  int isa_level;
+  // appended to the names of the kernels of the variant, e.g. "fn.avx2"
+  std::string suffix;
+  // the LLVM CPU of the instruction set
+  std::string cpu;
+  int vector_bits;
+};
+
+/**
+ * The variants of the instruction sets in \p features, plus the baseline x86-64 one to fall back to, in the
+ * ascending order of isa_level.
+ */
+std::vector<IsaVariant> GetIsaVariants(const std::vector<common::Target::Feature> &features);
+
+/**
+ * Retarget the functions defined in \p m, which is lowered from a module alone, to the instruction set of
+ * \p variant, and rename the kernels \p fn_names to the ones of the variant.
+ */
+void SetIsaVariant(llvm::Module *m, const std::vector<std::string> &fn_names, const IsaVariant &variant);
+
+/**
+ * Define a trampoline for each of \p fn_names in \p m, which holds the kernels of all the \p variants. A trampoline
+ * calls the variant of the highest isa_level supported by the CPU, which is queried once when the object is loaded
+ * by a global constructor, or on the first call if the constructors are not run, e.g. in the JIT. The variants are
+ * made internal, so only the trampolines are visible from the object.
+ */
+void AddIsaDispatchers(llvm::Module *m,
+                       const std::vector<std::string> &fn_names,
+                       const std::vector<IsaVariant> &variants);
+
+}  // namespace cinn::backends
@@ -0,0 +1,106 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/backends/llvm/jit_event_listener.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Object/SymbolSize.h>
+#include <llvm/Support/Error.h>
+#include <unistd.h>
+
+#include <cinttypes>
+
+DECLARE_bool(cinn_llvm_perf_jitdump);
+DECLARE_bool(cinn_llvm_gdb_registration);
+DECLARE_bool(cinn_llvm_perf_map);
+
+namespace cinn::backends {
+
+PerfMapListener::PerfMapListener(const std::string& path) : path_(path) {
+  file_ = fopen(path_.c_str(), "a");
+  if (!file_) {
+    LOG(WARNING) << "Failed to open the perf map file " << path_;
+  }
+}
+
+PerfMapListener::~PerfMapListener() {
+  if (file_) fclose(file_);
+}
+
+PerfMapListener* PerfMapListener::Global() {
+  // never destroyed, since the engines may load objects during the exit
+  static auto* listener = new PerfMapListener("/tmp/perf-" + std::to_string(getpid()) + ".map");
+  return listener;
+}
+
+void PerfMapListener::notifyObjectLoaded(ObjectKey key,
+                                         const llvm::object::ObjectFile& obj,
+                                         const llvm::RuntimeDyld::LoadedObjectInfo& info) {
+  if (!file_) return;
+  // the symbols of the object for debugging hold the addresses they are loaded at
+  auto debug_obj_owner = info.getObjectForDebug(obj);
+  auto* debug_obj      = debug_obj_owner.getBinary();
+  if (!debug_obj) return;
+
+  std::lock_guard<std::mutex> lock(mu_);
+  for (const auto& symbol_size : llvm::object::computeSymbolSizes(*debug_obj)) {
+    const auto& symbol = symbol_size.first;
+    auto type          = symbol.getType();
+    if (!type) {
+      llvm::consumeError(type.takeError());
+      continue;
+    }
+    if (*type != llvm::object::SymbolRef::ST_Function || symbol_size.second == 0) continue;
+    auto name = symbol.getName();
+    if (!name) {
+      llvm::consumeError(name.takeError());
+      continue;
+    }
+    auto address = symbol.getAddress();
+    if (!address) {
+      llvm::consumeError(address.takeError());
+      continue;
+    }
+    fprintf(file_,
+            "%" PRIx64 " %" PRIx64 " %s\n",
+            static_cast<uint64_t>(*address),
+            static_cast<uint64_t>(symbol_size.second),
+            name->str().c_str());
+  }
+  // perf may read the map while the process is running
+  fflush(file_);
+}
+
+std::vector<llvm::JITEventListener*> GetJITEventListenersFromFlags() {
+  std::vector<llvm::JITEventListener*> listeners;
+  if (FLAGS_cinn_llvm_perf_jitdump) {
+    if (auto* listener = llvm::JITEventListener::createPerfJITEventListener()) {
+      listeners.push_back(listener);
+    } else {
+      LOG_FIRST_N(WARNING, 1) << "The perf jitdump listener is not available, since LLVM is built without "
+                                 "LLVM_USE_PERF, use FLAGS_cinn_llvm_perf_map instead";
+    }
+  }
+  if (FLAGS_cinn_llvm_gdb_registration) {
+    listeners.push_back(llvm::JITEventListener::createGDBRegistrationListener());
+  }
+  if (FLAGS_cinn_llvm_perf_map) {
+    listeners.push_back(PerfMapListener::Global());
+  }
+  return listeners;
+}
+
+}  // namespace cinn::backends
@@ -0,0 +1,57 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <llvm/ExecutionEngine/JITEventListener.h>
+
+#include <cstdio>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+namespace cinn::backends {
+
+/**
+ * PerfMapListener appends the address, size and name of each function loaded by the JIT to /tmp/perf-<pid>.map,
+ * which Linux perf reads to symbolize the samples in JIT code without any other setup.
+ */
+class PerfMapListener : public llvm::JITEventListener {
+ public:
+  // the listener of the process, whose map file is opened on the first call
+  static PerfMapListener* Global();
+
+  void notifyObjectLoaded(ObjectKey key,
+                          const llvm::object::ObjectFile& obj,
+                          const llvm::RuntimeDyld::LoadedObjectInfo& info) override;
+
+  const std::string& path() const { return path_; }
+
+ private:
+  explicit PerfMapListener(const std::string& path);
+  ~PerfMapListener() override;
+
+  std::string path_;
+  std::mutex mu_;
+  FILE* file_{nullptr};
+};
+
+/**
+ * The listeners enabled by the flags for the JIT: the perf jitdump listener by FLAGS_cinn_llvm_perf_jitdump, the
+ * GDB registration listener by FLAGS_cinn_llvm_gdb_registration and PerfMapListener by FLAGS_cinn_llvm_perf_map.
+ * They are shared by all the engines of the process.
+ */
+std::vector<llvm::JITEventListener*> GetJITEventListenersFromFlags();
+
+}  // namespace cinn::backends
@@ -18,6 +18,7 @@
 #include <llvm/ADT/Triple.h>
 #include <llvm/Analysis/CGSCCPassManager.h>
 #include <llvm/AsmParser/Parser.h>
+#include <llvm/Config/llvm-config.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/ExecutionEngine/JITSymbol.h>
 #include <llvm/ExecutionEngine/Orc/CompileUtils.h>
@@ -44,6 +45,7 @@
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
 #include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/AlwaysInliner.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 #include <llvm/Transforms/InstCombine/InstCombine.h>
 #include <llvm/Transforms/Scalar.h>
@@ -51,10 +53,12 @@
 #include <llvm/Transforms/Scalar/NewGVN.h>
 #include <llvm/Transforms/Scalar/Reassociate.h>
 #include <llvm/Transforms/Scalar/SimplifyCFG.h>
+#include <llvm/Transforms/Utils.h>
 #include <llvm/Transforms/Vectorize.h>
 
 #include <algorithm>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -115,43 +119,84 @@ using CustomFunctionPassManager = CustomPassManager<llvm::legacy::FunctionPassMa
 using CustomModulePassManager   = CustomPassManager<llvm::legacy::PassManager>;
 }  // namespace
 
+llvm::FastMathFlags OptimizeOptions::GetFastMathFlags() const {
+  llvm::FastMathFlags flags;
+  flags.setAllowReassoc(fast_math_reassoc);
+  flags.setNoNaNs(fast_math_nnan);
+  flags.setNoInfs(fast_math_ninf);
+  flags.setAllowContract(fast_math_contract);
+  return flags;
+}
+
+std::string OptimizeOptions::ToString() const {
+  std::stringstream ss;
+  ss << "new_pm=" << use_new_pass_manager << " quick=" << quick << " loop_vectorize=" << loop_vectorize
+     << " slp_vectorize=" << slp_vectorize << " unroll_threshold=" << unroll_threshold
+     << " fast_math=" << fast_math_reassoc << fast_math_nnan << fast_math_ninf << fast_math_contract;
+  return ss.str();
+}
+
+llvm::CodeGenOpt::Level GetCodeGenOptLevel(int opt_level, const OptimizeOptions &options) {
+  if (options.quick) return llvm::CodeGenOpt::Less;
+  switch (opt_level) {
+    case 0:
+      return llvm::CodeGenOpt::None;
+    case 1:
+      return llvm::CodeGenOpt::Less;
+    case 2:
+      return llvm::CodeGenOpt::Default;
+    default:
+      return llvm::CodeGenOpt::Aggressive;
+  }
+}
+
 LLVMModuleOptimizer::LLVMModuleOptimizer(llvm::TargetMachine *machine,
                                          int opt_level,
-                                         llvm::FastMathFlags fast_math_flags,
+                                         const OptimizeOptions &options,
                                          bool print_passes)
-    : opt_level_(opt_level), print_passes_(print_passes), machine_(machine) {}
+    : machine_(machine),
+      opt_level_(std::min(std::max(opt_level, 0), 3)),
+      options_(options),
+      print_passes_(print_passes) {
+  CHECK(machine_) << "The target machine of LLVMModuleOptimizer should not be null";
+}
 
 void LLVMModuleOptimizer::operator()(llvm::Module *m) {
-  auto machine =
-      std::move(llvm::cantFail(llvm::cantFail(llvm::orc::JITTargetMachineBuilder::detectHost()).createTargetMachine()));
-  auto fpm = std::make_unique<CustomFunctionPassManager>(print_passes_, m);
-  // fpm->add(llvm::createTargetTransformInfoWrapperPass(llvm::TargetIRAnalysis()));
-  // fpm->add(llvm::createInstructionCombiningPass());
-  // fpm->add(llvm::createReassociatePass());
-  // fpm->add(llvm::createGVNPass());
-  // fpm->add(llvm::createCFGSimplificationPass());
-  // fpm->add(llvm::createSROAPass());
-  // fpm->add(llvm::createEarlyCSEPass());
-  // fpm->add(llvm::createLowerExpectIntrinsicPass());
-  // fpm->add(llvm::createCallSiteSplittingPass());
-  // fpm->add(llvm::createLoopVectorizePass());
-  // fpm->add(llvm::createSLPVectorizerPass());
-  // fpm->add(llvm::createLoadStoreVectorizerPass());
-  // fpm->add(llvm::createLoopUnrollPass());
+  if (options_.quick) {
+    RunQuickPipeline(m);
+  } else if (options_.use_new_pass_manager) {
+    RunNewPipeline(m);
+  } else {
+    RunLegacyPipeline(m);
+  }
+}
 
+void LLVMModuleOptimizer::RunLegacyPipeline(llvm::Module *m) {
+  auto fpm = std::make_unique<CustomFunctionPassManager>(print_passes_, m);
   auto mpm = std::make_unique<CustomModulePassManager>(print_passes_);
-  // mpm->add(llvm::createTargetTransformInfoWrapperPass(llvm::TargetIRAnalysis()));
-  // LOG(INFO) << "llvm run pass: target machine: name[" << machine_->getTarget().getName() << "]";
-  // LOG(INFO) << "llvm run pass: target machine: cpu[" << machine_->getTargetCPU().str() << "]";
-  fpm->add(llvm::createTargetTransformInfoWrapperPass(machine->getTargetIRAnalysis()));
-  mpm->add(llvm::createTargetTransformInfoWrapperPass(machine->getTargetIRAnalysis()));
+  fpm->add(llvm::createTargetTransformInfoWrapperPass(machine_->getTargetIRAnalysis()));
+  mpm->add(llvm::createTargetTransformInfoWrapperPass(machine_->getTargetIRAnalysis()));
   auto builder           = std::make_unique<llvm::PassManagerBuilder>();
   builder->OptLevel      = opt_level_;
-  builder->Inliner       = llvm::createFunctionInliningPass();
-  builder->LoopVectorize = true;
-  builder->SLPVectorize  = true;
+  builder->Inliner       = opt_level_ > 0 ? llvm::createFunctionInliningPass() : llvm::createAlwaysInlinerLegacyPass();
+  builder->LoopVectorize = options_.loop_vectorize && opt_level_ > 0;
+  builder->SLPVectorize  = options_.slp_vectorize && opt_level_ > 0;
+  if (options_.unroll_threshold >= 0) {
+    // the unroll pass of the builder has the default threshold, so unroll by a pass of the given one instead
+    builder->DisableUnrollLoops = true;
+    if (options_.unroll_threshold > 0 && opt_level_ > 0) {
+      int opt_level        = opt_level_;
+      int unroll_threshold = options_.unroll_threshold;
+      builder->addExtension(
+          llvm::PassManagerBuilder::EP_OptimizerLast,
+          [opt_level, unroll_threshold](const llvm::PassManagerBuilder &, llvm::legacy::PassManagerBase &pm) {
+            pm.add(llvm::createLoopUnrollPass(opt_level, false, false, unroll_threshold));
+            pm.add(llvm::createInstructionCombiningPass());
+          });
+    }
+  }
 #if LLVM_VERSION_MAJOR >= 11
-  machine->adjustPassManager(*builder);
+  machine_->adjustPassManager(*builder);
 #endif
   builder->populateFunctionPassManager(*fpm);
   builder->populateModulePassManager(*mpm);
@@ -163,4 +208,69 @@ void LLVMModuleOptimizer::operator()(llvm::Module *m) {
   mpm->run(*m);
 }
 
+void LLVMModuleOptimizer::RunNewPipeline(llvm::Module *m) {
+#if LLVM_VERSION_MAJOR >= 14
+  using OptimizationLevel = llvm::OptimizationLevel;
+#else
+  using OptimizationLevel = llvm::PassBuilder::OptimizationLevel;
+#endif
+  llvm::PipelineTuningOptions tuning_options;
+  tuning_options.LoopVectorization = options_.loop_vectorize;
+  tuning_options.SLPVectorization  = options_.slp_vectorize;
+  tuning_options.LoopUnrolling     = options_.unroll_threshold != 0;
+  if (options_.unroll_threshold > 0) {
+    LOG_FIRST_N(WARNING, 1) << "The unroll threshold is ignored by the new pass manager, which only supports "
+                            << "enabling or disabling unrolling";
+  }
+
+#if LLVM_VERSION_MAJOR == 12
+  llvm::PassBuilder pass_builder(print_passes_, machine_, tuning_options);
+#else
+  llvm::PassBuilder pass_builder(machine_, tuning_options);
+#endif
+  llvm::LoopAnalysisManager lam;
+  llvm::FunctionAnalysisManager fam;
+  llvm::CGSCCAnalysisManager cgam;
+  llvm::ModuleAnalysisManager mam;
+  pass_builder.registerModuleAnalyses(mam);
+  pass_builder.registerCGSCCAnalyses(cgam);
+  pass_builder.registerFunctionAnalyses(fam);
+  pass_builder.registerLoopAnalyses(lam);
+  pass_builder.crossRegisterProxies(lam, fam, cgam, mam);
+
+  static const OptimizationLevel levels[] = {
+      OptimizationLevel::O0, OptimizationLevel::O1, OptimizationLevel::O2, OptimizationLevel::O3};
+  auto mpm = opt_level_ == 0 ? pass_builder.buildO0DefaultPipeline(levels[0])
+                             : pass_builder.buildPerModuleDefaultPipeline(levels[opt_level_]);
+  mpm.run(*m, mam);
+}
+
+void LLVMModuleOptimizer::RunQuickPipeline(llvm::Module *m) {
+  // the passes cleaning up the IR emitted by codegen, and the vectorizers if enabled since kernels rely on them
+  auto fpm = std::make_unique<CustomFunctionPassManager>(print_passes_, m);
+  fpm->add(llvm::createTargetTransformInfoWrapperPass(machine_->getTargetIRAnalysis()));
+  fpm->add(llvm::createPromoteMemoryToRegisterPass());
+  fpm->add(llvm::createInstructionCombiningPass());
+  fpm->add(llvm::createCFGSimplificationPass());
+  fpm->add(llvm::createEarlyCSEPass());
+  if (options_.loop_vectorize) {
+    fpm->add(llvm::createLoopVectorizePass());
+  }
+  if (options_.slp_vectorize) {
+    fpm->add(llvm::createSLPVectorizerPass());
+  }
+  fpm->add(llvm::createInstructionCombiningPass());
+
+  fpm->doInitialization();
+  std::for_each(m->begin(), m->end(), [&fpm](auto &fn) {
+    if (!fn.isDeclaration()) fpm->run(fn);
+  });
+  fpm->doFinalization();
+
+  // drop the runtime functions not called by kernels
+  auto mpm = std::make_unique<CustomModulePassManager>(print_passes_);
+  mpm->add(llvm::createGlobalDCEPass());
+  mpm->run(*m);
+}
+
 }  // namespace cinn::backends
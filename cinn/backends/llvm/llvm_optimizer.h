@@ -18,26 +18,58 @@
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Module.h>
 #include <llvm/Pass.h>
+#include <llvm/Support/CodeGen.h>
 #include <llvm/Target/TargetMachine.h>
 
 #include <functional>
+#include <string>
 
 namespace cinn::backends {
 
-// TODO(fc500110): define class OptimizeOptions
+// the options of the LLVM optimization pipeline besides the opt level, which trade compile time against kernel speed
+struct OptimizeOptions {
+  // run the pipeline by the new pass manager instead of the legacy one
+  bool use_new_pass_manager{false};
+  // run a short pipeline of the essential function passes instead of the one of the opt level, and generate code at
+  // a lower opt level as well, for fast first compiles
+  bool quick{false};
+  bool loop_vectorize{true};
+  bool slp_vectorize{true};
+  // the cost threshold of loop unrolling, -1 means the default of LLVM and 0 disables unrolling. The new pass manager
+  // only supports enabling or disabling unrolling.
+  int unroll_threshold{-1};
+  // the fast-math flags set on the floating-point instructions of kernels, the runtime functions are not affected
+  bool fast_math_reassoc{false};
+  bool fast_math_nnan{false};
+  bool fast_math_ninf{false};
+  bool fast_math_contract{false};
+
+  llvm::FastMathFlags GetFastMathFlags() const;
+
+  // the options affecting the generated code, to be a part of the cache keys
+  std::string ToString() const;
+};
 
 // llvm module optimizer
 class LLVMModuleOptimizer final {
  public:
   explicit LLVMModuleOptimizer(llvm::TargetMachine *machine,
                                int opt_level,
-                               llvm::FastMathFlags fast_math_flags,
-                               bool print_passes = false);
+                               const OptimizeOptions &options = OptimizeOptions(),
+                               bool print_passes              = false);
   void operator()(llvm::Module *m);
 
  private:
+  void RunLegacyPipeline(llvm::Module *m);
+  void RunNewPipeline(llvm::Module *m);
+  void RunQuickPipeline(llvm::Module *m);
+
   llvm::TargetMachine *machine_;
   int opt_level_{};
+  OptimizeOptions options_;
   bool print_passes_{};
 };
+
+// the opt level of the code generation for the opt level of the IR optimization
+llvm::CodeGenOpt::Level GetCodeGenOptLevel(int opt_level, const OptimizeOptions &options);
 }  // namespace cinn::backends
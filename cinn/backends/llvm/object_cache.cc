@@ -0,0 +1,219 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/backends/llvm/object_cache.h"
+
+#include <dirent.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+DECLARE_string(cinn_llvm_object_cache_dir);
+DECLARE_int32(cinn_llvm_object_cache_max_size_mb);
+
+namespace cinn::backends {
+
+namespace {
+// bump it when the layout of the cache, the key or the code generated for a key changes
+constexpr char kCacheVersion[] = "cinn_llvm_object_cache_v2";
+constexpr char kObjectSuffix[] = ".o";
+
+DiskObjectCache::Stats& MutableStats() {
+  static DiskObjectCache::Stats stats;
+  return stats;
+}
+
+// the bytes written since the last eviction check, which starts from the threshold to check on the first write
+std::atomic<int64_t>& BytesSinceEvictionCheck() {
+  static std::atomic<int64_t> bytes(std::numeric_limits<int64_t>::max() / 2);
+  return bytes;
+}
+
+bool EndsWith(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool MakeDirectories(const std::string& dirname) {
+  for (size_t pos = dirname.find('/', 1); pos != std::string::npos; pos = dirname.find('/', pos + 1)) {
+    mkdir(dirname.substr(0, pos).c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+  }
+  if (mkdir(dirname.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) != 0 && errno != EEXIST) {
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
+std::string DiskObjectCache::Stats::ToString() const {
+  std::stringstream ss;
+  ss << "hits: " << hits << ", misses: " << misses << ", writes: " << writes << ", write failures: " << write_failures
+     << ", evictions: " << evictions << ", bytes read: " << bytes_read << ", bytes written: " << bytes_written;
+  return ss.str();
+}
+
+DiskObjectCache::DiskObjectCache(const std::string& cache_dir, int64_t max_size, const std::string& target_key)
+    : cache_dir_(cache_dir), max_size_(max_size), target_key_(target_key) {
+  CHECK(!cache_dir_.empty()) << "The directory of LLVM object cache should not be empty";
+  CHECK_GT(max_size_, 0) << "The max size of LLVM object cache should be greater than 0";
+  if (!MakeDirectories(cache_dir_)) {
+    LOG(WARNING) << "Failed to create the LLVM object cache directory: " << cache_dir_;
+  }
+}
+
+std::unique_ptr<DiskObjectCache> DiskObjectCache::CreateFromFlags(const std::string& target_key) {
+  if (FLAGS_cinn_llvm_object_cache_dir.empty()) {
+    return nullptr;
+  }
+  return std::make_unique<DiskObjectCache>(FLAGS_cinn_llvm_object_cache_dir,
+                                           static_cast<int64_t>(FLAGS_cinn_llvm_object_cache_max_size_mb) << 20,
+                                           target_key);
+}
+
+const DiskObjectCache::Stats& DiskObjectCache::GetStats() { return MutableStats(); }
+
+std::string DiskObjectCache::ObjectPath(const llvm::Module* m) const {
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << kCacheVersion << "\n" << LLVM_VERSION_STRING << "\n" << target_key_ << "\n";
+  m->print(os, nullptr);
+  os.flush();
+
+  // two independent 64-bit hashes make the collision negligible
+  std::stringstream ss;
+  ss << cache_dir_ << "/" << std::hex << std::setfill('0') << std::setw(16) << llvm::xxHash64(key) << std::setw(16)
+     << std::hash<std::string>()(key) << kObjectSuffix;
+  return ss.str();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> DiskObjectCache::getObject(const llvm::Module* m) {
+  auto path   = ObjectPath(m);
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    ++MutableStats().misses;
+    VLOG(3) << "No object for " << m->getModuleIdentifier() << " in LLVM object cache at " << path;
+    std::lock_guard<std::mutex> lock(mu_);
+    pending_paths_[m] = path;
+    return nullptr;
+  }
+
+  // touch the object to keep it from the eviction of the least recently used ones
+  utime(path.c_str(), nullptr);
+  ++MutableStats().hits;
+  MutableStats().bytes_read += (*buffer)->getBufferSize();
+  VLOG(3) << "Load object for " << m->getModuleIdentifier() << " from LLVM object cache at " << path;
+  return std::move(*buffer);
+}
+
+void DiskObjectCache::notifyObjectCompiled(const llvm::Module* m, llvm::MemoryBufferRef obj) {
+  std::string path;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = pending_paths_.find(m);
+    if (it == pending_paths_.end()) {
+      // the module is compiled without looking up the cache first, it is changed by the code generation already
+      return;
+    }
+    path = std::move(it->second);
+    pending_paths_.erase(it);
+  }
+
+  // write into a private file, then publish it by an atomic rename
+  std::stringstream tmp_ss;
+  tmp_ss << path << ".tmp." << getpid() << "." << std::hash<std::thread::id>()(std::this_thread::get_id());
+  auto tmp_path = tmp_ss.str();
+  {
+    std::ofstream ofs(tmp_path, std::ios::binary);
+    ofs.write(obj.getBufferStart(), obj.getBufferSize());
+    if (!ofs.good()) {
+      ++MutableStats().write_failures;
+      LOG(WARNING) << "Failed to write the LLVM object cache file " << tmp_path;
+      ofs.close();
+      unlink(tmp_path.c_str());
+      return;
+    }
+  }
+  if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+    ++MutableStats().write_failures;
+    VLOG(3) << "Failed to publish the LLVM object cache file " << path << ", errno = " << errno;
+    unlink(tmp_path.c_str());
+    return;
+  }
+  ++MutableStats().writes;
+  MutableStats().bytes_written += obj.getBufferSize();
+  VLOG(3) << "Insert object for " << m->getModuleIdentifier() << " into LLVM object cache at " << path;
+
+  auto& bytes_since_check = BytesSinceEvictionCheck();
+  if (bytes_since_check.fetch_add(obj.getBufferSize()) + obj.getBufferSize() > max_size_ / 8) {
+    bytes_since_check = 0;
+    Evict();
+  }
+}
+
+void DiskObjectCache::Evict() {
+  DIR* dir = opendir(cache_dir_.c_str());
+  if (!dir) {
+    return;
+  }
+  // the objects in the order of their last access
+  std::vector<std::pair<time_t, std::pair<std::string, int64_t>>> objects;
+  int64_t total_size = 0;
+  while (auto* ent = readdir(dir)) {
+    std::string name = ent->d_name;
+    if (!EndsWith(name, kObjectSuffix)) continue;
+    std::string path = cache_dir_ + "/" + name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) continue;
+    objects.push_back({st.st_mtime, {path, st.st_size}});
+    total_size += st.st_size;
+  }
+  closedir(dir);
+  if (total_size <= max_size_) {
+    return;
+  }
+
+  std::sort(objects.begin(), objects.end());
+  // evict to a lower mark, so that the following writes don't evict again soon
+  int64_t target_size = max_size_ / 4 * 3;
+  int num_evicted     = 0;
+  for (auto& object : objects) {
+    if (total_size <= target_size) break;
+    // another process may have evicted it, the readers having opened it are not affected
+    if (unlink(object.second.first.c_str()) == 0) {
+      ++num_evicted;
+    }
+    total_size -= object.second.second;
+  }
+  MutableStats().evictions += num_evicted;
+  VLOG(2) << "Evict " << num_evicted << " objects from LLVM object cache at " << cache_dir_ << ", remaining size "
+          << total_size << " bytes";
+}
+
+}  // namespace cinn::backends
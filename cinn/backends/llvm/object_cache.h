@@ -0,0 +1,81 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+namespace cinn::backends {
+
+/**
+ * DiskObjectCache persists the object code compiled by LLVM in a directory, so that the processes compiling the same
+ * LLVM IR later load the objects instead of generating code again.
+ *
+ * An object is keyed by the hash of the module IR and the target key, which covers the target triple, CPU, features,
+ * opt level and relocation model of the compiler. The objects are written into temporary files and renamed to their
+ * final names, so the processes sharing a directory never read a partial object. The directory is bounded by
+ * max_size bytes: the objects are touched on every hit, and the least recently used ones are evicted when the
+ * objects written since the last check exceed an eighth of max_size.
+ */
+class DiskObjectCache : public llvm::ObjectCache {
+ public:
+  // the statistics of all the caches in the process
+  struct Stats {
+    std::atomic<int64_t> hits{0};
+    std::atomic<int64_t> misses{0};
+    std::atomic<int64_t> writes{0};
+    std::atomic<int64_t> write_failures{0};
+    std::atomic<int64_t> evictions{0};
+    std::atomic<int64_t> bytes_read{0};
+    std::atomic<int64_t> bytes_written{0};
+
+    std::string ToString() const;
+  };
+
+  DiskObjectCache(const std::string& cache_dir, int64_t max_size, const std::string& target_key);
+
+  // the cache configured by FLAGS_cinn_llvm_object_cache_dir, or null if it is disabled
+  static std::unique_ptr<DiskObjectCache> CreateFromFlags(const std::string& target_key);
+
+  static const Stats& GetStats();
+
+  void notifyObjectCompiled(const llvm::Module* m, llvm::MemoryBufferRef obj) override;
+  std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* m) override;
+
+  // remove the least recently used objects until the directory is within three quarters of max_size
+  void Evict();
+
+ private:
+  std::string ObjectPath(const llvm::Module* m) const;
+
+  std::string cache_dir_;
+  int64_t max_size_;
+  std::string target_key_;
+
+  std::mutex mu_;
+  // the paths computed by getObject for the modules being compiled, since the module is changed by the code
+  // generation before notifyObjectCompiled
+  std::unordered_map<const llvm::Module*, std::string> pending_paths_;
+};
+
+}  // namespace cinn::backends
@@ -0,0 +1,103 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/backends/llvm/object_cache.h"
+
+#include <dirent.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/LLVMContext.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+
+namespace cinn::backends {
+
+namespace {
+std::unique_ptr<llvm::Module> CreateModule(llvm::LLVMContext* ctx, const std::string& func_name) {
+  auto m       = std::make_unique<llvm::Module>("test_object_cache", *ctx);
+  auto* fn_ty  = llvm::FunctionType::get(llvm::Type::getVoidTy(*ctx), false);
+  auto* fn     = llvm::Function::Create(fn_ty, llvm::Function::ExternalLinkage, func_name, m.get());
+  auto* entry  = llvm::BasicBlock::Create(*ctx, "entry", fn);
+  llvm::ReturnInst::Create(*ctx, entry);
+  return m;
+}
+
+int CountObjects(const std::string& dirname) {
+  int count = 0;
+  DIR* dir  = opendir(dirname.c_str());
+  while (auto* ent = readdir(dir)) {
+    std::string name = ent->d_name;
+    if (name.size() > 2 && name.substr(name.size() - 2) == ".o") ++count;
+  }
+  closedir(dir);
+  return count;
+}
+}  // namespace
+
+TEST(DiskObjectCache, HitAndMiss) {
+  char dir_template[] = "/tmp/cinn_object_cache_XXXXXX";
+  std::string cache_dir(mkdtemp(dir_template));
+  llvm::LLVMContext ctx;
+  auto m = CreateModule(&ctx, "fn");
+  std::string object(1024, 'x');
+
+  int64_t hits = DiskObjectCache::GetStats().hits, misses = DiskObjectCache::GetStats().misses;
+  {
+    DiskObjectCache cache(cache_dir, 1 << 20, "target_a");
+    ASSERT_EQ(cache.getObject(m.get()), nullptr);
+    cache.notifyObjectCompiled(m.get(), llvm::MemoryBufferRef(object, "fn"));
+  }
+  {
+    // a new cache in the directory, as the one of another process, loads the object
+    DiskObjectCache cache(cache_dir, 1 << 20, "target_a");
+    auto buffer = cache.getObject(m.get());
+    ASSERT_NE(buffer, nullptr);
+    ASSERT_EQ(buffer->getBuffer().str(), object);
+  }
+  {
+    // the object of another target or another module is not shared
+    DiskObjectCache cache(cache_dir, 1 << 20, "target_b");
+    ASSERT_EQ(cache.getObject(m.get()), nullptr);
+    auto other = CreateModule(&ctx, "other_fn");
+    DiskObjectCache cache_a(cache_dir, 1 << 20, "target_a");
+    ASSERT_EQ(cache_a.getObject(other.get()), nullptr);
+  }
+  ASSERT_EQ(DiskObjectCache::GetStats().hits - hits, 1);
+  ASSERT_EQ(DiskObjectCache::GetStats().misses - misses, 3);
+  LOG(INFO) << DiskObjectCache::GetStats().ToString();
+}
+
+TEST(DiskObjectCache, Evict) {
+  char dir_template[] = "/tmp/cinn_object_cache_XXXXXX";
+  std::string cache_dir(mkdtemp(dir_template));
+  llvm::LLVMContext ctx;
+  std::string object(1024, 'x');
+
+  // the cache holds 8 objects at most, and is evicted to 6 objects
+  DiskObjectCache cache(cache_dir, 8 * 1024, "target");
+  for (int i = 0; i < 16; ++i) {
+    auto m = CreateModule(&ctx, "fn_" + std::to_string(i));
+    ASSERT_EQ(cache.getObject(m.get()), nullptr);
+    cache.notifyObjectCompiled(m.get(), llvm::MemoryBufferRef(object, "fn"));
+  }
+  cache.Evict();
+  ASSERT_LE(CountObjects(cache_dir), 8);
+  ASSERT_GT(CountObjects(cache_dir), 0);
+}
+
+}  // namespace cinn::backends
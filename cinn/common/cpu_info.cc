@@ -0,0 +1,90 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/common/cpu_info.h"
+
+#include <glog/logging.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/Host.h>
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace cinn {
+namespace common {
+
+namespace {
+CpuInfo DetectHostCpu() {
+  CpuInfo info;
+  info.name = llvm::sys::getHostCPUName().str();
+
+  llvm::StringMap<bool> features;
+  if (!llvm::sys::getHostCPUFeatures(features)) {
+    LOG(WARNING) << "Failed to detect the features of the host CPU " << info.name << ", assume SSE only";
+    return info;
+  }
+  auto has = [&](const char* name) {
+    auto it = features.find(name);
+    return it != features.end() && it->second;
+  };
+  info.has_sse42      = has("sse4.2");
+  info.has_avx        = has("avx");
+  info.has_avx2       = has("avx2");
+  info.has_fma        = has("fma");
+  info.has_avx512f    = has("avx512f");
+  info.has_avx512bw   = has("avx512bw");
+  info.has_avx512vl   = has("avx512vl");
+  info.has_avx512dq   = has("avx512dq");
+  info.has_avx512vnni = has("avx512vnni");
+  if (info.has_avx512f) {
+    info.vector_bits = 512;
+  } else if (info.has_avx) {
+    info.vector_bits = 256;
+  }
+
+  // sort the features to keep the string stable, it is a part of the cache keys
+  std::vector<std::string> names;
+  for (auto& feature : features) {
+    names.push_back((feature.second ? "+" : "-") + feature.first().str());
+  }
+  std::sort(names.begin(), names.end());
+  std::stringstream ss;
+  for (size_t i = 0; i < names.size(); ++i) {
+    ss << (i ? "," : "") << names[i];
+  }
+  info.llvm_features = ss.str();
+  return info;
+}
+}  // namespace
+
+const CpuInfo& CpuInfo::Host() {
+  static const CpuInfo info = [] {
+    auto detected = DetectHostCpu();
+    VLOG(1) << "Host CPU: " << detected.ToString();
+    return detected;
+  }();
+  return info;
+}
+
+std::string CpuInfo::ToString() const {
+  std::stringstream ss;
+  ss << name << ", vector bits: " << vector_bits << ", sse4.2: " << has_sse42 << ", avx: " << has_avx
+     << ", avx2: " << has_avx2 << ", fma: " << has_fma << ", avx512f: " << has_avx512f << ", avx512bw: " << has_avx512bw
+     << ", avx512vl: " << has_avx512vl << ", avx512dq: " << has_avx512dq << ", avx512vnni: " << has_avx512vnni;
+  return ss.str();
+}
+
+}  // namespace common
+}  // namespace cinn
@@ -0,0 +1,50 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+
+namespace cinn {
+namespace common {
+
+/**
+ * The instruction set extensions of the host CPU, which are detected by CPUID once in a process.
+ */
+struct CpuInfo {
+  // the CPU name known by LLVM, e.g. "skylake-avx512"
+  std::string name;
+  // the features in the form of LLVM, e.g. "+avx2,+fma,-avx512f"
+  std::string llvm_features;
+
+  bool has_sse42{false};
+  bool has_avx{false};
+  bool has_avx2{false};
+  bool has_fma{false};
+  bool has_avx512f{false};
+  bool has_avx512bw{false};
+  bool has_avx512vl{false};
+  bool has_avx512dq{false};
+  bool has_avx512vnni{false};
+
+  // the width in bits of the widest vector registers supported
+  int vector_bits{128};
+
+  static const CpuInfo& Host();
+
+  std::string ToString() const;
+};
+
+}  // namespace common
+}  // namespace cinn
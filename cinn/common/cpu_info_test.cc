@@ -0,0 +1,60 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/common/cpu_info.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "cinn/common/target.h"
+
+DECLARE_int32(cinn_x86_vector_bits);
+
+namespace cinn {
+namespace common {
+
+TEST(CpuInfo, Host) {
+  auto& info = CpuInfo::Host();
+  LOG(INFO) << info.ToString();
+  ASSERT_FALSE(info.name.empty());
+  if (info.has_avx512f) {
+    ASSERT_EQ(info.vector_bits, 512);
+  } else if (info.has_avx) {
+    ASSERT_EQ(info.vector_bits, 256);
+  } else {
+    ASSERT_EQ(info.vector_bits, 128);
+  }
+  // the features imply each other
+  ASSERT_TRUE(!info.has_avx2 || info.has_avx);
+  ASSERT_TRUE(!info.has_avx512bw || info.has_avx512f);
+}
+
+TEST(CpuInfo, TargetVectorBits) {
+  ASSERT_EQ(DefaultHostTarget().vector_bits(), CpuInfo::Host().vector_bits);
+
+  Target avx2(Target::OS::Linux, Target::Arch::X86, Target::Bit::k64, {Target::Feature::AVX2});
+  ASSERT_EQ(avx2.vector_bits(), 256);
+  Target avx512(Target::OS::Linux, Target::Arch::X86, Target::Bit::k64, {Target::Feature::AVX512});
+  ASSERT_EQ(avx512.vector_bits(), 512);
+  ASSERT_NE(avx512, DefaultHostTarget());
+
+  FLAGS_cinn_x86_vector_bits = 256;
+  ASSERT_EQ(avx512.vector_bits(), 256);
+  ASSERT_EQ(avx2.vector_bits(), 256);
+  FLAGS_cinn_x86_vector_bits = 0;
+}
+
+}  // namespace common
+}  // namespace cinn
@@ -14,12 +14,17 @@
 
 #include "cinn/common/target.h"
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <sstream>
 
+#include "cinn/common/cpu_info.h"
 #include "cinn/runtime/cinn_runtime.h"
 
+DECLARE_int32(cinn_x86_vector_bits);
+
 namespace cinn {
 namespace common {
 
@@ -65,6 +70,25 @@ int Target::get_target_bits() const {
   return -1;
 }
 
+int Target::vector_bits() const {
+  if (arch != Arch::X86) {
+    return get_target_bits() * 8;
+  }
+  int bits = CpuInfo::Host().vector_bits;
+  if (has_feature(Feature::AVX512)) {
+    bits = 512;
+  } else if (has_feature(Feature::AVX2)) {
+    bits = 256;
+  } else if (has_feature(Feature::SSE)) {
+    bits = 128;
+  }
+  return FLAGS_cinn_x86_vector_bits > 0 ? std::min(bits, FLAGS_cinn_x86_vector_bits) : bits;
+}
+
+bool Target::has_feature(Feature feature) const {
+  return std::find(features.begin(), features.end(), feature) != features.end();
+}
+
 std::string Target::arch_str() const {
   std::ostringstream oss;
   oss << arch;
@@ -51,9 +51,16 @@ struct Target {
   Arch arch{Arch::Unk};
   Bit bits{Bit::Unk};
 
+  /**
+   * The features of the target. The instruction sets of X86 pin the vector width of the target, which is the one of
+   * the host CPU if none is given.
+   */
   enum class Feature : int {
     JIT = 0,
     Debug,
+    SSE,
+    AVX2,
+    AVX512,
   };
 
   /**
@@ -82,6 +89,11 @@ struct Target {
 
   int get_target_bits() const;
 
+  //! Get the width in bits of the vectors to vectorize the kernels to.
+  int vector_bits() const;
+
+  bool has_feature(Feature feature) const;
+
   std::vector<Lib> get_target_libs() const;
 
   std::string arch_str() const;
@@ -0,0 +1,266 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/frontend/batching_computation.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#include "cinn/utils/profiler.h"
+
+namespace cinn {
+namespace frontend {
+
+namespace {
+
+size_t GetTensorBytes(const hlir::framework::Tensor& t) { return t->shape().numel() * t->type().bytes(); }
+
+}  // namespace
+
+BatchingComputation::BatchingComputation(ComputationBuilder builder, const Options& options)
+    : builder_(std::move(builder)), options_(options) {
+  CHECK_GT(options_.max_batch_size, 0) << "The max_batch_size of BatchingComputation should be positive";
+  CHECK_GE(options_.max_delay_us, 0) << "The max_delay_us of BatchingComputation should not be negative";
+  for (int bucket = 1; bucket < options_.max_batch_size; bucket *= 2) {
+    buckets_.push_back(bucket);
+  }
+  buckets_.push_back(options_.max_batch_size);
+
+  auto* computation = GetOrCompile(1);
+  for (auto& t : computation->GetInputTensors()) {
+    input_row_bytes_.push_back(GetTensorBytes(t));
+  }
+  for (auto& t : computation->GetOutputTensors()) {
+    output_row_bytes_.push_back(GetTensorBytes(t));
+  }
+
+  dispatcher_ = std::thread(&BatchingComputation::DispatchLoop, this);
+}
+
+BatchingComputation::~BatchingComputation() {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  // the requests left in the queue are still served before the dispatcher exits
+  dispatcher_.join();
+}
+
+std::future<BatchingComputation::Feed> BatchingComputation::Submit(Feed inputs) {
+  CHECK_EQ(inputs.size(), input_row_bytes_.size()) << "The number of inputs of the request is mismatched";
+  int num_rows = -1;
+  for (int i = 0; i < inputs.size(); ++i) {
+    CHECK_EQ(inputs[i].size() % input_row_bytes_[i], 0UL)
+        << "The size of input " << i << " should be a multiple of the row size " << input_row_bytes_[i];
+    int rows = inputs[i].size() / input_row_bytes_[i];
+    CHECK(num_rows == -1 || num_rows == rows) << "All the inputs of a request should have the same number of rows";
+    num_rows = rows;
+  }
+  CHECK_GT(num_rows, 0) << "The request should have at least one row";
+  CHECK_LE(num_rows, options_.max_batch_size) << "The request has more rows than the max_batch_size";
+
+  Request request;
+  request.inputs   = std::move(inputs);
+  request.num_rows = num_rows;
+  request.arrival  = std::chrono::steady_clock::now();
+  auto future      = request.outputs.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    CHECK(!stop_) << "Submit to a stopped BatchingComputation";
+    queue_.push_back(std::move(request));
+    queued_rows_ += num_rows;
+  }
+  cv_.notify_one();
+  return future;
+}
+
+void BatchingComputation::Warmup() {
+  for (int bucket : buckets_) {
+    GetOrCompile(bucket);
+  }
+}
+
+int BatchingComputation::GetBucket(int batch_size) const {
+  auto it = std::lower_bound(buckets_.begin(), buckets_.end(), batch_size);
+  CHECK(it != buckets_.end()) << "No bucket can hold a batch of " << batch_size << " rows";
+  return *it;
+}
+
+BatchingComputation::Stats BatchingComputation::GetStats() const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return stats_;
+}
+
+CinnComputation* BatchingComputation::GetOrCompile(int bucket) {
+  std::lock_guard<std::mutex> lock(compile_mtx_);
+  auto it = computations_.find(bucket);
+  if (it != computations_.end()) {
+    return it->second.get();
+  }
+
+  VLOG(3) << "Compile the computation of batch bucket " << bucket;
+  auto computation = builder_(bucket);
+  CHECK(computation) << "Failed to build the computation of batch bucket " << bucket;
+  if (!input_row_bytes_.empty()) {
+    auto inputs  = computation->GetInputTensors();
+    auto outputs = computation->GetOutputTensors();
+    CHECK_EQ(inputs.size(), input_row_bytes_.size());
+    CHECK_EQ(outputs.size(), output_row_bytes_.size());
+    for (int i = 0; i < inputs.size(); ++i) {
+      CHECK_EQ(GetTensorBytes(inputs[i]), input_row_bytes_[i] * bucket)
+          << "The leading dimension of input " << i << " should be the batch size " << bucket;
+    }
+    for (int i = 0; i < outputs.size(); ++i) {
+      CHECK_EQ(GetTensorBytes(outputs[i]), output_row_bytes_[i] * bucket)
+          << "The leading dimension of output " << i << " should be the batch size " << bucket;
+    }
+  }
+  auto* ptr = computation.get();
+  computations_.emplace(bucket, std::move(computation));
+  return ptr;
+}
+
+void BatchingComputation::DispatchLoop() {
+  while (true) {
+    std::vector<Request> batch;
+    int num_rows = 0;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      // wait for more requests until the batch is full or the oldest request reaches its deadline
+      auto deadline = queue_.front().arrival + std::chrono::microseconds(options_.max_delay_us);
+      cv_.wait_until(lock, deadline, [this] { return stop_ || queued_rows_ >= options_.max_batch_size; });
+
+      while (!queue_.empty() && num_rows + queue_.front().num_rows <= options_.max_batch_size) {
+        num_rows += queue_.front().num_rows;
+        batch.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+      queued_rows_ -= num_rows;
+    }
+    RunBatch(&batch, num_rows);
+  }
+}
+
+void BatchingComputation::RunBatch(std::vector<Request>* batch, int num_rows) {
+  utils::RecordEvent record_event("BatchingComputation::RunBatch", utils::EventType::kOrdinary);
+  int bucket        = GetBucket(num_rows);
+  auto* computation = GetOrCompile(bucket);
+
+  // gather the inputs of requests, and the rows after them are padding
+  auto inputs = computation->GetInputTensors();
+  for (int i = 0; i < inputs.size(); ++i) {
+    std::vector<uint8_t> data(input_row_bytes_[i] * bucket, 0);
+    size_t offset = 0;
+    for (auto& request : *batch) {
+      std::memcpy(data.data() + offset, request.inputs[i].data(), request.inputs[i].size());
+      offset += request.inputs[i].size();
+    }
+    computation->SetTensorData(inputs[i], data.data(), data.size());
+  }
+
+  computation->Execute();
+
+  // scatter the outputs to requests, and the padding rows are dropped
+  auto outputs = computation->GetOutputTensors();
+  std::vector<Feed> results(batch->size(), Feed(outputs.size()));
+  for (int i = 0; i < outputs.size(); ++i) {
+    std::vector<uint8_t> data(output_row_bytes_[i] * bucket);
+    computation->GetTensorData(outputs[i], data.data(), data.size());
+    size_t offset = 0;
+    for (int j = 0; j < batch->size(); ++j) {
+      size_t nbytes = output_row_bytes_[i] * (*batch)[j].num_rows;
+      results[j][i].assign(data.begin() + offset, data.begin() + offset + nbytes);
+      offset += nbytes;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stats_.num_requests += batch->size();
+    stats_.num_batches += 1;
+    stats_.num_rows += bucket;
+    stats_.num_padding_rows += bucket - num_rows;
+  }
+  for (int j = 0; j < batch->size(); ++j) {
+    (*batch)[j].outputs.set_value(std::move(results[j]));
+  }
+}
+
+std::string SyntheticLoadResult::ToString() const {
+  std::stringstream ss;
+  ss << num_requests << " requests in " << seconds << "s, throughput: " << throughput
+     << " requests/s, p50 latency: " << p50_latency_us << "us, p99 latency: " << p99_latency_us << "us";
+  return ss.str();
+}
+
+SyntheticLoadResult RunSyntheticLoad(BatchingComputation* batching,
+                                     int num_clients,
+                                     int num_requests_per_client,
+                                     int64_t interval_us,
+                                     const std::function<BatchingComputation::Feed(int, int)>& make_inputs) {
+  CHECK_GT(num_clients, 0);
+  CHECK_GT(num_requests_per_client, 0);
+  std::vector<std::vector<double>> latencies(num_clients);
+  std::vector<std::thread> clients;
+  auto start = std::chrono::steady_clock::now();
+  for (int client = 0; client < num_clients; ++client) {
+    clients.emplace_back([&, client]() {
+      for (int i = 0; i < num_requests_per_client; ++i) {
+        auto inputs = make_inputs(client, i);
+        auto begin  = std::chrono::steady_clock::now();
+        batching->Submit(std::move(inputs)).get();
+        auto end = std::chrono::steady_clock::now();
+        latencies[client].push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+        if (interval_us > 0) {
+          std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
+        }
+      }
+    });
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  std::vector<double> all_latencies;
+  for (auto& client_latencies : latencies) {
+    all_latencies.insert(all_latencies.end(), client_latencies.begin(), client_latencies.end());
+  }
+  std::sort(all_latencies.begin(), all_latencies.end());
+  // the nearest-rank percentile
+  auto percentile = [&all_latencies](double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p * all_latencies.size()));
+    return all_latencies[std::max<size_t>(rank, 1) - 1];
+  };
+
+  SyntheticLoadResult result;
+  result.num_requests   = all_latencies.size();
+  result.seconds        = std::chrono::duration<double>(end - start).count();
+  result.throughput     = result.num_requests / result.seconds;
+  result.p50_latency_us = percentile(0.5);
+  result.p99_latency_us = percentile(0.99);
+  return result;
+}
+
+}  // namespace frontend
+}  // namespace cinn
@@ -0,0 +1,147 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cinn/frontend/computation.h"
+
+namespace cinn {
+namespace frontend {
+
+/**
+ * BatchingComputation serves single requests with computations compiled for a batch of them. The requests are
+ * queued and coalesced along the batch dimension, which is the leading dimension of all the inputs and outputs,
+ * and a batch is dispatched once it holds max_batch_size rows or its oldest request has waited for max_delay_us.
+ * The outputs of the batch are scattered back to the requests.
+ *
+ * One computation is compiled for each batch bucket, which are the powers of two below max_batch_size and
+ * max_batch_size itself. A batch is run by the smallest bucket holding it, and the padding rows are filled by zero.
+ * The computation of bucket 1 is compiled in the constructor to know the size of a row, the others are compiled
+ * at their first batch unless Warmup is called.
+ */
+class BatchingComputation {
+ public:
+  struct Options {
+    // the maximum number of rows of a batch, which is also the largest bucket
+    int max_batch_size{8};
+    // the maximum time in microseconds a request waits for others to fill the batch
+    int64_t max_delay_us{1000};
+  };
+
+  struct Stats {
+    int64_t num_requests{0};
+    int64_t num_batches{0};
+    // the number of rows of all batches and the number of padding rows among them
+    int64_t num_rows{0};
+    int64_t num_padding_rows{0};
+  };
+
+  // the host data of every input or output in the order of GetInputTensors or GetOutputTensors
+  using Feed = std::vector<std::vector<uint8_t>>;
+
+  // build the computation whose inputs and outputs have the leading dimension batch_size
+  using ComputationBuilder = std::function<std::shared_ptr<CinnComputation>(int batch_size)>;
+
+  BatchingComputation(ComputationBuilder builder, const Options& options);
+
+  ~BatchingComputation();
+
+  /**
+   * submit a request to the queue.
+   * @param inputs the data of the inputs, all of them should have the same number of rows
+   * @return the future of the outputs, with the same number of rows as the inputs
+   */
+  std::future<Feed> Submit(Feed inputs);
+
+  // compile the computations of all buckets ahead
+  void Warmup();
+
+  // the bucket running a batch of batch_size rows
+  int GetBucket(int batch_size) const;
+
+  const std::vector<int>& buckets() const { return buckets_; }
+
+  Stats GetStats() const;
+
+ private:
+  struct Request {
+    Feed inputs;
+    int num_rows;
+    std::chrono::steady_clock::time_point arrival;
+    std::promise<Feed> outputs;
+  };
+
+  CinnComputation* GetOrCompile(int bucket);
+
+  void DispatchLoop();
+
+  void RunBatch(std::vector<Request>* batch, int num_rows);
+
+  ComputationBuilder builder_;
+  Options options_;
+  std::vector<int> buckets_;
+
+  std::mutex compile_mtx_;
+  std::map<int, std::shared_ptr<CinnComputation>> computations_;
+  // the number of bytes per row of every input and output
+  std::vector<size_t> input_row_bytes_;
+  std::vector<size_t> output_row_bytes_;
+
+  mutable std::mutex mtx_;
+  std::condition_variable cv_;
+  std::deque<Request> queue_;
+  int queued_rows_{0};
+  bool stop_{false};
+  Stats stats_;
+  std::thread dispatcher_;
+};
+
+struct SyntheticLoadResult {
+  int64_t num_requests{0};
+  double seconds{0};
+  // requests per second
+  double throughput{0};
+  // latency in microseconds from submitting to receiving the outputs
+  double p50_latency_us{0};
+  double p99_latency_us{0};
+
+  std::string ToString() const;
+};
+
+/**
+ * Drive a BatchingComputation by num_clients closed-loop clients, each submits num_requests_per_client requests
+ * one after another, sleeping interval_us between them.
+ * @param make_inputs generate the inputs of a request from the client id and request id
+ */
+SyntheticLoadResult RunSyntheticLoad(BatchingComputation* batching,
+                                     int num_clients,
+                                     int num_requests_per_client,
+                                     int64_t interval_us,
+                                     const std::function<BatchingComputation::Feed(int, int)>& make_inputs);
+
+}  // namespace frontend
+}  // namespace cinn
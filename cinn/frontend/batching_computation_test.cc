@@ -0,0 +1,141 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/frontend/batching_computation.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "cinn/common/target.h"
+#include "cinn/frontend/net_builder.h"
+
+namespace cinn {
+namespace frontend {
+
+constexpr int N = 16;
+
+// out = relu(x) + y, both inputs are of shape [batch_size, N]
+std::shared_ptr<CinnComputation> BuildComputation(int batch_size) {
+  NetBuilder builder("batching_" + std::to_string(batch_size));
+  auto x = builder.CreateInput(Float(32), {batch_size, N}, "X");
+  auto y = builder.CreateInput(Float(32), {batch_size, N}, "Y");
+  auto r = builder.Relu(x);
+  auto o = builder.Add(r, y);
+  return CinnComputation::BuildAndCompile(common::DefaultHostTarget(), builder);
+}
+
+std::vector<uint8_t> ToBytes(const std::vector<float>& data) {
+  std::vector<uint8_t> bytes(data.size() * sizeof(float));
+  std::memcpy(bytes.data(), data.data(), bytes.size());
+  return bytes;
+}
+
+std::vector<float> ToFloats(const std::vector<uint8_t>& bytes) {
+  std::vector<float> data(bytes.size() / sizeof(float));
+  std::memcpy(data.data(), bytes.data(), bytes.size());
+  return data;
+}
+
+BatchingComputation::Feed MakeInputs(int client, int request, int num_rows) {
+  std::vector<float> x(num_rows * N), y(num_rows * N);
+  for (int i = 0; i < x.size(); ++i) {
+    x[i] = (i % 2 ? 1.f : -1.f) * (client + i);
+    y[i] = request;
+  }
+  return {ToBytes(x), ToBytes(y)};
+}
+
+void CheckOutputs(const BatchingComputation::Feed& inputs, const BatchingComputation::Feed& outputs) {
+  ASSERT_EQ(outputs.size(), 1UL);
+  auto x   = ToFloats(inputs[0]);
+  auto y   = ToFloats(inputs[1]);
+  auto out = ToFloats(outputs[0]);
+  ASSERT_EQ(out.size(), x.size());
+  for (int i = 0; i < out.size(); ++i) {
+    ASSERT_FLOAT_EQ(out[i], std::max(x[i], 0.f) + y[i]);
+  }
+}
+
+TEST(BatchingComputation, Buckets) {
+  BatchingComputation::Options options;
+  options.max_batch_size = 6;
+  BatchingComputation batching(BuildComputation, options);
+
+  ASSERT_EQ(batching.buckets(), std::vector<int>({1, 2, 4, 6}));
+  EXPECT_EQ(batching.GetBucket(1), 1);
+  EXPECT_EQ(batching.GetBucket(3), 4);
+  EXPECT_EQ(batching.GetBucket(5), 6);
+  EXPECT_EQ(batching.GetBucket(6), 6);
+}
+
+TEST(BatchingComputation, CoalesceAndScatter) {
+  BatchingComputation::Options options;
+  options.max_batch_size = 8;
+  options.max_delay_us   = 100000;
+  BatchingComputation batching(BuildComputation, options);
+  batching.Warmup();
+
+  // 3 requests with 5 rows in total are coalesced into one batch of bucket 8 after the delay
+  std::vector<BatchingComputation::Feed> inputs = {MakeInputs(0, 0, 1), MakeInputs(1, 1, 3), MakeInputs(2, 2, 1)};
+  std::vector<std::future<BatchingComputation::Feed>> futures;
+  for (auto& feed : inputs) {
+    futures.push_back(batching.Submit(feed));
+  }
+  for (int i = 0; i < inputs.size(); ++i) {
+    CheckOutputs(inputs[i], futures[i].get());
+  }
+
+  auto stats = batching.GetStats();
+  EXPECT_EQ(stats.num_requests, 3);
+  EXPECT_EQ(stats.num_batches, 1);
+  EXPECT_EQ(stats.num_rows, 8);
+  EXPECT_EQ(stats.num_padding_rows, 3);
+
+  // a full batch is dispatched without waiting for the delay
+  futures.clear();
+  inputs = {MakeInputs(3, 3, 4), MakeInputs(4, 4, 4)};
+  for (auto& feed : inputs) {
+    futures.push_back(batching.Submit(feed));
+  }
+  for (int i = 0; i < inputs.size(); ++i) {
+    CheckOutputs(inputs[i], futures[i].get());
+  }
+  EXPECT_EQ(batching.GetStats().num_batches, 2);
+  EXPECT_EQ(batching.GetStats().num_padding_rows, 3);
+}
+
+TEST(BatchingComputation, SyntheticLoad) {
+  BatchingComputation::Options options;
+  options.max_batch_size = 8;
+  options.max_delay_us   = 500;
+  BatchingComputation batching(BuildComputation, options);
+  batching.Warmup();
+
+  auto result = RunSyntheticLoad(&batching, 16, 50, 0, [](int client, int request) {
+    return MakeInputs(client, request, 1);
+  });
+  LOG(INFO) << result.ToString();
+  auto stats = batching.GetStats();
+  LOG(INFO) << "average batch size: " << static_cast<double>(stats.num_requests) / stats.num_batches;
+
+  EXPECT_EQ(result.num_requests, 16 * 50);
+  EXPECT_EQ(stats.num_requests, 16 * 50);
+  EXPECT_GT(result.throughput, 0);
+  EXPECT_LE(result.p50_latency_us, result.p99_latency_us);
+}
+
+}  // namespace frontend
+}  // namespace cinn
@@ -219,6 +219,15 @@ void CinnComputation::GetTensorData(const std::string &tname, void *data, size_t
   GetTensorData(t, data, size);
 }
 
+void CinnComputation::ShareTensorData(hlir::framework::Tensor &t, void *data, size_t size) {
+  t->ShareExternalData(data, size, context_->target, t->type());
+}
+
+void CinnComputation::ShareTensorData(const std::string &tname, void *data, size_t size) {
+  hlir::framework::Tensor t = GetTensor(tname);
+  ShareTensorData(t, data, size);
+}
+
 std::vector<hlir::framework::Tensor> CinnComputation::GetInputTensors() { return context_->inputs; }
 
 std::vector<hlir::framework::Tensor> CinnComputation::GetOutputTensors() { return context_->outputs; }
@@ -235,6 +244,33 @@ hlir::framework::Tensor CinnComputation::GetTensor(const std::string &tname) {
   return context_->scope->GetTensor(it->second);
 }
 
+hlir::framework::Program *CinnComputation::GetRuntimeProgram() { return context_->program.get(); }
+
+void CinnComputation::ExportAot(const std::string &prefix) {
+  CHECK(context_->target.arch == Target::Arch::X86) << "Only the program on X86 can be exported ahead of time";
+  auto *program = context_->program.get();
+  std::unordered_set<std::string> written_vars;
+  for (auto &instr : program->GetRunInstructions()) {
+    for (auto &args : instr->GetOutArgs()) {
+      written_vars.insert(args.begin(), args.end());
+    }
+  }
+  std::unordered_set<const hlir::framework::_Tensor_ *> inputs;
+  for (auto &t : context_->inputs) {
+    inputs.insert(t.get());
+  }
+  std::vector<std::string> persistent_vars;
+  for (auto &name : context_->scope->var_names()) {
+    std::string var_name(name);
+    if (!written_vars.count(var_name) && !inputs.count(context_->scope->GetTensor(var_name).get())) {
+      persistent_vars.push_back(var_name);
+    }
+  }
+
+  context_->graph_compiler->ExportLibrary(prefix + ".so");
+  program->Export(persistent_vars, prefix + ".params");
+}
+
 void CinnComputation::Execute(const std::map<std::string, cinn_pod_value_t> *name2podargs) {
   context_->program->Execute(name2podargs, context_->stream);
 }
@@ -148,6 +148,37 @@ class CinnComputation {
    */
   void GetTensorData(const std::string &tname, void *data, size_t size);
 
+  /**
+   * bind a user specified buffer to a tensor without copy, the program then reads the input from it or writes the
+   * output to it directly in later executions.
+   * the buffer should be on the target of the computation, hold the whole tensor, be aligned to the element size,
+   * and outlive the executions using it.
+   * @param t the tensor
+   * @param data address of the memory buffer owned by the caller
+   * @param size size of the memory buffer
+   */
+  void ShareTensorData(hlir::framework::Tensor &t, void *data, size_t size);
+  /**
+   * bind a user specified buffer to a tensor (specified by it's name) without copy.
+   * @param tname name of the tensor
+   * @param data address of the memory buffer owned by the caller
+   * @param size size of the memory buffer
+   */
+  void ShareTensorData(const std::string &tname, void *data, size_t size);
+
+  /**
+   * get the compiled runtime program, which is owned by the computation
+   */
+  hlir::framework::Program *GetRuntimeProgram();
+
+  /**
+   * export the compiled program on X86 to be deployed by the tiny runtime without the compiler stack, which writes
+   * the kernels into the shared library `<prefix>.so` and the program into the parameter file `<prefix>.params`.
+   * the parameters held in the file are the variables never written by the program except the inputs.
+   * @param prefix the path prefix of the exported files
+   */
+  void ExportAot(const std::string &prefix);
+
   /**
    * run the compiled program
    */
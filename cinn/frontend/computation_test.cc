@@ -14,16 +14,23 @@
 
 #include "cinn/frontend/computation.h"
 
+#include <dlfcn.h>
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
 #include "cinn/common/target.h"
 #include "cinn/frontend/decomposer/use_decomposer.h"
 #include "cinn/frontend/decomposer_registry.h"
 #include "cinn/frontend/net_builder.h"
 #include "cinn/frontend/pass/use_program_pass.h"
 #include "cinn/frontend/program_pass.h"
+#include "cinn/runtime/tiny_runtime.h"
 
 DEFINE_string(model_dir, "", "");
+DECLARE_int32(cinn_parallel_compile_size);
 
 namespace cinn {
 namespace frontend {
@@ -102,6 +109,111 @@ TEST(cinn_computation, basic_cpu) {
   }
 }
 
+TEST(cinn_computation, share_tensor_data_cpu) {
+  NetBuilder builder("share_tensor_data");
+  constexpr int M = 32;
+  constexpr int N = 24;
+
+  auto a = builder.CreateInput(Float(32), {M, N}, "A");
+  auto b = builder.CreateInput(Float(32), {M, N}, "B");
+  auto c = builder.Add(a, b);
+
+  auto target = common::DefaultHostTarget();
+  auto comp   = CinnComputation::BuildAndCompile(target, builder);
+  std::vector<float> hostA(M * N);
+  std::vector<float> hostB(M * N);
+  std::vector<float> hostC(M * N);
+  comp->ShareTensorData("A", reinterpret_cast<void *>(hostA.data()), hostA.size() * sizeof(float));
+  comp->ShareTensorData("B", reinterpret_cast<void *>(hostB.data()), hostB.size() * sizeof(float));
+  comp->ShareTensorData(c->id, reinterpret_cast<void *>(hostC.data()), hostC.size() * sizeof(float));
+
+  // the inputs are updated in place, and the output is written to the user buffer without copy
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < M * N; i++) {
+      hostA[i] = static_cast<float>(rand()) / INT_MAX;
+      hostB[i] = static_cast<float>(rand()) / INT_MAX;
+    }
+    comp->Execute();
+    for (int i = 0; i < hostC.size(); i++) {
+      ASSERT_NEAR(hostC[i], hostA[i] + hostB[i], 1e-5);
+    }
+  }
+  ASSERT_EQ(comp->GetTensor(c->id)->data<float>(), hostC.data());
+}
+
+TEST(cinn_computation, export_aot_cpu) {
+  auto target = common::DefaultHostTarget();
+  auto prog   = CreateAddProgram();
+  auto comp   = CinnComputation::Compile(target, prog);
+
+  std::string prefix = "./export_aot_cpu";
+  comp->ExportAot(prefix);
+
+  std::ifstream params(prefix + ".params", std::ios::binary);
+  ASSERT_TRUE(params.good());
+  char magic[4];
+  params.read(magic, 4);
+  ASSERT_EQ(std::string(magic, 4), "CINN");
+
+  // the kernels are resolved lazily, since the runtime functions they call are provided by the loading process
+  void *handle = dlopen((prefix + ".so").c_str(), RTLD_LAZY | RTLD_LOCAL);
+  ASSERT_NE(handle, nullptr) << dlerror();
+  for (auto &instr : comp->GetRuntimeProgram()->GetRunInstructions()) {
+    for (auto &fn_name : instr->GetFnNames()) {
+      ASSERT_NE(dlsym(handle, fn_name.c_str()), nullptr) << fn_name;
+    }
+  }
+  dlclose(handle);
+  std::remove((prefix + ".so").c_str());
+  std::remove((prefix + ".params").c_str());
+}
+
+TEST(cinn_computation, export_aot_multi_task_cpu) {
+  // compile every group by a task of its own, whose object files are linked into one library
+  int parallel_compile_size        = FLAGS_cinn_parallel_compile_size;
+  FLAGS_cinn_parallel_compile_size = 1;
+  auto target                      = common::DefaultHostTarget();
+  auto prog                        = CreateTestProgram();
+  auto comp                        = CinnComputation::Compile(target, prog);
+  FLAGS_cinn_parallel_compile_size = parallel_compile_size;
+  std::string out_name             = prog[prog.size() - 1].GetOutput(0)->id;
+
+  std::vector<float> hostA(32 * 12), hostB(32 * 12);
+  for (int i = 0; i < hostA.size(); i++) {
+    hostA[i] = static_cast<float>(rand()) / INT_MAX;
+    hostB[i] = static_cast<float>(rand()) / INT_MAX + 0.5f;
+  }
+  comp->SetTensorData("A", hostA.data(), hostA.size() * sizeof(float));
+  comp->SetTensorData("B", hostB.data(), hostB.size() * sizeof(float));
+  comp->Execute();
+  auto out_tensor = comp->GetTensor(out_name);
+  std::vector<float> expected(out_tensor->shape().numel());
+  comp->GetTensorData(out_tensor, expected.data(), expected.size() * sizeof(float));
+
+  std::string prefix = "./export_aot_multi_task_cpu";
+  comp->ExportAot(prefix);
+  void *ctx = load_program_from_library((prefix + ".so").c_str(), (prefix + ".params").c_str());
+  ASSERT_NE(ctx, nullptr);
+  for (auto &input : {std::make_pair("A", &hostA), std::make_pair("B", &hostB)}) {
+    size_t size = 0;
+    void *data  = get_tensor_data(ctx, input.first, &size);
+    ASSERT_NE(data, nullptr);
+    ASSERT_EQ(size, input.second->size() * sizeof(float));
+    std::memcpy(data, input.second->data(), size);
+  }
+  run_program(ctx);
+  size_t out_size = 0;
+  auto *result    = static_cast<float *>(get_tensor_data(ctx, out_name.c_str(), &out_size));
+  ASSERT_NE(result, nullptr);
+  ASSERT_EQ(out_size, expected.size() * sizeof(float));
+  for (int i = 0; i < expected.size(); i++) {
+    ASSERT_FLOAT_EQ(result[i], expected[i]);
+  }
+  free_program(ctx);
+  std::remove((prefix + ".so").c_str());
+  std::remove((prefix + ".params").c_str());
+}
+
 #ifdef CINN_WITH_CUDA
 TEST(cinn_computation, basic_gpu) {
   NetBuilder builder("basic");
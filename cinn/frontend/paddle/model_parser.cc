@@ -14,6 +14,13 @@
 
 #include "cinn/frontend/paddle/model_parser.h"
 
+#include <fcntl.h>
+#include <gflags/gflags.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
 #include <fstream>
 #include <vector>
 
@@ -23,6 +30,11 @@
 #include "cinn/backends/cuda_util.h"
 #include "cinn/common/common.h"
 #include "cinn/frontend/paddle/compatible_pb.h"
+#include "cinn/utils/multi_threading.h"
+#include "cinn/utils/profiler.h"
+
+DECLARE_bool(cinn_load_params_by_mmap);
+DECLARE_int32(cinn_load_params_num_threads);
 
 namespace cinn::frontend::paddle {
 
@@ -129,6 +141,122 @@ void LoadLoDTensor(std::istream &is, hlir::framework::Variable *var, const commo
   TensorFromStream(is, tensor.operator->(), target);
 }
 
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Cannot open file: " << path;
+  struct stat st;
+  CHECK_EQ(fstat(fd, &st), 0) << "Cannot get the size of file: " << path;
+  void *addr = nullptr;
+  if (st.st_size > 0) {
+    // mapped writable but private, so the writes to parameters, if any, are not seen by the file or other processes
+    addr = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    CHECK(addr != MAP_FAILED) << "Cannot map file: " << path;
+  }
+  close(fd);
+  return std::shared_ptr<MappedFile>(new MappedFile(static_cast<uint8_t *>(addr), st.st_size));
+}
+
+MappedFile::~MappedFile() {
+  if (data_) munmap(data_, size_);
+}
+
+namespace {
+
+// read a value at the offset of the mapped file and advance the offset past it
+template <typename T>
+T ReadMapped(const MappedFile &file, size_t *offset) {
+  CHECK_LE(*offset + sizeof(T), file.size()) << "The mapped file is truncated";
+  T value;
+  std::memcpy(&value, file.data() + *offset, sizeof(T));
+  *offset += sizeof(T);
+  return value;
+}
+
+common::Type GetTensorType(framework_proto::VarType::Type type) {
+  using Type = framework_proto::VarType::Type;
+  switch (static_cast<int>(type)) {
+    case Type::VarType_Type_FP32:
+      return Float(32);
+    case Type::VarType_Type_INT8:
+      return Int(8);
+    case Type::VarType_Type_INT16:
+      return Int(16);
+    case Type::VarType_Type_INT32:
+      return Int(32);
+    case Type::VarType_Type_INT64:
+      return Int(64);
+    default:
+      LOG(FATAL) << "unknown type " << type;
+  }
+  return common::Type();
+}
+
+void TensorFromMappedFile(const std::shared_ptr<MappedFile> &file,
+                          size_t *offset,
+                          hlir::framework::_Tensor_ *tensor,
+                          const common::Target &target) {
+  uint32_t version = ReadMapped<uint32_t>(*file, offset);
+  CHECK_EQ(version, 0U) << "Only version 0 is supported";
+  // read tensor desc
+  framework_proto::VarType::TensorDesc desc;
+  int32_t desc_size = ReadMapped<int32_t>(*file, offset);
+  CHECK_LE(*offset + desc_size, file->size()) << "The mapped file is truncated";
+  CHECK(desc.ParseFromArray(file->data() + *offset, desc_size)) << "Cannot parse tensor desc";
+  *offset += desc_size;
+
+  // read tensor
+  std::vector<int32_t> dims_vec(desc.dims().begin(), desc.dims().end());
+  tensor->Resize(hlir::framework::Shape(dims_vec));
+  size_t size = tensor->shape().numel() * SizeOfType(desc.data_type());
+  CHECK_LE(*offset + size, file->size()) << "The mapped file is truncated";
+  uint8_t *data = file->data() + *offset;
+  *offset += size;
+
+  if (target.arch == Target::Arch::X86) {
+    auto type = GetTensorType(desc.data_type());
+    if (reinterpret_cast<uintptr_t>(data) % type.bytes() == 0) {
+      // the tensor keeps the file mapped as long as it refers to the file
+      tensor->ShareExternalData(data, size, target, type, 0, file);
+    } else {
+      VLOG(4) << "The tensor at offset " << *offset - size << " is not aligned to " << type.bytes()
+              << " bytes, copy it";
+      std::memcpy(tensor->mutable_data(target, type), data, size);
+    }
+  } else if (target.arch == Target::Arch::NVGPU) {
+#ifdef CINN_WITH_CUDA
+    CHECK(desc.data_type() == framework_proto::VarType::Type::VarType_Type_FP32) << "[CUDA] The type is not fp32!!";
+    auto *dst = tensor->mutable_data<float>(target);
+    tensor->set_type(Float(32));
+    CUDA_CALL(cudaMemcpy(reinterpret_cast<void *>(dst), data, size, cudaMemcpyHostToDevice));
+#else
+    LOG(FATAL) << "To use CUDA backends, you need to set WITH_CUDA ON!";
+#endif
+  } else {
+    CINN_NOT_IMPLEMENTED
+  }
+}
+
+}  // namespace
+
+void LoadLoDTensor(const std::shared_ptr<MappedFile> &file,
+                   size_t *offset,
+                   hlir::framework::Variable *var,
+                   const common::Target &target) {
+  auto &tensor     = absl::get<hlir::framework::Tensor>(*var);
+  uint32_t version = ReadMapped<uint32_t>(*file, offset);
+  VLOG(3) << "model version " << version;
+
+  // Skip LoD information
+  uint64_t lod_level = ReadMapped<uint64_t>(*file, offset);
+  for (uint64_t i = 0; i < lod_level; ++i) {
+    uint64_t size = ReadMapped<uint64_t>(*file, offset);
+    CHECK_LE(*offset + size, file->size()) << "The mapped file is truncated";
+    *offset += size;
+  }
+
+  TensorFromMappedFile(file, offset, tensor.operator->(), target);
+}
+
 void ReadBinaryFile(const std::string &filename, std::string *contents) {
   std::ifstream fin(filename, std::ios::in | std::ios::binary);
   CHECK(fin.is_open()) << "Cannot open file: " << filename;
@@ -170,16 +298,13 @@ bool IsPersistable(const cpp::VarDesc &var) {
   return false;
 }
 
-void LoadCombinedParamsPb(const std::string &path,
-                          hlir::framework::Scope *scope,
-                          const cpp::ProgramDesc &cpp_prog,
-                          bool params_from_memory,
-                          const common::Target &target) {
-  CHECK(scope);
+namespace {
+
+// the parameters in the order of the combined parameter file
+std::vector<std::string> GetCombinedParamList(const cpp::ProgramDesc &cpp_prog) {
   auto prog             = cpp_prog;
   auto &main_block_desc = *prog.GetBlock<cpp::BlockDesc>(0);
 
-  // Get vars
   std::vector<std::string> paramlist;
   for (size_t i = 0; i < main_block_desc.VarsSize(); ++i) {
     auto &var = *main_block_desc.GetVar<cpp::VarDesc>(i);
@@ -187,6 +312,161 @@ void LoadCombinedParamsPb(const std::string &path,
     paramlist.push_back(var.Name());
   }
   std::sort(paramlist.begin(), paramlist.end());
+  return paramlist;
+}
+
+}  // namespace
+
+std::vector<ParamIndex> IndexCombinedParams(std::istream &is, size_t num_params) {
+  std::vector<ParamIndex> index(num_params);
+  for (auto &param : index) {
+    CHECK(static_cast<bool>(is)) << "There is a problem with loading model parameters";
+    uint32_t version{};
+    is.read(reinterpret_cast<char *>(&version), sizeof(version));
+    // skip LoD information
+    uint64_t lod_level{};
+    is.read(reinterpret_cast<char *>(&lod_level), sizeof(lod_level));
+    for (uint64_t i = 0; i < lod_level; ++i) {
+      uint64_t size;
+      is.read(reinterpret_cast<char *>(&size), sizeof(size));
+      is.seekg(size, std::ios::cur);
+    }
+
+    uint32_t tensor_version;
+    is.read(reinterpret_cast<char *>(&tensor_version), sizeof(tensor_version));
+    CHECK_EQ(tensor_version, 0U) << "Only version 0 is supported";
+    int32_t desc_size;
+    is.read(reinterpret_cast<char *>(&desc_size), sizeof(desc_size));
+    std::unique_ptr<char[]> buf(new char[desc_size]);
+    is.read(buf.get(), desc_size);
+    framework_proto::VarType::TensorDesc desc;
+    CHECK(desc.ParseFromArray(buf.get(), desc_size)) << "Cannot parse tensor desc";
+
+    param.dims.assign(desc.dims().begin(), desc.dims().end());
+    param.data_type = desc.data_type();
+    int64_t numel   = 1;
+    for (int32_t dim : param.dims) numel *= dim;
+    param.data_size   = numel * SizeOfType(desc.data_type());
+    param.data_offset = is.tellg();
+    is.seekg(param.data_size, std::ios::cur);
+  }
+  is.peek();
+  CHECK(is.eof()) << "You are not allowed to load partial data via"
+                  << " LoadCombinedParamsPb, use LoadParam instead.";
+  return index;
+}
+
+CombinedParamsLoader::CombinedParamsLoader(const std::string &path,
+                                           hlir::framework::Scope *scope,
+                                           const cpp::ProgramDesc &cpp_prog,
+                                           const common::Target &target,
+                                           int num_threads)
+    : target_(target) {
+  CHECK(scope);
+  utils::RecordEvent record_event("CombinedParamsLoader Index", utils::EventType::kOrdinary);
+  auto paramlist = GetCombinedParamList(cpp_prog);
+  {
+    std::ifstream fin(path, std::ios::binary);
+    CHECK(fin.is_open()) << "Cannot open file: " << path;
+    index_ = IndexCombinedParams(fin, paramlist.size());
+  }
+  fd_ = open(path.c_str(), O_RDONLY);
+  CHECK_GE(fd_, 0) << "Cannot open file: " << path;
+
+  // the tensors are allocated here, so that they are not reallocated when accessed during reading
+  for (int i = 0; i < paramlist.size(); ++i) {
+    auto name = utils::TransValidVarName(paramlist[i]);
+    auto &t   = absl::get<hlir::framework::Tensor>(*scope->Var<hlir::framework::Tensor>(name));
+    t->Resize(hlir::framework::Shape(index_[i].dims));
+    if (target_.arch == Target::Arch::X86) {
+      t->mutable_data(target_, GetTensorType(index_[i].data_type));
+    } else if (target_.arch == Target::Arch::NVGPU) {
+      CHECK(index_[i].data_type == framework_proto::VarType::Type::VarType_Type_FP32)
+          << "[CUDA] The type is not fp32!!";
+      t->mutable_data<float>(target_);
+      t->set_type(Float(32));
+    } else {
+      CINN_NOT_IMPLEMENTED
+    }
+    tensors_.push_back(t);
+    name2idx_[name] = i;
+  }
+  ready_.resize(index_.size(), false);
+
+  if (num_threads == -1) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+  num_threads = std::max(1, std::min<int>(num_threads, index_.size()));
+
+  reader_ = std::thread([this, num_threads]() {
+    utils::RecordEvent record_event("CombinedParamsLoader Read", utils::EventType::kOrdinary);
+    utils::parallel_run([this](int idx) { ReadData(idx); }, utils::SequenceDispatcher(0, index_.size()), num_threads);
+  });
+}
+
+CombinedParamsLoader::~CombinedParamsLoader() {
+  WaitAll();
+  close(fd_);
+}
+
+void CombinedParamsLoader::ReadData(int idx) {
+  auto &param = index_[idx];
+  std::vector<uint8_t> host_buffer;
+  uint8_t *dst = nullptr;
+  if (target_.arch == Target::Arch::X86) {
+    dst = static_cast<uint8_t *>(tensors_[idx]->mutable_data(target_, tensors_[idx]->type()));
+  } else {
+    host_buffer.resize(param.data_size);
+    dst = host_buffer.data();
+  }
+
+  // pread is used to read the file by multiple threads without sharing the position
+  size_t nread = 0;
+  while (nread < param.data_size) {
+    ssize_t ret = pread(fd_, dst + nread, param.data_size - nread, param.data_offset + nread);
+    CHECK_GT(ret, 0) << "Failed to read the parameter at offset " << param.data_offset + nread;
+    nread += ret;
+  }
+
+  if (target_.arch == Target::Arch::NVGPU) {
+#ifdef CINN_WITH_CUDA
+    CUDA_CALL(cudaMemcpy(tensors_[idx]->mutable_data<float>(target_), dst, param.data_size, cudaMemcpyHostToDevice));
+#else
+    LOG(FATAL) << "To use CUDA backends, you need to set WITH_CUDA ON!";
+#endif
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ready_[idx] = true;
+  }
+  cv_.notify_all();
+}
+
+void CombinedParamsLoader::Wait(const std::string &name) {
+  auto it = name2idx_.find(name);
+  if (it == name2idx_.end()) {
+    return;
+  }
+  int idx = it->second;
+  std::unique_lock<std::mutex> lock(mtx_);
+  cv_.wait(lock, [this, idx] { return ready_[idx]; });
+}
+
+void CombinedParamsLoader::WaitAll() {
+  if (reader_.joinable()) {
+    reader_.join();
+  }
+}
+
+void LoadCombinedParamsPb(const std::string &path,
+                          hlir::framework::Scope *scope,
+                          const cpp::ProgramDesc &cpp_prog,
+                          bool params_from_memory,
+                          const common::Target &target) {
+  CHECK(scope);
+  // Get vars
+  auto paramlist = GetCombinedParamList(cpp_prog);
 
   // Load vars
   auto load_var_func = [&](std::istream &is) {
@@ -204,6 +484,18 @@ void LoadCombinedParamsPb(const std::string &path,
   if (params_from_memory) {
     std::stringstream fin(path, std::ios::in | std::ios::binary);
     load_var_func(fin);
+  } else if (!FLAGS_cinn_load_params_by_mmap && FLAGS_cinn_load_params_num_threads != 1) {
+    CombinedParamsLoader loader(path, scope, cpp_prog, target, FLAGS_cinn_load_params_num_threads);
+    loader.WaitAll();
+  } else if (FLAGS_cinn_load_params_by_mmap) {
+    auto file     = MappedFile::Open(path);
+    size_t offset = 0;
+    for (size_t i = 0; i < paramlist.size(); ++i) {
+      auto *var = scope->Var<hlir::framework::Tensor>(utils::TransValidVarName(paramlist[i]));
+      LoadLoDTensor(file, &offset, var, target);
+    }
+    CHECK_EQ(offset, file->size()) << "You are not allowed to load partial data via"
+                                   << " LoadCombinedParamsPb, use LoadParam instead.";
   } else {
     std::ifstream fin(path, std::ios::binary);
     CHECK(fin.is_open());
@@ -218,7 +510,8 @@ void LoadModelPb(const std::string &model_dir,
                  cpp::ProgramDesc *cpp_prog,
                  bool combined,
                  bool model_from_memory,
-                 const common::Target &target) {
+                 const common::Target &target,
+                 std::unique_ptr<CombinedParamsLoader> *params_loader) {
   CHECK(cpp_prog);
   CHECK(scope);
   cpp_prog->ClearBlocks();
@@ -244,7 +537,11 @@ void LoadModelPb(const std::string &model_dir,
   CHECK(!(!combined && model_from_memory)) << "If you want use the model_from_memory,"
                                            << " you should load the combined model using cfg.set_model_buffer "
                                               "interface.";
-  if (combined) {
+  if (combined && params_loader && !model_from_memory && !FLAGS_cinn_load_params_by_mmap &&
+      FLAGS_cinn_load_params_num_threads != 1) {
+    params_loader->reset(
+        new CombinedParamsLoader(param_file_temp, scope, *cpp_prog, target, FLAGS_cinn_load_params_num_threads));
+  } else if (combined) {
     LoadCombinedParamsPb(param_file_temp, scope, *cpp_prog, model_from_memory, target);
   } else {
     auto main_block = pb_proto_prog.blocks(0);
@@ -254,13 +551,14 @@ void LoadModelPb(const std::string &model_dir,
       std::string file_path = model_dir + "/" + var.name();
       VLOG(4) << "reading weight " << var.name();
 
-      std::ifstream file(file_path, std::ios::binary);
-      switch (var.type().type()) {
-        case framework_proto::VarType_Type_LOD_TENSOR:
-          LoadLoDTensor(file, scope->Var<hlir::framework::Tensor>(utils::TransValidVarName(var.name())), target);
-          break;
-        default:
-          LOG(FATAL) << "unknown weight type";
+      CHECK(var.type().type() == framework_proto::VarType_Type_LOD_TENSOR) << "unknown weight type";
+      auto *out = scope->Var<hlir::framework::Tensor>(utils::TransValidVarName(var.name()));
+      if (FLAGS_cinn_load_params_by_mmap) {
+        size_t offset = 0;
+        LoadLoDTensor(MappedFile::Open(file_path), &offset, out, target);
+      } else {
+        std::ifstream file(file_path, std::ios::binary);
+        LoadLoDTensor(file, out, target);
       }
     }
   }
@@ -14,8 +14,12 @@
 
 #pragma once
 #include <algorithm>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "cinn/frontend/paddle/cpp/program_desc.h"
@@ -29,21 +33,50 @@
 namespace cinn::frontend::paddle {
 namespace framework_proto = ::cinn::frontend::paddle::proto;
 
-// Read a model and files of parameters in pb format.
+class CombinedParamsLoader;
+
+// Read a model and files of parameters in pb format. If \p params_loader is given and the combined parameters are
+// read by multiple threads, the loader is returned without waiting for the data of parameters.
 void LoadModelPb(const std::string& model_dir,
                  const std::string& model_file,
                  const std::string& param_file,
                  hlir::framework::Scope* scope,
                  cpp::ProgramDesc* cpp_prog,
-                 bool combined                = true,
-                 bool model_from_memory       = false,
-                 const common::Target& target = common::DefaultHostTarget());
+                 bool combined                                       = true,
+                 bool model_from_memory                              = false,
+                 const common::Target& target                        = common::DefaultHostTarget(),
+                 std::unique_ptr<CombinedParamsLoader>* params_loader = nullptr);
 
 // Read a __model__ file.
 std::unique_ptr<framework_proto::ProgramDesc> LoadProgram(const std::string& path, bool program_from_memory = false);
 
 void LoadLoDTensor(std::istream& is, hlir::framework::Variable* var, const common::Target& target);
 
+// A file mapped into memory privately, whose pages are shared with the other processes mapping the same file until
+// they are written.
+class MappedFile {
+ public:
+  static std::shared_ptr<MappedFile> Open(const std::string& path);
+
+  ~MappedFile();
+
+  uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile(uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  uint8_t* data_;
+  size_t size_;
+};
+
+// Load a LoDTensor at \p offset of the mapped \p file and advance the offset past it. The tensor on X86 refers to
+// the mapped memory if it is aligned to the element size, and it is copied otherwise.
+void LoadLoDTensor(const std::shared_ptr<MappedFile>& file,
+                   size_t* offset,
+                   hlir::framework::Variable* var,
+                   const common::Target& target);
+
 // Read a single file containing all the parameters.
 void LoadParams(const std::string& path);
 
@@ -56,6 +89,54 @@ void LoadCombinedParamsPb(const std::string& path,
                           bool params_from_memory      = false,
                           const common::Target& target = common::DefaultHostTarget());
 
+// The position of the data of a LoDTensor in a combined parameter file, found by scanning the headers of tensors.
+struct ParamIndex {
+  std::vector<int32_t> dims;
+  framework_proto::VarType::Type data_type;
+  size_t data_offset;
+  size_t data_size;
+};
+
+// Scan the headers of \p num_params LoDTensors from the beginning of the stream, skipping the data of them.
+std::vector<ParamIndex> IndexCombinedParams(std::istream& is, size_t num_params);
+
+/**
+ * CombinedParamsLoader reads a combined parameter file by multiple threads. The file is scanned once to index the
+ * tensors, whose shapes are set and memory is allocated before the constructor returns, then the data of tensors is
+ * read concurrently in the background. So the program can be built while the parameters are streaming in, and the
+ * data of a parameter should be waited by Wait before being accessed.
+ */
+class CombinedParamsLoader {
+ public:
+  CombinedParamsLoader(const std::string& path,
+                       hlir::framework::Scope* scope,
+                       const cpp::ProgramDesc& cpp_prog,
+                       const common::Target& target,
+                       int num_threads = -1);
+
+  ~CombinedParamsLoader();
+
+  // Wait until the data of the parameter \p name is read, it returns at once if the parameter is not in the file.
+  void Wait(const std::string& name);
+
+  // Wait until the data of all the parameters is read.
+  void WaitAll();
+
+ private:
+  void ReadData(int idx);
+
+  common::Target target_;
+  int fd_{-1};
+  std::vector<ParamIndex> index_;
+  std::vector<hlir::framework::Tensor> tensors_;
+  std::unordered_map<std::string, int> name2idx_;
+
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::vector<bool> ready_;
+  std::thread reader_;
+};
+
 // LoDTensor to ostream
 void TensorToStream(std::ostream& os, const hlir::framework::_Tensor_& tensor);
 void TensorFromStream(std::istream& is,
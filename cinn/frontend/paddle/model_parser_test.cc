@@ -17,6 +17,10 @@
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
+#include <cstring>
+#include <fstream>
+
+DECLARE_bool(cinn_load_params_by_mmap);
 DEFINE_string(model_dir, "<NOTEXIST>", "model directory path");
 
 namespace cinn::frontend::paddle {
@@ -42,4 +46,88 @@ TEST(LoadModelPb, naive_model) {
   // fetch
 }
 
+TEST(LoadModelPb, mmap_params) {
+  hlir::framework::Scope scope;
+  cpp::ProgramDesc program_desc;
+  LoadModelPb(FLAGS_model_dir, "__model__", "", &scope, &program_desc, false);
+
+  FLAGS_cinn_load_params_by_mmap = true;
+  hlir::framework::Scope mapped_scope;
+  LoadModelPb(FLAGS_model_dir, "__model__", "", &mapped_scope, &program_desc, false);
+  FLAGS_cinn_load_params_by_mmap = false;
+
+  auto var_names = scope.var_names();
+  ASSERT_FALSE(var_names.empty());
+  ASSERT_EQ(mapped_scope.var_names().size(), var_names.size());
+  for (auto& name : var_names) {
+    auto expected = scope.GetTensor(std::string(name));
+    auto actual   = mapped_scope.GetTensor(std::string(name));
+    ASSERT_EQ(actual->shape().data(), expected->shape().data());
+    ASSERT_EQ(actual->type(), expected->type());
+    size_t size = expected->shape().numel() * expected->type().bytes();
+    ASSERT_EQ(std::memcmp(actual->data<void>(), expected->data<void>(), size), 0) << name;
+  }
+}
+
+// write a LoDTensor of fp32 in the format of paddle
+void WriteLoDTensor(std::ostream& os, const std::vector<int64_t>& dims, const std::vector<float>& data) {
+  uint32_t version   = 0;
+  uint64_t lod_level = 1;
+  os.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  os.write(reinterpret_cast<const char*>(&lod_level), sizeof(lod_level));
+  std::vector<uint64_t> lod = {0, 1};
+  uint64_t lod_size         = lod.size() * sizeof(uint64_t);
+  os.write(reinterpret_cast<const char*>(&lod_size), sizeof(lod_size));
+  os.write(reinterpret_cast<const char*>(lod.data()), lod_size);
+
+  os.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  framework_proto::VarType::TensorDesc desc;
+  desc.set_data_type(framework_proto::VarType::FP32);
+  for (auto dim : dims) desc.add_dims(dim);
+  std::string desc_str = desc.SerializeAsString();
+  int32_t desc_size    = desc_str.size();
+  os.write(reinterpret_cast<const char*>(&desc_size), sizeof(desc_size));
+  os.write(desc_str.data(), desc_size);
+  os.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+}
+
+TEST(CombinedParamsLoader, basic) {
+  // the parameters are stored in the order of their names
+  std::vector<std::string> names         = {"a", "b", "c"};
+  std::vector<std::vector<int64_t>> dims = {{2, 3}, {7}, {4, 1, 5}};
+  std::vector<std::vector<float>> data(names.size());
+  cpp::ProgramDesc program_desc;
+  auto* block      = program_desc.AddBlock<cpp::BlockDesc>();
+  std::string path = "./combined_params";
+  std::ofstream fout(path, std::ios::binary);
+  for (int i = 0; i < names.size(); i++) {
+    auto* var = block->AddVar<cpp::VarDesc>();
+    var->SetName(names[i]);
+    var->SetType(cpp::VarDescAPI::Type::LOD_TENSOR);
+    var->SetPersistable(true);
+    int64_t numel = 1;
+    for (auto dim : dims[i]) numel *= dim;
+    for (int j = 0; j < numel; j++) {
+      data[i].push_back(i * 100 + j);
+    }
+    WriteLoDTensor(fout, dims[i], data[i]);
+  }
+  fout.close();
+
+  hlir::framework::Scope scope;
+  CombinedParamsLoader loader(path, &scope, program_desc, common::DefaultHostTarget(), 2);
+  // the shapes are set before the data is read
+  for (int i = 0; i < names.size(); i++) {
+    auto t = scope.GetTensor(names[i]);
+    ASSERT_EQ(t->shape().numel(), data[i].size());
+  }
+  loader.Wait("b");
+  ASSERT_EQ(std::memcmp(scope.GetTensor("b")->data<float>(), data[1].data(), data[1].size() * sizeof(float)), 0);
+  loader.WaitAll();
+  for (int i = 0; i < names.size(); i++) {
+    auto t = scope.GetTensor(names[i]);
+    ASSERT_EQ(std::memcmp(t->data<float>(), data[i].data(), data[i].size() * sizeof(float)), 0) << names[i];
+  }
+}
+
 }  // namespace cinn::frontend::paddle
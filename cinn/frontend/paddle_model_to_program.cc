@@ -91,6 +91,7 @@ void PaddleModelToProgram::AddOpMapper_scale() {
     } else {  // the newly refactored format
       // load scale tensor
       CHECK_EQ(op_desc.Input("ScaleTensor").size(), 1UL);
+      WaitParam(op_desc.Input("ScaleTensor").front());
       auto* scale_tensor_var = scope_->FindVar(op_desc.Input("ScaleTensor").front());
       CHECK(scale_tensor_var) << "No scale tensor found in the scope";
       auto& scale_tensor = absl::get<hlir::framework::Tensor>(*scale_tensor_var);
@@ -611,6 +612,7 @@ void PaddleModelToProgram::AddOp(const paddle::cpp::OpDesc& op_desc) {
 
 void PaddleModelToProgram::TransposeVar(const std::string& name) {
   CheckVarNameValid(name);
+  WaitParam(name);
   auto* var = scope_->FindVar(name);
   if (var) {
     auto& tensor = absl::get<hlir::framework::Tensor>(*var);
@@ -657,6 +659,7 @@ void PaddleModelToProgram::TransposeVar(const std::string& name) {
 
 void PaddleModelToProgram::ReverseHWVar(const std::string& name) {
   CheckVarNameValid(name);
+  WaitParam(name);
   auto* var = scope_->FindVar(name);
   if (var) {
     auto& tensor = absl::get<hlir::framework::Tensor>(*var);
@@ -713,7 +716,8 @@ Variable PaddleModelToProgram::GetVar(const std::string& name) {
 
 std::unique_ptr<Program> PaddleModelToProgram::operator()(const std::string& model_dir, bool is_combined) {
   paddle::cpp::ProgramDesc program_desc;
-  paddle::LoadModelPb(model_dir, "__model__", "", scope_, &program_desc, is_combined, false, target_);
+  // the ops are mapped while the parameters are streaming in if they are read by multiple threads
+  paddle::LoadModelPb(model_dir, "__model__", "", scope_, &program_desc, is_combined, false, target_, &params_loader_);
   CHECK_EQ(program_desc.BlocksSize(), 1) << "CINN can only support the model with a single block";
   auto* block_desc = program_desc.GetBlock<paddle::cpp::BlockDesc>(0);
 
@@ -721,9 +725,18 @@ std::unique_ptr<Program> PaddleModelToProgram::operator()(const std::string& mod
     auto* op_desc = block_desc->GetOp<paddle::cpp::OpDesc>(i);
     AddOp(*op_desc);
   }
+  if (params_loader_) {
+    params_loader_->WaitAll();
+  }
   return std::unique_ptr<Program>(new Program(net_builder_->Build()));
 }
 
+void PaddleModelToProgram::WaitParam(const std::string& name) {
+  if (params_loader_) {
+    params_loader_->Wait(name);
+  }
+}
+
 void PaddleModelToProgram::AddVar(const std::string& name, const Variable& var, bool replace) {
   CheckVarNameValid(name);
   if (replace == false) {
@@ -31,6 +31,7 @@
 #include "cinn/common/type.h"
 #include "cinn/frontend/net_builder.h"
 #include "cinn/frontend/paddle/cpp/program_desc.h"
+#include "cinn/frontend/paddle/model_parser.h"
 #include "cinn/frontend/syntax.h"
 #include "cinn/hlir/framework/node.h"
 #include "cinn/hlir/framework/scope.h"
@@ -122,6 +123,9 @@ class PaddleModelToProgram {
 
   void ReverseHWVar(const std::string& name);
 
+  // Wait for the data of the parameter \p name if the parameters are streaming in.
+  void WaitParam(const std::string& name);
+
  private:
   // op mapper
   absl::flat_hash_map<std::string, std::function<void(const paddle::cpp::OpDesc&)>> op_mappers_;
@@ -135,6 +139,8 @@ class PaddleModelToProgram {
   absl::flat_hash_map<std::string, std::string> var_model_to_program_map_;
   hlir::framework::Scope* scope_{};
   common::Target target_;
+  // the loader reading the combined parameters in the background while the program is built
+  std::unique_ptr<paddle::CombinedParamsLoader> params_loader_;
 };
 
 }  // namespace frontend
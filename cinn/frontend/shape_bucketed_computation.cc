@@ -0,0 +1,362 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/frontend/shape_bucketed_computation.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "cinn/common/bfloat16.h"
+#include "cinn/common/float16.h"
+#include "cinn/utils/profiler.h"
+#include "cinn/utils/string.h"
+
+namespace cinn {
+namespace frontend {
+
+using hlir::framework::shape_t;
+
+namespace {
+
+std::string GetKey(const std::vector<shape_t>& shapes) {
+  std::vector<std::string> strs;
+  for (auto& shape : shapes) {
+    strs.push_back(utils::Join(shape, "x"));
+  }
+  return utils::Join(strs, ",");
+}
+
+int64_t GetNumel(const shape_t& shape) {
+  int64_t numel = 1;
+  for (int dim : shape) numel *= dim;
+  return numel;
+}
+
+size_t GetComputationBytes(CinnComputation* computation) {
+  size_t bytes = 0;
+  for (auto& name : computation->GetAllTensorNames()) {
+    auto t = computation->GetTensor(name);
+    bytes += t->shape().numel() * t->type().bytes();
+  }
+  return bytes;
+}
+
+template <typename T>
+void FillValue(uint8_t* dst, int64_t numel, double value) {
+  if (std::is_integral<T>::value) {
+    // the infinities of floating-point identities are clamped to the range of the type
+    value = std::min(std::max(value, static_cast<double>(std::numeric_limits<T>::lowest())),
+                     static_cast<double>(std::numeric_limits<T>::max()));
+  }
+  std::fill_n(reinterpret_cast<T*>(dst), numel, static_cast<T>(value));
+}
+
+// fill numel elements of type at dst by value
+void FillPadValue(uint8_t* dst, int64_t numel, const common::Type& type, double value) {
+  if (value == 0) {
+    std::memset(dst, 0, numel * type.bytes());
+    return;
+  }
+  if (type.is_float(32)) {
+    FillValue<float>(dst, numel, value);
+  } else if (type.is_float(64)) {
+    FillValue<double>(dst, numel, value);
+  } else if (type.is_float(16, common::Type::specific_type_t::FP16)) {
+    std::fill_n(reinterpret_cast<common::float16*>(dst), numel, common::float16(static_cast<float>(value)));
+  } else if (type.is_float(16, common::Type::specific_type_t::BF16)) {
+    std::fill_n(reinterpret_cast<common::bfloat16*>(dst), numel, common::bfloat16(static_cast<float>(value)));
+  } else if (type.is_bool()) {
+    FillValue<bool>(dst, numel, value);
+  } else if (type.is_int(8)) {
+    FillValue<int8_t>(dst, numel, value);
+  } else if (type.is_int(16)) {
+    FillValue<int16_t>(dst, numel, value);
+  } else if (type.is_int(32)) {
+    FillValue<int32_t>(dst, numel, value);
+  } else if (type.is_int(64)) {
+    FillValue<int64_t>(dst, numel, value);
+  } else if (type.is_uint(8)) {
+    FillValue<uint8_t>(dst, numel, value);
+  } else if (type.is_uint(16)) {
+    FillValue<uint16_t>(dst, numel, value);
+  } else if (type.is_uint(32)) {
+    FillValue<uint32_t>(dst, numel, value);
+  } else if (type.is_uint(64)) {
+    FillValue<uint64_t>(dst, numel, value);
+  } else {
+    LOG(FATAL) << "Padding the inputs of type " << type << " by " << value << " is not supported";
+  }
+}
+
+// copy a tensor of src_shape to the leading corner of a tensor of dst_shape, the rest of dst is left unchanged
+void PadCopy(const uint8_t* src,
+             const shape_t& src_shape,
+             uint8_t* dst,
+             const shape_t& dst_shape,
+             size_t elem_bytes,
+             int dim = 0) {
+  int64_t src_stride = elem_bytes, dst_stride = elem_bytes;
+  for (int i = dim + 1; i < src_shape.size(); ++i) {
+    src_stride *= src_shape[i];
+    dst_stride *= dst_shape[i];
+  }
+  if (dim + 1 >= static_cast<int>(src_shape.size())) {
+    std::memcpy(dst, src, src_shape.empty() ? elem_bytes : src_shape[dim] * elem_bytes);
+    return;
+  }
+  for (int i = 0; i < src_shape[dim]; ++i) {
+    PadCopy(src + i * src_stride, src_shape, dst + i * dst_stride, dst_shape, elem_bytes, dim + 1);
+  }
+}
+
+}  // namespace
+
+ShapeBucketedComputation::ShapeBucketedComputation(ComputationBuilder builder, const Options& options)
+    : builder_(std::move(builder)), options_(options) {
+  for (auto& dim_buckets : options_.dim_buckets) {
+    CHECK(!dim_buckets.sizes.empty()) << "The bucket sizes of input " << dim_buckets.input_idx << " dim "
+                                      << dim_buckets.dim << " should not be empty";
+    std::sort(dim_buckets.sizes.begin(), dim_buckets.sizes.end());
+    CHECK_EQ(GetPadValue(dim_buckets.input_idx), dim_buckets.pad_value)
+        << "The bucketed dims of input " << dim_buckets.input_idx << " should have the same pad value";
+  }
+  if (options_.background_compile) {
+    compiler_ = std::thread(&ShapeBucketedComputation::CompileLoop, this);
+  }
+}
+
+ShapeBucketedComputation::~ShapeBucketedComputation() {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stop_ = true;
+    compile_queue_.clear();
+  }
+  cv_.notify_all();
+  if (compiler_.joinable()) {
+    compiler_.join();
+  }
+}
+
+ShapeBucketedComputation::ComputationBuilder ShapeBucketedComputation::PaddleModelBuilder(
+    const Target& target,
+    const std::string& model_path,
+    const std::vector<std::string>& input_names,
+    bool params_combined,
+    const CinnComputation::CompileOptions& options) {
+  return [=](const std::vector<shape_t>& input_shapes) {
+    return CinnComputation::CompilePaddleModel(target, model_path, input_names, input_shapes, params_combined, options);
+  };
+}
+
+std::vector<shape_t> ShapeBucketedComputation::GetBucket(const std::vector<shape_t>& input_shapes) const {
+  std::vector<shape_t> bucket = input_shapes;
+  for (auto& dim_buckets : options_.dim_buckets) {
+    CHECK_LT(dim_buckets.input_idx, bucket.size()) << "The bucketed input " << dim_buckets.input_idx << " is missing";
+    auto& shape = bucket[dim_buckets.input_idx];
+    CHECK_LT(dim_buckets.dim, shape.size()) << "The bucketed dim " << dim_buckets.dim << " of input "
+                                            << dim_buckets.input_idx << " is out of range";
+    int& size = shape[dim_buckets.dim];
+    auto it   = std::lower_bound(dim_buckets.sizes.begin(), dim_buckets.sizes.end(), size);
+    if (it == dim_buckets.sizes.end()) {
+      // larger than all buckets, the exact size is compiled
+      VLOG(3) << "The size " << size << " of input " << dim_buckets.input_idx << " dim " << dim_buckets.dim
+              << " exceeds the largest bucket " << dim_buckets.sizes.back();
+      continue;
+    }
+    size = *it;
+  }
+  return bucket;
+}
+
+std::shared_ptr<CinnComputation> ShapeBucketedComputation::Run(const std::vector<shape_t>& input_shapes,
+                                                               const std::vector<const void*>& inputs) {
+  CHECK_EQ(input_shapes.size(), inputs.size()) << "The number of inputs and shapes are mismatched";
+  auto bucket      = GetBucket(input_shapes);
+  auto computation = Lookup(bucket, input_shapes);
+
+  utils::RecordEvent record_event("ShapeBucketedComputation::Run", utils::EventType::kOrdinary);
+  auto input_tensors = computation->GetInputTensors();
+  CHECK_EQ(input_tensors.size(), inputs.size()) << "The number of inputs of the computation is mismatched";
+  for (int i = 0; i < inputs.size(); ++i) {
+    auto& t           = input_tensors[i];
+    size_t elem_bytes = t->type().bytes();
+    auto dst_shape    = t->shape().data();
+    if (dst_shape == input_shapes[i]) {
+      computation->SetTensorData(t, const_cast<void*>(inputs[i]), GetNumel(dst_shape) * elem_bytes);
+      continue;
+    }
+    std::vector<uint8_t> padded(GetNumel(dst_shape) * elem_bytes);
+    FillPadValue(padded.data(), GetNumel(dst_shape), t->type(), GetPadValue(i));
+    PadCopy(static_cast<const uint8_t*>(inputs[i]), input_shapes[i], padded.data(), dst_shape, elem_bytes);
+    computation->SetTensorData(t, padded.data(), padded.size());
+  }
+  computation->Execute();
+  return computation;
+}
+
+std::shared_ptr<CinnComputation> ShapeBucketedComputation::Lookup(const std::vector<shape_t>& bucket,
+                                                                  const std::vector<shape_t>& input_shapes) {
+  auto key = GetKey(bucket);
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second.lru_iter);
+      ++stats_.num_hits;
+      return it->second.computation;
+    }
+
+    if (options_.background_compile) {
+      // the smallest cached bucket holding the input, whose static dims are the same as the bucket
+      Entry* best       = nullptr;
+      int64_t best_size = 0;
+      for (auto& item : cache_) {
+        auto& shapes = item.second.shapes;
+        bool holds   = shapes.size() == bucket.size();
+        for (int i = 0; holds && i < shapes.size(); ++i) {
+          holds = shapes[i].size() == bucket[i].size();
+          for (int j = 0; holds && j < shapes[i].size(); ++j) {
+            holds = IsDynamic(i, j) ? shapes[i][j] >= input_shapes[i][j] : shapes[i][j] == bucket[i][j];
+          }
+        }
+        if (!holds) continue;
+        int64_t size = 0;
+        for (auto& shape : shapes) size += GetNumel(shape);
+        if (!best || size < best_size) {
+          best      = &item.second;
+          best_size = size;
+        }
+      }
+      if (best) {
+        lru_.splice(lru_.begin(), lru_, best->lru_iter);
+        ++stats_.num_fallbacks;
+        auto computation = best->computation;
+        ScheduleCompile(bucket);
+        return computation;
+      }
+    }
+    ++stats_.num_stalls;
+  }
+
+  VLOG(3) << "Compile the bucket [" << key << "] in place";
+  auto computation = Compile(bucket);
+  Insert(bucket, computation);
+  return computation;
+}
+
+bool ShapeBucketedComputation::IsDynamic(int input_idx, int dim) const {
+  for (auto& dim_buckets : options_.dim_buckets) {
+    if (dim_buckets.input_idx == input_idx && dim_buckets.dim == dim) return true;
+  }
+  return false;
+}
+
+double ShapeBucketedComputation::GetPadValue(int input_idx) const {
+  for (auto& dim_buckets : options_.dim_buckets) {
+    if (dim_buckets.input_idx == input_idx) return dim_buckets.pad_value;
+  }
+  return 0;
+}
+
+std::shared_ptr<CinnComputation> ShapeBucketedComputation::Compile(const std::vector<shape_t>& bucket) {
+  std::lock_guard<std::mutex> lock(compile_mtx_);
+  auto computation = builder_(bucket);
+  CHECK(computation) << "Failed to build the computation of bucket [" << GetKey(bucket) << "]";
+  return computation;
+}
+
+void ShapeBucketedComputation::Insert(const std::vector<shape_t>& bucket,
+                                      std::shared_ptr<CinnComputation> computation) {
+  auto key     = GetKey(bucket);
+  size_t bytes = GetComputationBytes(computation.get());
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (cache_.count(key)) {
+    return;
+  }
+  lru_.push_front(key);
+  cache_[key] = Entry{std::move(computation), bucket, bytes, lru_.begin()};
+  stats_.cached_bytes += bytes;
+
+  // the bucket just inserted is never evicted even if it exceeds the budget alone
+  while (options_.memory_budget > 0 && stats_.cached_bytes > options_.memory_budget && lru_.size() > 1) {
+    auto& victim = lru_.back();
+    VLOG(3) << "Evict the bucket [" << victim << "] from the cache";
+    stats_.cached_bytes -= cache_.at(victim).bytes;
+    ++stats_.num_evictions;
+    cache_.erase(victim);
+    lru_.pop_back();
+  }
+}
+
+void ShapeBucketedComputation::Warmup(const std::vector<std::vector<shape_t>>& bucket_shapes) {
+  for (auto& shapes : bucket_shapes) {
+    auto bucket = GetBucket(shapes);
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (cache_.count(GetKey(bucket))) continue;
+    }
+    Insert(bucket, Compile(bucket));
+  }
+}
+
+void ShapeBucketedComputation::ScheduleCompile(const std::vector<shape_t>& bucket) {
+  // called with mtx_ held
+  if (!pending_.insert(GetKey(bucket)).second) {
+    return;
+  }
+  compile_queue_.push_back(bucket);
+  cv_.notify_one();
+}
+
+void ShapeBucketedComputation::CompileLoop() {
+  while (true) {
+    std::vector<shape_t> bucket;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      cv_.wait(lock, [this] { return stop_ || !compile_queue_.empty(); });
+      if (stop_) {
+        return;
+      }
+      bucket = std::move(compile_queue_.front());
+      compile_queue_.pop_front();
+    }
+
+    VLOG(3) << "Compile the bucket [" << GetKey(bucket) << "] in the background";
+    Insert(bucket, Compile(bucket));
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      ++stats_.num_background_compiles;
+      pending_.erase(GetKey(bucket));
+    }
+    idle_cv_.notify_all();
+  }
+}
+
+void ShapeBucketedComputation::WaitBackgroundCompiles() {
+  std::unique_lock<std::mutex> lock(mtx_);
+  idle_cv_.wait(lock, [this] { return pending_.empty(); });
+}
+
+ShapeBucketedComputation::Stats ShapeBucketedComputation::GetStats() const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return stats_;
+}
+
+}  // namespace frontend
+}  // namespace cinn
@@ -0,0 +1,166 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "cinn/frontend/computation.h"
+
+namespace cinn {
+namespace frontend {
+
+/**
+ * ShapeBucketedComputation runs inputs of variable shapes by the computations compiled for a few bucket shapes.
+ *
+ * The size of a dynamic dimension is rounded up to the smallest bucket size holding it, and the inputs are padded
+ * to the bucket shape by the pad value of the dimension. The outputs are left in the bucket shape, the caller should
+ * crop the valid part. Padding is only correct when the padded elements don't flow into the valid part, so a
+ * dimension reduced by the computation must be padded by the identity of the reduction, e.g. 0 for sum, -inf for max
+ * and softmax, and a dimension mixed by ops without such an identity, e.g. a mean or sort over it, should not be
+ * bucketed.
+ * The compiled computations are cached in a LRU, and the least recently used ones are evicted once the memory of
+ * their tensors exceeds the budget.
+ *
+ * When the bucket of an input is missing but a cached bucket is large enough to hold it, the input is run by the
+ * smallest such bucket and the missing one is compiled in the background, so a new shape does not stall the
+ * request by compiling. Otherwise the bucket is compiled in place.
+ */
+class ShapeBucketedComputation {
+ public:
+  // the candidate sizes of a dynamic dimension of an input
+  struct DimBuckets {
+    int input_idx;
+    int dim;
+    std::vector<int> sizes;
+    // the value filling the padded part, which should be the identity of the reduction over the dimension if any,
+    // e.g. 0 for sum, -inf for max and softmax, +inf for min. It is clamped to the range of integer inputs.
+    double pad_value{0};
+  };
+
+  struct Options {
+    std::vector<DimBuckets> dim_buckets;
+    // the total bytes of the tensors of the cached computations, 0 means unlimited
+    size_t memory_budget{0};
+    // compile the missing buckets in the background if a cached bucket can run the input meanwhile
+    bool background_compile{true};
+  };
+
+  struct Stats {
+    int64_t num_hits{0};
+    // the runs by a larger cached bucket while the exact one is compiled in the background
+    int64_t num_fallbacks{0};
+    // the runs stalled by compiling the bucket in place
+    int64_t num_stalls{0};
+    int64_t num_background_compiles{0};
+    int64_t num_evictions{0};
+    size_t cached_bytes{0};
+  };
+
+  // build the computation whose inputs are of the given shapes
+  using ComputationBuilder =
+      std::function<std::shared_ptr<CinnComputation>(const std::vector<hlir::framework::shape_t>& input_shapes)>;
+
+  ShapeBucketedComputation(ComputationBuilder builder, const Options& options);
+
+  ~ShapeBucketedComputation();
+
+  /**
+   * the builder compiling a paddle model by CinnComputation::CompilePaddleModel, to replace the Interpreter
+   * constructed with fixed input shapes.
+   */
+  static ComputationBuilder PaddleModelBuilder(const Target& target,
+                                               const std::string& model_path,
+                                               const std::vector<std::string>& input_names,
+                                               bool params_combined,
+                                               const CinnComputation::CompileOptions& options =
+                                                   CinnComputation::DefaultCompileOptions());
+
+  // round up the dynamic dimensions of the input shapes to their buckets
+  std::vector<hlir::framework::shape_t> GetBucket(const std::vector<hlir::framework::shape_t>& input_shapes) const;
+
+  /**
+   * pad the inputs to the bucket shape and run the computation of the bucket. It should not be called concurrently.
+   * @param input_shapes the shapes of the inputs
+   * @param inputs the host data of the inputs in the order of GetInputTensors
+   * @return the computation which has been run, its outputs are in the shape of the bucket
+   */
+  std::shared_ptr<CinnComputation> Run(const std::vector<hlir::framework::shape_t>& input_shapes,
+                                       const std::vector<const void*>& inputs);
+
+  // compile the buckets ahead and put them in the cache
+  void Warmup(const std::vector<std::vector<hlir::framework::shape_t>>& bucket_shapes);
+
+  // wait until all the background compilations finished
+  void WaitBackgroundCompiles();
+
+  Stats GetStats() const;
+
+ private:
+  struct Entry {
+    std::shared_ptr<CinnComputation> computation;
+    std::vector<hlir::framework::shape_t> shapes;
+    size_t bytes;
+    std::list<std::string>::iterator lru_iter;
+  };
+
+  std::shared_ptr<CinnComputation> Lookup(const std::vector<hlir::framework::shape_t>& bucket,
+                                          const std::vector<hlir::framework::shape_t>& input_shapes);
+
+  bool IsDynamic(int input_idx, int dim) const;
+
+  // the value padding the input, which is shared by its bucketed dims
+  double GetPadValue(int input_idx) const;
+
+  std::shared_ptr<CinnComputation> Compile(const std::vector<hlir::framework::shape_t>& bucket);
+
+  void Insert(const std::vector<hlir::framework::shape_t>& bucket, std::shared_ptr<CinnComputation> computation);
+
+  void ScheduleCompile(const std::vector<hlir::framework::shape_t>& bucket);
+
+  void CompileLoop();
+
+  ComputationBuilder builder_;
+  Options options_;
+  // the builder is called by one thread at a time
+  std::mutex compile_mtx_;
+
+  mutable std::mutex mtx_;
+  // the most recently used bucket is at the front
+  std::list<std::string> lru_;
+  std::unordered_map<std::string, Entry> cache_;
+  Stats stats_;
+
+  std::condition_variable cv_;
+  std::condition_variable idle_cv_;
+  std::deque<std::vector<hlir::framework::shape_t>> compile_queue_;
+  // the buckets queued or being compiled in the background
+  std::unordered_set<std::string> pending_;
+  bool stop_{false};
+  std::thread compiler_;
+};
+
+}  // namespace frontend
+}  // namespace cinn
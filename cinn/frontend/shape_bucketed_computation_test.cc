@@ -0,0 +1,157 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/frontend/shape_bucketed_computation.h"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <vector>
+
+#include "cinn/common/target.h"
+#include "cinn/frontend/net_builder.h"
+
+namespace cinn {
+namespace frontend {
+
+using hlir::framework::shape_t;
+
+constexpr int B = 4;
+
+// out = relu(x), where x is of shape [B, S] and S is bucketed
+std::shared_ptr<CinnComputation> BuildRelu(const std::vector<shape_t>& input_shapes) {
+  NetBuilder builder("shape_bucketed");
+  auto x = builder.CreateInput(Float(32), input_shapes[0], "X");
+  auto o = builder.Relu(x);
+  return CinnComputation::BuildAndCompile(common::DefaultHostTarget(), builder);
+}
+
+// out = reduce_max(x, dim=1), where x is of shape [B, S] and S is bucketed
+std::shared_ptr<CinnComputation> BuildReduceMax(const std::vector<shape_t>& input_shapes) {
+  NetBuilder builder("shape_bucketed_reduce");
+  auto x = builder.CreateInput(Float(32), input_shapes[0], "X");
+  auto o = builder.ReduceMax(x, {1});
+  return CinnComputation::BuildAndCompile(common::DefaultHostTarget(), builder);
+}
+
+ShapeBucketedComputation::Options CreateOptions() {
+  ShapeBucketedComputation::Options options;
+  options.dim_buckets = {{0, 1, {64, 16, 32}}};
+  return options;
+}
+
+void RunAndCheck(ShapeBucketedComputation* bucketed, int seq_len, int expected_bucket) {
+  std::vector<float> x(B * seq_len);
+  for (int i = 0; i < x.size(); ++i) {
+    x[i] = (i % 3 ? 1.f : -1.f) * i;
+  }
+  auto computation = bucketed->Run({{B, seq_len}}, {x.data()});
+
+  auto out = computation->GetOutputTensors()[0];
+  ASSERT_EQ(out->shape().data(), shape_t({B, expected_bucket}));
+  std::vector<float> result(B * expected_bucket);
+  computation->GetTensorData(out, result.data(), result.size() * sizeof(float));
+  for (int i = 0; i < B; ++i) {
+    for (int j = 0; j < expected_bucket; ++j) {
+      float expected = j < seq_len ? std::max(x[i * seq_len + j], 0.f) : 0.f;
+      ASSERT_FLOAT_EQ(result[i * expected_bucket + j], expected);
+    }
+  }
+}
+
+TEST(ShapeBucketedComputation, GetBucket) {
+  ShapeBucketedComputation bucketed(BuildRelu, CreateOptions());
+  EXPECT_EQ(bucketed.GetBucket({{B, 1}}), std::vector<shape_t>({{B, 16}}));
+  EXPECT_EQ(bucketed.GetBucket({{B, 16}}), std::vector<shape_t>({{B, 16}}));
+  EXPECT_EQ(bucketed.GetBucket({{B, 17}}), std::vector<shape_t>({{B, 32}}));
+  // the static dims and the sizes beyond the largest bucket are kept
+  EXPECT_EQ(bucketed.GetBucket({{2, 100}}), std::vector<shape_t>({{2, 100}}));
+}
+
+TEST(ShapeBucketedComputation, BackgroundCompile) {
+  ShapeBucketedComputation bucketed(BuildRelu, CreateOptions());
+
+  RunAndCheck(&bucketed, 10, 16);
+  RunAndCheck(&bucketed, 12, 16);
+  EXPECT_EQ(bucketed.GetStats().num_stalls, 1);
+  EXPECT_EQ(bucketed.GetStats().num_hits, 1);
+
+  // the bucket 32 is missing, the input is run by bucket 64 while bucket 32 is compiled in the background
+  bucketed.Warmup({{{B, 64}}});
+  RunAndCheck(&bucketed, 20, 64);
+  EXPECT_EQ(bucketed.GetStats().num_fallbacks, 1);
+  bucketed.WaitBackgroundCompiles();
+  EXPECT_EQ(bucketed.GetStats().num_background_compiles, 1);
+  RunAndCheck(&bucketed, 20, 32);
+  EXPECT_EQ(bucketed.GetStats().num_hits, 2);
+  EXPECT_EQ(bucketed.GetStats().num_stalls, 1);
+}
+
+TEST(ShapeBucketedComputation, MemoryBudget) {
+  size_t bucket16_bytes = 0;
+  {
+    ShapeBucketedComputation bucketed(BuildRelu, CreateOptions());
+    bucketed.Warmup({{{B, 16}}});
+    bucket16_bytes = bucketed.GetStats().cached_bytes;
+  }
+  ASSERT_GT(bucket16_bytes, 0UL);
+
+  // the bytes of a bucket are in proportion to its size
+  auto options          = CreateOptions();
+  options.memory_budget = bucket16_bytes * 5;
+  ShapeBucketedComputation bucketed(BuildRelu, options);
+  bucketed.Warmup({{{B, 16}}, {{B, 32}}});
+  RunAndCheck(&bucketed, 16, 16);
+  // bucket 32 is the least recently used one, and it is evicted to hold bucket 64
+  bucketed.Warmup({{{B, 64}}});
+  auto stats = bucketed.GetStats();
+  EXPECT_EQ(stats.num_evictions, 1);
+  EXPECT_EQ(stats.cached_bytes, bucket16_bytes * 5);
+
+  RunAndCheck(&bucketed, 16, 16);
+  RunAndCheck(&bucketed, 64, 64);
+  EXPECT_EQ(bucketed.GetStats().num_hits, 3);
+  EXPECT_EQ(bucketed.GetStats().num_stalls, 0);
+}
+
+TEST(ShapeBucketedComputation, PadValueOfReduction) {
+  constexpr int kSeqLen = 10;
+  // all negative, so padding by zero would change the maximum
+  std::vector<float> x(B * kSeqLen);
+  for (int i = 0; i < x.size(); ++i) {
+    x[i] = -1.f - (i * 7 % 13);
+  }
+
+  auto unpadded = BuildReduceMax({{B, kSeqLen}});
+  auto x_tensor = unpadded->GetInputTensors()[0];
+  unpadded->SetTensorData(x_tensor, x.data(), x.size() * sizeof(float));
+  unpadded->Execute();
+  std::vector<float> expected(B);
+  unpadded->GetTensorData(unpadded->GetOutputTensors()[0], expected.data(), expected.size() * sizeof(float));
+
+  auto options                     = CreateOptions();
+  options.dim_buckets[0].pad_value = -std::numeric_limits<double>::infinity();
+  ShapeBucketedComputation bucketed(BuildReduceMax, options);
+  auto computation = bucketed.Run({{B, kSeqLen}}, {x.data()});
+  ASSERT_EQ(computation->GetInputTensors()[0]->shape().data(), shape_t({B, 16}));
+  std::vector<float> result(B);
+  computation->GetTensorData(computation->GetOutputTensors()[0], result.data(), result.size() * sizeof(float));
+  for (int i = 0; i < B; ++i) {
+    ASSERT_LT(expected[i], 0.f);
+    ASSERT_FLOAT_EQ(result[i], expected[i]);
+  }
+}
+
+}  // namespace frontend
+}  // namespace cinn
@@ -14,11 +14,20 @@
 
 #include "cinn/hlir/framework/buffer.h"
 
+#include <cstdint>
+#include <limits>
+
 namespace cinn {
 namespace hlir {
 namespace framework {
 
 void Buffer::Resize(uint32_t size) {
+  if (external_memory_) {
+    // the outputs written into the buffer should keep landing in the memory of the caller
+    CHECK_LE(size, size_) << "The buffer of " << size_ << " bytes external memory can't be resized to " << size
+                          << " bytes, share a larger memory instead";
+    return;
+  }
   if (size_ > 0) {
     Free();
     size_ = 0;
@@ -32,6 +41,11 @@ void Buffer::Resize(uint32_t size) {
 }
 
 void Buffer::Resize(uint32_t alignment, uint32_t size) {
+  if (external_memory_) {
+    CHECK_LE(size, size_) << "The buffer of " << size_ << " bytes external memory can't be resized to " << size
+                          << " bytes, share a larger memory instead";
+    return;
+  }
   if (size_ > 0) {
     Free();
     size_ = 0;
@@ -49,6 +63,33 @@ void Buffer::SetTarget(const common::Target& target) {
   memory_mng_cache_ = MemoryManager::Global().RetrieveSafely(target_.arch);
 }
 
+void Buffer::ShareMemory(const std::shared_ptr<Buffer>& buffer, uint32_t offset, uint32_t size) {
+  CHECK(buffer && buffer.get() != this) << "A buffer can't share the memory of itself";
+  CHECK_LE(offset + size, buffer->size_) << "The shared memory is out of the range of buffer";
+  Free();
+  SetTarget(buffer->target_);
+  data_.memory      = buffer->data_.memory + offset;
+  data_.memory_size = size;
+  size_             = size;
+  shared_buffer_    = buffer;
+}
+
+void Buffer::ShareExternalMemory(void* data,
+                                 size_t size,
+                                 const common::Target& target,
+                                 std::shared_ptr<void> holder) {
+  CHECK(data) << "The external memory to share should not be null";
+  CHECK_LE(size, std::numeric_limits<uint32_t>::max())
+      << "The external memory of " << size << " bytes exceeds the maximum size of a buffer";
+  Free();
+  SetTarget(target);
+  data_.memory      = reinterpret_cast<uint8_t*>(data);
+  data_.memory_size = size;
+  size_             = size;
+  external_memory_  = true;
+  external_holder_  = std::move(holder);
+}
+
 void Buffer::ResizeLazy(uint32_t size) {
   if (size <= size_) return;
   Resize(size);
@@ -61,6 +102,7 @@ void Buffer::ResizeLazy(uint32_t alignment, uint32_t size) {
 
 void Buffer::Resize(uint32_t size, const common::Target& target) {
   if (target.arch != target_.arch) {
+    CHECK(!external_memory_) << "The buffer of external memory can't be moved to another target";
     Free();
     SetTarget(target);
   }
@@ -69,6 +111,7 @@ void Buffer::Resize(uint32_t size, const common::Target& target) {
 
 void Buffer::Resize(uint32_t alignment, uint32_t size, const common::Target& target) {
   if (target.arch != target_.arch) {
+    CHECK(!external_memory_) << "The buffer of external memory can't be moved to another target";
     Free();
     SetTarget(target);
   }
@@ -77,6 +120,7 @@ void Buffer::Resize(uint32_t alignment, uint32_t size, const common::Target& tar
 
 void Buffer::ResizeLazy(uint32_t size, const common::Target& target) {
   if (target.arch != target_.arch) {
+    CHECK(!external_memory_) << "The buffer of external memory can't be moved to another target";
     Free();
     SetTarget(target);
   }
@@ -85,6 +129,7 @@ void Buffer::ResizeLazy(uint32_t size, const common::Target& target) {
 
 void Buffer::ResizeLazy(uint32_t alignment, uint32_t size, const common::Target& target) {
   if (target.arch != target_.arch) {
+    CHECK(!external_memory_) << "The buffer of external memory can't be moved to another target";
     Free();
     SetTarget(target);
   }
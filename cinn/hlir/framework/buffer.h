@@ -53,13 +53,41 @@ struct Buffer final {
 
   void SetTarget(const common::Target& target);
 
+  //! Refer to \p size bytes at \p offset of the memory held by \p buffer instead of allocating its own, the memory
+  //! is kept alive as long as this buffer refers to it.
+  void ShareMemory(const std::shared_ptr<Buffer>& buffer, uint32_t offset, uint32_t size);
+
+  //! Refer to \p size bytes of the external memory \p data in target \p target instead of allocating its own, the
+  //! memory is owned by the caller and should outlive the use of this buffer, unless it is owned by \p holder,
+  //! which is kept alive as long as this buffer refers to the memory. \p size should fit in 32 bits, as the size
+  //! of any buffer. Resizing the buffer beyond \p size or to another target is an error rather than silently
+  //! detaching from the external memory.
+  void ShareExternalMemory(void* data,
+                           size_t size,
+                           const common::Target& target,
+                           std::shared_ptr<void> holder = nullptr);
+
+  //! Whether the memory is owned by the caller rather than this buffer or a shared buffer.
+  bool IsExternalMemory() const { return external_memory_; }
+
   const cinn_buffer_t* data() const { return &data_; }
   cinn_buffer_t* data() { return &data_; }
 
-  //! Free all the memory owned by this buffer.
+  //! Free all the memory owned by this buffer, and detach from the memory shared from others.
   void Free() {
     if (!data_.memory) return;
-    memory_mng_cache_->free(data_.memory);
+    if (shared_buffer_ || external_memory_) {
+      // the memory is owned by the shared buffer or the caller
+      shared_buffer_.reset();
+      external_holder_.reset();
+      external_memory_ = false;
+    } else {
+      memory_mng_cache_->free(data_.memory);
+    }
+    // so that freeing again or resizing never hands the memory to the memory manager
+    data_.memory      = nullptr;
+    data_.memory_size = 0;
+    size_             = 0;
   }
 
  private:
@@ -84,6 +112,15 @@ struct Buffer final {
 
   //! Hold the corresponding memory manager for speed.
   MemoryInterface* memory_mng_cache_{};
+
+  //! The buffer owning the memory if the memory is shared from it.
+  std::shared_ptr<Buffer> shared_buffer_;
+
+  //! Whether the memory is owned by the caller.
+  bool external_memory_{false};
+
+  //! The object owning the external memory if it is given.
+  std::shared_ptr<void> external_holder_;
 };
 
 }  // namespace framework
@@ -18,6 +18,7 @@
 #endif
 #include <gtest/gtest.h>
 
+#include <memory>
 #include <vector>
 
 namespace cinn {
@@ -31,6 +32,23 @@ TEST(Buffer, basic) {
   for (int i = 0; i < 10; i++) data[i] = i;
 }
 
+TEST(Buffer, FreeSharedMemory) {
+  auto arena = std::make_shared<Buffer>(common::DefaultHostTarget());
+  arena->Resize(64);
+  Buffer view;
+  view.ShareMemory(arena, 16, 32);
+  ASSERT_EQ(view.data()->memory, arena->data()->memory + 16);
+
+  // the view detaches from the memory of the arena, which is never freed by it, even if freed again
+  view.Free();
+  ASSERT_EQ(view.data()->memory, nullptr);
+  ASSERT_EQ(view.data()->memory_size, 0UL);
+  view.Free();
+  view.ResizeLazy(8, common::DefaultHostTarget());
+  ASSERT_NE(view.data()->memory, nullptr);
+  ASSERT_NE(view.data()->memory, arena->data()->memory + 16);
+}
+
 #ifdef CINN_WITH_CUDA
 TEST(Buffer, nvgpu) {
   const int num_elements = 10;
@@ -0,0 +1,259 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/hlir/framework/compilation_cache.h"
+
+#include <gflags/gflags.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/Host.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include "cinn/hlir/framework/visualize_helper.h"
+#include "cinn/utils/string.h"
+
+DECLARE_bool(cinn_ir_schedule);
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+namespace {
+// bump it when the layout of an entry, the signature or the code generated for a signature changes
+constexpr char kCacheVersion[]  = "cinn_compilation_cache_v2";
+constexpr char kSignatureFile[] = "signature";
+constexpr char kManifestFile[]  = "manifest";
+
+bool FileExists(const std::string& path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0;
+}
+
+bool ReadFile(const std::string& path, std::string* content) {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs.is_open()) return false;
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  *content = ss.str();
+  return true;
+}
+
+bool WriteFile(const std::string& path, const std::string& content) {
+  std::ofstream ofs(path, std::ios::binary);
+  if (!ofs.is_open()) return false;
+  ofs << content;
+  return ofs.good();
+}
+
+std::string ObjectFileName(const std::string& dirname, int idx) {
+  return dirname + "/object_" + std::to_string(idx) + ".o";
+}
+
+void RemoveDirectory(const std::string& dirname, int num_objects) {
+  for (int i = 0; i < num_objects; ++i) {
+    unlink(ObjectFileName(dirname, i).c_str());
+  }
+  unlink((dirname + "/" + kSignatureFile).c_str());
+  unlink((dirname + "/" + kManifestFile).c_str());
+  rmdir(dirname.c_str());
+}
+
+void WriteNames(const std::vector<std::string>& names, std::ostream& os) {
+  os << " " << names.size();
+  for (auto& name : names) {
+    os << " " << name;
+  }
+}
+
+bool ReadNames(std::istream& is, std::vector<std::string>* names) {
+  size_t num = 0;
+  if (!(is >> num)) return false;
+  names->resize(num);
+  for (auto& name : *names) {
+    if (!(is >> name)) return false;
+  }
+  return true;
+}
+}  // namespace
+
+CompilationCache::CompilationCache(const std::string& cache_dir) : cache_dir_(cache_dir) {
+  CHECK(!cache_dir_.empty()) << "The directory of compilation cache should not be empty";
+  if (!MakeDirectory(cache_dir_ + "/", S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH)) {
+    LOG(WARNING) << "Failed to create the compilation cache directory: " << cache_dir_;
+  }
+}
+
+std::string CompilationCache::GraphSignature(const Graph& graph, const Target& target) {
+  auto& shape_dict = graph.GetAttrs<absl::flat_hash_map<std::string, shape_t>>("infershape");
+  auto& dtype_dict = graph.GetAttrs<absl::flat_hash_map<std::string, Type>>("inferdtype");
+
+  std::stringstream ss;
+  ss << kCacheVersion << "\n";
+  ss << target << ", llvm-" << LLVM_VERSION_STRING << ", cpu-" << llvm::sys::getHostCPUName().str() << ", vector-bits-"
+     << target.vector_bits() << "\n";
+  ss << "cinn_ir_schedule=" << FLAGS_cinn_ir_schedule << "\n";
+
+  auto print_var = [&](const std::string& id) {
+    ss << id << "[";
+    if (shape_dict.count(id)) ss << utils::Join(shape_dict.at(id), ",");
+    ss << "]";
+    if (dtype_dict.count(id)) ss << common::Type2Str(dtype_dict.at(id));
+  };
+
+  for (auto& group : graph.fusion_groups) {
+    ss << "group<" << static_cast<int>(group->op_pattern_kind) << "> {\n";
+    for (auto* node : group->CollectNodes()) {
+      ss << "  " << node->op()->name << "(";
+      for (auto& link : node->inlinks_in_order()) {
+        print_var(link->source()->as<NodeData>()->id());
+        ss << ", ";
+      }
+      ss << ") -> (";
+      for (auto& link : node->outlinks_in_order()) {
+        print_var(link->sink()->as<NodeData>()->id());
+        ss << ", ";
+      }
+      ss << ")";
+      // sort the attributes to make the signature stable
+      std::vector<std::string> attr_names;
+      for (auto& attr : node->attrs.attr_store) {
+        attr_names.push_back(attr.first);
+      }
+      std::sort(attr_names.begin(), attr_names.end());
+      for (auto& name : attr_names) {
+        ss << " " << name << "=" << utils::Attribute2String(node->attrs.attr_store.at(name));
+      }
+      ss << "\n";
+    }
+    ss << "}\n";
+  }
+  return ss.str();
+}
+
+std::string CompilationCache::EntryDir(const std::string& signature) const {
+  std::stringstream ss;
+  ss << cache_dir_ << "/" << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>()(signature);
+  return ss.str();
+}
+
+bool CompilationCache::Lookup(const std::string& signature, Entry* entry) const {
+  auto dirname = EntryDir(signature);
+  std::string cached_signature;
+  if (!ReadFile(dirname + "/" + kSignatureFile, &cached_signature)) {
+    VLOG(3) << "No compilation cache entry at " << dirname;
+    return false;
+  }
+  if (cached_signature != signature) {
+    LOG(WARNING) << "The compilation cache entry at " << dirname << " has a different signature, skip it.";
+    return false;
+  }
+
+  std::ifstream manifest(dirname + "/" + kManifestFile);
+  std::string version;
+  int num_objects = 0, num_functions = 0;
+  if (!(manifest >> version >> num_objects >> num_functions) || version != kCacheVersion) {
+    LOG(WARNING) << "The manifest of compilation cache entry at " << dirname << " is invalid, skip it.";
+    return false;
+  }
+
+  entry->object_files.clear();
+  for (int i = 0; i < num_objects; ++i) {
+    auto path = ObjectFileName(dirname, i);
+    if (!FileExists(path)) {
+      LOG(WARNING) << "The object file " << path << " of compilation cache is missing, skip it.";
+      return false;
+    }
+    entry->object_files.push_back(path);
+  }
+
+  entry->functions.resize(num_functions);
+  for (auto& record : entry->functions) {
+    if (!(manifest >> record.object_idx >> record.func_name) || !ReadNames(manifest, &record.input_names) ||
+        !ReadNames(manifest, &record.output_names) || record.object_idx < 0 || record.object_idx >= num_objects) {
+      LOG(WARNING) << "The manifest of compilation cache entry at " << dirname << " is broken, skip it.";
+      return false;
+    }
+  }
+  VLOG(2) << "Hit compilation cache entry at " << dirname << " with " << num_functions << " functions";
+  return true;
+}
+
+void CompilationCache::Insert(const std::string& signature,
+                              int num_objects,
+                              const ObjectWriter& write_object,
+                              const std::vector<FunctionRecord>& functions) const {
+  auto dirname = EntryDir(signature);
+  if (FileExists(dirname)) {
+    VLOG(3) << "The compilation cache entry at " << dirname << " already exists";
+    return;
+  }
+
+  // write into a private directory, then publish it by an atomic rename
+  std::stringstream tmp_ss;
+  tmp_ss << dirname << ".tmp." << getpid() << "." << std::hash<std::thread::id>()(std::this_thread::get_id());
+  auto tmp_dirname = tmp_ss.str();
+  if (!MakeDirectory(tmp_dirname + "/", S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH)) {
+    LOG(WARNING) << "Failed to create directory " << tmp_dirname << ", skip writing compilation cache.";
+    return;
+  }
+
+  for (int i = 0; i < num_objects; ++i) {
+    if (!write_object(i, ObjectFileName(tmp_dirname, i))) {
+      LOG(WARNING) << "Failed to write the object file " << i << " into " << tmp_dirname
+                   << ", skip writing compilation cache.";
+      RemoveDirectory(tmp_dirname, num_objects);
+      return;
+    }
+  }
+
+  std::stringstream manifest;
+  manifest << kCacheVersion << " " << num_objects << " " << functions.size() << "\n";
+  for (auto& record : functions) {
+    CHECK(record.object_idx >= 0 && record.object_idx < num_objects)
+        << "The object index of function " << record.func_name << " is out of range";
+    manifest << record.object_idx << " " << record.func_name;
+    WriteNames(record.input_names, manifest);
+    WriteNames(record.output_names, manifest);
+    manifest << "\n";
+  }
+
+  if (!WriteFile(tmp_dirname + "/" + kManifestFile, manifest.str()) ||
+      !WriteFile(tmp_dirname + "/" + kSignatureFile, signature)) {
+    LOG(WARNING) << "Failed to write compilation cache entry into " << tmp_dirname;
+    RemoveDirectory(tmp_dirname, num_objects);
+    return;
+  }
+
+  if (rename(tmp_dirname.c_str(), dirname.c_str()) != 0) {
+    // another process may have published the same entry first
+    VLOG(3) << "Failed to publish compilation cache entry " << dirname << ", errno = " << errno;
+    RemoveDirectory(tmp_dirname, num_objects);
+    return;
+  }
+  VLOG(2) << "Insert compilation cache entry at " << dirname << " with " << functions.size() << " functions";
+}
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
@@ -0,0 +1,88 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "cinn/common/target.h"
+#include "cinn/hlir/framework/graph.h"
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+/**
+ * CompilationCache persists the object code generated for the fusion groups of a graph in a directory, so that
+ * a later process compiling a structurally identical graph can load the objects instead of lowering them again.
+ *
+ * Every entry lives in its own sub-directory named by the hash of the graph signature, and holds the signature,
+ * a manifest describing the functions and the object files. An entry is written into a temporary directory first
+ * and renamed to its final place, so concurrent processes sharing a cache directory never observe partial entries.
+ */
+class CompilationCache {
+ public:
+  // A compiled function of a fusion group, and the object file it is located in.
+  struct FunctionRecord {
+    int object_idx{-1};
+    std::string func_name;
+    std::vector<std::string> input_names;
+    std::vector<std::string> output_names;
+  };
+
+  struct Entry {
+    // the paths of object files, indexed by FunctionRecord::object_idx
+    std::vector<std::string> object_files;
+    // one record per fusion group, in the order of Graph::fusion_groups
+    std::vector<FunctionRecord> functions;
+  };
+
+  // writes the idx-th object file to the given path, returns false on failure
+  using ObjectWriter = std::function<bool(int idx, const std::string& path)>;
+
+  explicit CompilationCache(const std::string& cache_dir);
+
+  /**
+   * Generate the signature of a grouped graph, which covers the operators, attributes, shapes, dtypes and variable
+   * names of every fusion group, the target, and the flags and compiler version affecting the generated code.
+   */
+  static std::string GraphSignature(const Graph& graph, const Target& target);
+
+  /**
+   * Find the entry whose signature is \p signature.
+   * @return true if the entry is found and complete.
+   */
+  bool Lookup(const std::string& signature, Entry* entry) const;
+
+  /**
+   * Insert an entry consisting of \p num_objects object files and the records of functions.
+   * It is safe to be called from multiple processes with the same signature, the first one wins. Nothing is
+   * published if any file of the entry fails to be written.
+   */
+  void Insert(const std::string& signature,
+              int num_objects,
+              const ObjectWriter& write_object,
+              const std::vector<FunctionRecord>& functions) const;
+
+ private:
+  std::string EntryDir(const std::string& signature) const;
+
+  std::string cache_dir_;
+};
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
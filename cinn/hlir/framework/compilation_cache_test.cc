@@ -0,0 +1,106 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/hlir/framework/compilation_cache.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+TEST(CompilationCache, InsertAndLookup) {
+  std::string cache_dir = "./compilation_cache_test_" + std::to_string(getpid());
+  CompilationCache cache(cache_dir);
+
+  std::string signature = "group<0> {\n  elementwise_add(x[32]float32, y[32]float32, ) -> (z[32]float32, )\n}\n";
+  CompilationCache::Entry entry;
+  ASSERT_FALSE(cache.Lookup(signature, &entry));
+
+  std::vector<CompilationCache::FunctionRecord> functions(2);
+  functions[0].object_idx   = 0;
+  functions[0].func_name    = "fn_elementwise_add_0";
+  functions[0].input_names  = {"x", "y"};
+  functions[0].output_names = {"z"};
+  functions[1].object_idx   = 1;
+  functions[1].func_name    = "fn_relu_1";
+  functions[1].input_names  = {"z"};
+  functions[1].output_names = {"out"};
+
+  std::vector<std::string> written;
+  cache.Insert(
+      signature,
+      2,
+      [&written](int idx, const std::string& path) {
+        std::ofstream ofs(path);
+        ofs << "object-" << idx;
+        written.push_back(path);
+        return ofs.good();
+      },
+      functions);
+  ASSERT_EQ(written.size(), 2UL);
+
+  ASSERT_TRUE(cache.Lookup(signature, &entry));
+  ASSERT_EQ(entry.object_files.size(), 2UL);
+  ASSERT_EQ(entry.functions.size(), 2UL);
+  for (int i = 0; i < functions.size(); ++i) {
+    EXPECT_EQ(entry.functions[i].object_idx, functions[i].object_idx);
+    EXPECT_EQ(entry.functions[i].func_name, functions[i].func_name);
+    EXPECT_EQ(entry.functions[i].input_names, functions[i].input_names);
+    EXPECT_EQ(entry.functions[i].output_names, functions[i].output_names);
+  }
+
+  std::ifstream ifs(entry.object_files[1]);
+  std::string content;
+  ifs >> content;
+  EXPECT_EQ(content, "object-1");
+
+  // a different signature never hits the entry
+  CompilationCache::Entry other;
+  EXPECT_FALSE(cache.Lookup(signature + " ", &other));
+}
+
+TEST(CompilationCache, FailedWriteIsNotPublished) {
+  std::string cache_dir = "./compilation_cache_failed_test_" + std::to_string(getpid());
+  CompilationCache cache(cache_dir);
+
+  std::string signature = "group<0> {\n  relu(x[16]float32, ) -> (y[16]float32, )\n}\n";
+  std::vector<CompilationCache::FunctionRecord> functions(1);
+  functions[0].object_idx   = 1;
+  functions[0].func_name    = "fn_relu_0";
+  functions[0].input_names  = {"x"};
+  functions[0].output_names = {"y"};
+
+  // the second object fails to be written, e.g. the disk is full
+  cache.Insert(
+      signature,
+      2,
+      [](int idx, const std::string& path) {
+        std::ofstream ofs(path);
+        ofs << "object-" << idx;
+        return idx == 0;
+      },
+      functions);
+  CompilationCache::Entry entry;
+  EXPECT_FALSE(cache.Lookup(signature, &entry));
+}
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
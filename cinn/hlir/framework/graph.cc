@@ -14,6 +14,7 @@
 
 #include "cinn/hlir/framework/graph.h"
 
+#include <algorithm>
 #include <atomic>
 #include <sstream>
 
@@ -494,6 +495,71 @@ std::unordered_set<NodeData*> Graph::Group::GetOutputNodeDatas() {
   return group_outputs;
 }
 
+std::string Graph::GroupStructuralKey(const std::shared_ptr<Group>& group, std::vector<std::string>* var_ids) const {
+  auto& shape_dict = GetAttrs<ShapeDict>("infershape");
+  auto& dtype_dict = GetAttrs<DTypeDict>("inferdtype");
+
+  std::unordered_map<std::string, int> var_numbers;
+  std::stringstream ss;
+  auto print_var = [&](NodeData* var) {
+    auto id = var->id();
+    auto it = var_numbers.find(id);
+    if (it != var_numbers.end()) {
+      ss << "v" << it->second;
+      return;
+    }
+    int number      = var_numbers.size();
+    var_numbers[id] = number;
+    if (var_ids) var_ids->push_back(id);
+    // the variables without producer are the inputs of the graph
+    ss << "v" << number << (var->source_node.get() ? "" : "*") << "[";
+    if (shape_dict.count(id)) ss << utils::Join(shape_dict.at(id), ",");
+    ss << "]";
+    if (dtype_dict.count(id)) ss << common::Type2Str(dtype_dict.at(id));
+  };
+  auto print_group = [&](const Group& sub_group) {
+    ss << "group<" << static_cast<int>(sub_group.op_pattern_kind) << "> {\n";
+    for (auto* node : sub_group.nodes) {
+      // the roles of the node decide how the group is scheduled
+      ss << "  " << (sub_group.master_nodes.count(node) ? "m" : "") << (sub_group.internal_nodes.count(node) ? "i" : "")
+         << (sub_group.output_nodes.count(node) ? "o" : "") << (group->output_nodes.count(node) ? "O" : "") << " "
+         << node->op()->name << "(";
+      for (auto& link : node->inlinks_in_order()) {
+        print_var(link->source()->as<NodeData>());
+        ss << ", ";
+      }
+      ss << ") -> (";
+      for (auto& link : node->outlinks_in_order()) {
+        print_var(link->sink()->as<NodeData>());
+        ss << ", ";
+      }
+      ss << ")";
+      // sort the attributes to make the key stable
+      std::vector<std::string> attr_names;
+      for (auto& attr : node->attrs.attr_store) {
+        attr_names.push_back(attr.first);
+      }
+      std::sort(attr_names.begin(), attr_names.end());
+      for (auto& name : attr_names) {
+        ss << " " << name << "=" << utils::Attribute2String(node->attrs.attr_store.at(name));
+      }
+      ss << "\n";
+    }
+    ss << "}\n";
+  };
+
+  if (group->fused_sub_groups.empty()) {
+    print_group(*group);
+  } else {
+    ss << "fused<" << static_cast<int>(group->op_pattern_kind) << "> {\n";
+    for (auto& sub_group : group->fused_sub_groups) {
+      print_group(*sub_group);
+    }
+    ss << "}\n";
+  }
+  return ss.str();
+}
+
 void Graph::SaveSourceCode(const std::string& code) {
   if (cinn::runtime::CheckStringFlagFalse(FLAGS_cinn_fusion_groups_graphviz_dir) || viz_path_.empty()) {
     return;
@@ -206,6 +206,15 @@ class Graph : public cinn::common::Graph {
   void VisualizeGroupedGraph(const std::vector<std::vector<Node*>>& groups,
                              const std::unordered_set<std::string>& fetch_var_ids = {});
 
+  /**
+   * \brief Get the structural key of a group, made of its ops, attributes, shapes, dtypes and the edges between them,
+   * where the variables are numbered in the order they appear instead of by their names. The groups of the same key
+   * are lowered to the same function except for the names of the function and its arguments.
+   * @param var_ids The ids of the variables in the order of their numbers, if not null.
+   */
+  std::string GroupStructuralKey(const std::shared_ptr<Group>& group,
+                                 std::vector<std::string>* var_ids = nullptr) const;
+
   void SaveSourceCode(const std::string& code);
   void SavePTXCode(const std::string& ptx);
 
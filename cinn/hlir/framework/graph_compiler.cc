@@ -15,23 +15,40 @@
 #include "cinn/hlir/framework/graph_compiler.h"
 
 #include <absl/container/flat_hash_map.h>
-
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <unordered_set>
 
 #include "cinn/backends/codegen_cuda_dev.h"
 #include "cinn/common/context.h"
+#include "cinn/hlir/framework/compilation_cache.h"
 #include "cinn/hlir/framework/instruction.h"
+#include "cinn/hlir/framework/kernel_cost.h"
+#include "cinn/hlir/framework/memory_planner.h"
 #include "cinn/hlir/framework/op_lowering_util.h"
+#include "cinn/hlir/framework/pass.h"
+#include "cinn/hlir/framework/program_benchmark.h"
 #include "cinn/hlir/framework/tensor.h"
 #include "cinn/hlir/pe/schedule.h"
 #include "cinn/lang/lower.h"
 #include "cinn/optim/transform_gpu_forloop.h"
 #include "cinn/poly/stage.h"
 #include "cinn/utils/profiler.h"
+#include "cinn/utils/string.h"
 
 DECLARE_bool(cinn_ir_schedule);
 DECLARE_int32(cinn_parallel_compile_size);
+DECLARE_string(cinn_compilation_cache_dir);
+DECLARE_int32(cinn_inter_op_num_threads);
 
 namespace cinn {
 namespace hlir {
@@ -64,7 +81,7 @@ void AddAttrs(const absl::flat_hash_map<std::string, AttrType>& attrs_store,
 }
 
 Program::Program(const std::shared_ptr<Scope>& scope, std::vector<std::unique_ptr<Instruction>>&& instrs)
-    : scope_(scope) {
+    : scope_(scope), num_threads_(std::max(FLAGS_cinn_inter_op_num_threads, 1)) {
   for (auto& ins : instrs) {
     if (ins->pre_run) {
       prerun_instrs_.push_back(std::move(ins));
@@ -85,6 +102,9 @@ void Program::PreRun(const std::map<std::string, cinn_pod_value_t>* name2podargs
   }
 }
 
+// the page size which the persistent buffers are aligned to in the exported file
+constexpr int kExportPageSize = 4096;
+
 void Program::Export(const std::vector<std::string>& persistent_vars, const std::string& filename) {
   auto writeplaceholder = [=](int s, int n, FILE* f) -> int {
     int pos = ftell(f);
@@ -117,6 +137,7 @@ void Program::Export(const std::vector<std::string>& persistent_vars, const std:
   }
 
   FILE* f = fopen(filename.c_str(), "w+");
+  CHECK(f) << "Failed to open " << filename << " to export the program";
 
   fwrite("CINN", 4, 1, f);
   int major_v = 0;
@@ -160,6 +181,9 @@ void Program::Export(const std::vector<std::string>& persistent_vars, const std:
   tellplaceholder(buffersec, f);
   // persistent_buffers
   int pbuffer = writeplaceholder(4, 1, f);
+  // the persistent buffers are kept in pages of their own, which are shared by the processes mapping the file,
+  // rather than copied on the writes to the other sections when loaded
+  padding(kExportPageSize, 0, f);
   for (auto& p : pvars) {
     if (p.first->align) {
       padding(p.first->align, 0, f);
@@ -167,7 +191,7 @@ void Program::Export(const std::vector<std::string>& persistent_vars, const std:
     tellplaceholder(p.second, f);
     fwrite(p.first->memory, p.first->memory_size, 1, f);
   }
-  padding(16, 0, f);
+  padding(kExportPageSize, 0, f);
   tellplaceholder(pbuffer, f);
   // instructions
   int instsec = writeplaceholder(4, 1, f);
@@ -208,7 +232,127 @@ void Program::Export(const std::vector<std::string>& persistent_vars, const std:
   fclose(f);
 }
 
+std::unique_ptr<Program> Program::Clone(const std::unordered_set<std::string>& private_var_names) const {
+  utils::RecordEvent("Program Clone", utils::EventType::kOrdinary);
+  std::unordered_set<std::string> written_vars;
+  for (auto* instrs : {&prerun_instrs_, &instrs_}) {
+    for (auto& ins : *instrs) {
+      for (auto& args : ins->GetOutArgs()) {
+        written_vars.insert(args.begin(), args.end());
+      }
+    }
+  }
+
+  auto scope  = std::make_shared<Scope>();
+  auto target = instrs_.empty() ? common::DefaultHostTarget() : instrs_[0]->target_;
+  // the variables sharing one buffer, such as the ones reused by reshape, still share a buffer in the clone
+  absl::flat_hash_map<Buffer*, std::shared_ptr<Buffer>> cloned_buffers;
+  int num_shared = 0;
+  for (auto& name_view : scope_->var_names()) {
+    std::string name(name_view.data(), name_view.size());
+    auto src_tensor = scope_->GetTensor(name);
+    auto* var       = scope->Var<Tensor>(name);
+    if (!written_vars.count(name) && !private_var_names.count(name)) {
+      *var = src_tensor;
+      ++num_shared;
+      continue;
+    }
+
+    auto& tensor = absl::get<Tensor>(*var);
+    auto type    = src_tensor->type();
+    auto it      = cloned_buffers.find(src_tensor->get_buffer().get());
+    if (it != cloned_buffers.end()) {
+      tensor->set_buffer(it->second);
+    } else if (src_tensor->buffer()->memory) {
+      tensor->Resize(src_tensor->shape());
+      tensor->mutable_data(target, type);
+      cloned_buffers.emplace(src_tensor->get_buffer().get(), tensor->get_buffer());
+    }
+    tensor->Resize(src_tensor->shape());
+    tensor->set_type(type);
+  }
+  VLOG(3) << "Clone program with " << num_shared << " shared variables and "
+          << scope_->var_names().size() - num_shared << " private variables";
+
+  std::vector<std::unique_ptr<Instruction>> instrs;
+  for (auto* src_instrs : {&prerun_instrs_, &instrs_}) {
+    for (auto& ins : *src_instrs) {
+      instrs.emplace_back(ins->Clone(scope.get()));
+    }
+  }
+  auto program = std::make_unique<Program>(scope, std::move(instrs));
+  program->num_threads_   = num_threads_;
+  program->thread_config_ = thread_config_;
+  program->code_owner_    = code_owner_;
+  return program;
+}
+
+void Program::BindArgs(const std::map<std::string, cinn_pod_value_t>* name2podargs) {
+  utils::RecordEvent("Program BindArgs", utils::EventType::kOrdinary);
+  name2slot_.clear();
+  slot_refs_.clear();
+  for (auto& ins : instrs_) {
+    ins->UpdateArgsCache(name2podargs);
+    auto in_args  = ins->GetInArgs();
+    auto out_args = ins->GetOutArgs();
+    for (int fn_idx = 0; fn_idx < ins->size(); ++fn_idx) {
+      std::vector<std::string> all_args = in_args[fn_idx];
+      all_args.insert(all_args.end(), out_args[fn_idx].begin(), out_args[fn_idx].end());
+      for (int arg_idx = 0; arg_idx < all_args.size(); ++arg_idx) {
+        auto it = name2slot_.find(all_args[arg_idx]);
+        if (it == name2slot_.end()) {
+          it = name2slot_.emplace(all_args[arg_idx], slot_refs_.size()).first;
+          slot_refs_.emplace_back();
+        }
+        slot_refs_[it->second].push_back({ins.get(), fn_idx, arg_idx});
+      }
+    }
+  }
+  VLOG(3) << "Bind " << name2slot_.size() << " argument slots for " << instrs_.size() << " instructions";
+}
+
+int Program::GetArgSlot(const std::string& name) const {
+  auto it = name2slot_.find(name);
+  return it == name2slot_.end() ? -1 : it->second;
+}
+
+void Program::SetArg(int slot, const cinn_pod_value_t& value) {
+  CHECK(slot >= 0 && slot < slot_refs_.size()) << "The slot " << slot << " is out of range, call BindArgs first";
+  for (auto& ref : slot_refs_[slot]) {
+    ref.instr->SetCachedArg(ref.fn_idx, ref.arg_idx, value);
+  }
+}
+
+void Program::SetNumThreads(int num_threads) {
+  CHECK_GT(num_threads, 0) << "The number of threads should be greater than 0";
+  if (num_threads != num_threads_) {
+    num_threads_ = num_threads;
+    parallel_executor_.reset();
+  }
+}
+
+void Program::SetThreadConfig(const runtime::cpu::ThreadConfig& config) {
+  thread_config_ = std::make_shared<const runtime::cpu::ThreadConfig>(config);
+  num_threads_   = std::max(config.inter_op_num_threads, 1);
+  parallel_executor_.reset();
+}
+
 void Program::Execute(const std::map<std::string, cinn_pod_value_t>* name2podargs, void* stream, bool use_cache) {
+  // the instructions on GPU are ordered by the stream, so only run them concurrently on X86, and the
+  // variables planned in one arena may alias, so keep the order if the memory is planned
+  if (num_threads_ > 1 && !arena_ && !instrs_.empty() && instrs_[0]->target_.arch == Target::Arch::X86) {
+    if (!parallel_executor_) {
+      parallel_executor_ = std::make_unique<ParallelExecutor>(
+          instrs_, num_threads_, thread_config_ ? *thread_config_ : runtime::cpu::ThreadConfig());
+    }
+    parallel_executor_->Run(name2podargs, stream, use_cache);
+    return;
+  }
+
+  std::unique_ptr<runtime::cpu::ScopedThreadConfig> scoped_thread_config;
+  if (thread_config_ && !instrs_.empty() && instrs_[0]->target_.arch == Target::Arch::X86) {
+    scoped_thread_config = std::make_unique<runtime::cpu::ScopedThreadConfig>(*thread_config_);
+  }
   for (auto& ins : instrs_) {
     ins->Run(name2podargs, false, stream, use_cache);
   }
@@ -221,25 +365,11 @@ void Program::Execute(const std::map<std::string, cinn_pod_value_t>* name2podarg
 }
 
 void Program::ExecuteTest(int repeat_) {
-  cinn::utils::Timer timer1;
-  for (int i = 0; i < 100; i++) {
-    for (auto& ins : instrs_) {
-      ins->Run();
-    }
-  }
-  timer1.Start();
-  for (int i = 0; i < repeat_; i++) {
-    for (auto& ins : instrs_) {
-      ins->Run();
-    }
-  }
-#ifdef CINN_WITH_CUDA
-  if (instrs_[0]->target_.arch == Target::Arch::NVGPU) {
-    CUDA_CALL(cudaDeviceSynchronize());
-  }
-#endif
-  double test_op_time = timer1.Stop() / repeat_;
-  VLOG(3) << "Repeat times: [" << repeat_ << "], average op time: [" << test_op_time << "] ms";
+  BenchmarkOptions options;
+  options.warmup = 100;
+  options.repeat = repeat_;
+  auto result    = BenchmarkProgram(this, options);
+  VLOG(3) << "Repeat times: [" << repeat_ << "], average op time: [" << result.total.mean << "] ms";
 }
 
 void GraphCompiler::PrintFunc() {
@@ -763,23 +893,60 @@ GraphCompiler::CompilationResult GraphCompiler::Build(const GraphCompiler::Compi
     VLOG(2) << "Compile With Parallel Compiler!";
     utils::RecordEvent("GraphCompiler CompileResult", utils::EventType::kOrdinary);
     ParallelCompiler::CompileOptions option;
-    option.lowered_funcs = options.lowered_funcs;
+    option.lowered_funcs         = options.lowered_funcs;
+    option.lazy_compile          = options.lazy_compile;
+    option.lazy_compile_prefetch = options.lazy_compile_prefetch;
+    option.execution_options     = options.execution_options;
+
+    std::vector<std::unique_ptr<Instruction>> instructions;
+    // the compilation cache only supports the object code of X86 and the groups lowered by itself, and the modules
+    // linked by several compile threads can't be exported to it
+    bool use_compilation_cache = !FLAGS_cinn_compilation_cache_dir.empty() && target_.arch == Target::Arch::X86 &&
+                                 options.lowered_funcs.empty() && options.execution_options.num_compile_threads <= 1;
+    std::string signature;
+    if (use_compilation_cache) {
+      if (graph_->fusion_groups.empty()) {
+        hlir::framework::ApplyPasses(graph_.get(), {"BuildNonFusedGroupsPass"});
+      }
+      // the objects compiled with other LLVM options are not reused
+      signature = CompilationCache::GraphSignature(*graph_, target_) + options.execution_options.ToString();
+    }
 
-    parallel_compiler_ = std::make_shared<ParallelCompiler>(scope_, graph_, option, target_);
-    auto instructions  = (*parallel_compiler_.get())();
+    if (!use_compilation_cache || !LoadFromCompilationCache(signature, &instructions)) {
+      parallel_compiler_ = std::make_shared<ParallelCompiler>(scope_, graph_, option, target_);
+      instructions       = (*parallel_compiler_.get())();
+      // the lazy groups are not compiled yet, so nothing is saved to the cache
+      if (use_compilation_cache && !options.lazy_compile) {
+        SaveToCompilationCache(signature);
+      }
+    }
 
     if (options.remove_unused_variables) {
       RemoveInvalidVariables(instructions);
     }
 
+    // plan the memory by the lifetimes of the compute instructions, before the buffer handlers are inserted
+    std::shared_ptr<Buffer> arena;
+    std::unordered_set<std::string> planned_vars;
+    if (options.with_static_memory_plan) {
+      VLOG(3) << "option.with_static_memory_plan enable";
+      arena = PlanMemory(instructions, fetch_var_ids.empty() ? fetch_var_ids_ : fetch_var_ids, &planned_vars);
+    }
     if (options.with_buffer_handle_instruction_inserted) {
       VLOG(3) << "option.with_buffer_handle_instruction_inserted enable";
-      InsertBufferHandlers(&instructions);
+      InsertBufferHandlers(&instructions, planned_vars);
     }
     VLOG(2) << "Compile With Parallel Compiler Done!";
 
     GraphCompiler::CompilationResult compilation_result;
     compilation_result.runtime_program.reset(new Program(scope_, std::move(instructions)));
+    // the lazy instructions compile their groups by the parallel compiler, maybe after this GraphCompiler is gone
+    if (parallel_compiler_) {
+      compilation_result.runtime_program->SetCodeOwner(parallel_compiler_);
+    }
+    if (arena) {
+      compilation_result.runtime_program->SetMemoryArena(arena);
+    }
     return compilation_result;
   }
 
@@ -864,19 +1031,20 @@ GraphCompiler::CompilationResult GraphCompiler::Build(const GraphCompiler::Compi
     utils::RecordEvent("GraphCompiler ProcessFunction", utils::EventType::kOrdinary);
     for (auto&& lowered_func : lowered_funcs) {
       this->ProcessFunction(lowered_func);
+      RegisterKernelCosts(lowered_func);
     }
   }
 
   // compile the module
   // Need to create a new compiler for every call of Build,
   // because the underneath jit engine does't support addIRModule repeatedly now.
-  compiler_ = backends::Compiler::Create(target_);
+  compiler_ = backends::Compiler::Create(target_, options.execution_options);
 
   auto build_module = m_builder_.Build();
   VLOG(3) << "End of m_builder_.Build()";
   if (this->target_.arch == Target::Arch::X86) {
     utils::RecordEvent("GraphCompiler CodeGenCX86", utils::EventType::kOrdinary);
-    CodeGenCX86 codegen(this->target_, CodeGenCX86::Feature::AVX512);
+    CodeGenCX86 codegen(this->target_, CodeGenCX86::GetFeature(this->target_));
     codegen.SetInlineBuiltinCodes(false);
     auto out = codegen.Compile(build_module, CodeGenC::OutputKind::CImpl);
     VLOG(3) << "[X86] C Code is:\n" << out;
@@ -893,9 +1061,15 @@ GraphCompiler::CompilationResult GraphCompiler::Build(const GraphCompiler::Compi
   if (options.remove_unused_variables) {
     RemoveInvalidVariables(instructions);
   }
+  std::shared_ptr<Buffer> arena;
+  std::unordered_set<std::string> planned_vars;
+  if (options.with_static_memory_plan) {
+    VLOG(3) << "option.with_static_memory_plan enable";
+    arena = PlanMemory(instructions, fetch_var_ids_, &planned_vars);
+  }
   if (options.with_buffer_handle_instruction_inserted) {
     VLOG(3) << "option.with_buffer_handle_instruction_inserted enable";
-    InsertBufferHandlers(&instructions);
+    InsertBufferHandlers(&instructions, planned_vars);
   }
 
   if (options.with_instantiate_variables) {
@@ -918,6 +1092,9 @@ GraphCompiler::CompilationResult GraphCompiler::Build(const GraphCompiler::Compi
 
   GraphCompiler::CompilationResult result;
   result.runtime_program.reset(new Program(scope_, std::move(instructions)));
+  if (arena) {
+    result.runtime_program->SetMemoryArena(arena);
+  }
   return result;
 }
 
@@ -1295,6 +1472,160 @@ void GraphCompiler::RemoveInvalidVariables(const std::vector<std::unique_ptr<Ins
   });
 }
 
+bool GraphCompiler::LoadFromCompilationCache(const std::string& signature,
+                                             std::vector<std::unique_ptr<Instruction>>* instructions) {
+  utils::RecordEvent("GraphCompiler LoadFromCompilationCache", utils::EventType::kOrdinary);
+  CompilationCache cache(FLAGS_cinn_compilation_cache_dir);
+  CompilationCache::Entry entry;
+  if (!cache.Lookup(signature, &entry)) {
+    return false;
+  }
+  if (entry.functions.size() != graph_->fusion_groups.size()) {
+    LOG(WARNING) << "The compilation cache holds " << entry.functions.size() << " functions, but the graph has "
+                 << graph_->fusion_groups.size() << " groups, skip the cache.";
+    return false;
+  }
+
+  std::vector<std::unique_ptr<backends::ExecutionEngine>> engines;
+  for (auto& path : entry.object_files) {
+    auto engine = backends::ExecutionEngine::Create(backends::ExecutionOptions());
+    if (!engine->AddObjectFile(path)) {
+      return false;
+    }
+    engines.emplace_back(std::move(engine));
+  }
+
+  std::vector<std::unique_ptr<Instruction>> results;
+  for (int idx = 0; idx < entry.functions.size(); ++idx) {
+    const auto& record = entry.functions[idx];
+    auto* fn_ptr       = engines[record.object_idx]->Lookup(record.func_name);
+    if (!fn_ptr) {
+      LOG(WARNING) << "Can't find function " << record.func_name << " in the compilation cache, skip the cache.";
+      return false;
+    }
+    // keep the group consistent with the one that is lowered
+    auto& group         = graph_->fusion_groups[idx];
+    group->input_names  = record.input_names;
+    group->output_names = record.output_names;
+
+    auto instr = std::make_unique<Instruction>(
+        target_, scope_.get(), record.input_names, record.output_names, record.func_name);
+    instr->SetLoweredFunc(fn_ptr, record.func_name);
+    instr->Finalize();
+    results.emplace_back(std::move(instr));
+  }
+
+  cached_engines_.swap(engines);
+  cached_object_files_ = entry.object_files;
+  instructions->swap(results);
+  VLOG(2) << "Build " << instructions->size() << " instructions from compilation cache";
+  return true;
+}
+
+void GraphCompiler::SaveToCompilationCache(const std::string& signature) {
+  utils::RecordEvent("GraphCompiler SaveToCompilationCache", utils::EventType::kOrdinary);
+  CHECK(parallel_compiler_) << "The graph should be compiled by the parallel compiler first";
+  std::vector<backends::ExecutionEngine*> engines;
+  std::vector<CompilationCache::FunctionRecord> functions(graph_->fusion_groups.size());
+  for (auto& task : parallel_compiler_->tasks_) {
+    if (task.gidx.empty()) {
+      continue;
+    }
+    for (int gidx : task.gidx) {
+      auto& group                  = graph_->fusion_groups[gidx];
+      functions[gidx].object_idx   = engines.size();
+      functions[gidx].func_name    = group->GetFuncName();
+      functions[gidx].input_names  = group->input_names;
+      functions[gidx].output_names = group->output_names;
+    }
+    engines.push_back(task.engine.get());
+  }
+  // the deduplicated groups call the functions of their representatives
+  for (int gidx = 0; gidx < functions.size(); ++gidx) {
+    int rep_idx = parallel_compiler_->GetRepresentativeGroup(gidx);
+    if (rep_idx == gidx) {
+      continue;
+    }
+    auto& group                  = graph_->fusion_groups[gidx];
+    functions[gidx].object_idx   = functions[rep_idx].object_idx;
+    functions[gidx].func_name    = functions[rep_idx].func_name;
+    functions[gidx].input_names  = group->input_names;
+    functions[gidx].output_names = group->output_names;
+  }
+
+  CompilationCache cache(FLAGS_cinn_compilation_cache_dir);
+  cache.Insert(
+      signature,
+      engines.size(),
+      [&engines](int idx, const std::string& path) { return engines[idx]->ExportObject(path); },
+      functions);
+}
+
+// run a program by its arguments without a shell, so the paths need no quoting, and return the exit status of it
+static int RunProgram(const std::vector<std::string>& args) {
+  std::vector<char*> argv;
+  for (auto& arg : args) {
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+  pid_t pid;
+  int err = posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ);
+  if (err != 0) {
+    LOG(WARNING) << "Failed to run " << args[0] << ", errno = " << err;
+    return -1;
+  }
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) return -1;
+  }
+  if (WIFSIGNALED(status)) {
+    LOG(WARNING) << args[0] << " is killed by signal " << WTERMSIG(status);
+    return -1;
+  }
+  return WEXITSTATUS(status);
+}
+
+void GraphCompiler::ExportLibrary(const std::string& path, const std::string& linker) {
+  utils::RecordEvent("GraphCompiler ExportLibrary", utils::EventType::kOrdinary);
+  CHECK(target_.arch == Target::Arch::X86) << "Only the program on X86 can be exported as a shared library";
+  // the object files to link, and the temporary ones among them to remove after linking
+  std::vector<std::string> object_files, temporary_files;
+  auto next_object_file = [&]() {
+    std::string object_file = path + "." + std::to_string(object_files.size()) + ".o";
+    object_files.push_back(object_file);
+    temporary_files.push_back(object_file);
+    return object_file;
+  };
+  bool exported = true;
+  if (parallel_compiler_) {
+    parallel_compiler_->CompileLazyFunctions();
+    for (auto& task : parallel_compiler_->tasks_) {
+      if (!task.gidx.empty()) exported = task.engine->ExportObject(next_object_file()) && exported;
+    }
+  } else if (!cached_object_files_.empty()) {
+    object_files = cached_object_files_;
+  } else {
+    CHECK(compiler_) << "The program should be built before exported";
+    exported = compiler_->ExportObject(next_object_file());
+  }
+
+  int ret = -1;
+  std::vector<std::string> args{linker, "-shared", "-fPIC", "-o", path};
+  args.insert(args.end(), object_files.begin(), object_files.end());
+  auto command = utils::Join(args, " ");
+  if (exported) {
+    VLOG(3) << "Link the shared library by: " << command;
+    ret = RunProgram(args);
+  }
+  for (auto& object_file : temporary_files) {
+    std::remove(object_file.c_str());
+  }
+  CHECK(exported) << "Failed to export the object files to link the shared library " << path
+                  << ", the program compiled with ExecutionOptions::num_compile_threads > 1 can't be exported";
+  CHECK_EQ(ret, 0) << "Failed to link the shared library " << path << ", the linker exits with " << ret
+                   << ", the command: " << command;
+}
+
 static void BufferMallocWithCallback(void* args, int num_args) {
   cinn_pod_value_t* pod_args = static_cast<cinn_pod_value_t*>(args);
   for (int i = 0; i < num_args; ++i) {
@@ -1345,10 +1676,22 @@ void GraphCompiler::AnalyzeVariableLifeTime(const std::vector<std::unique_ptr<In
   }
 }
 
-void GraphCompiler::InsertBufferHandlers(std::vector<std::unique_ptr<Instruction>>* instructions) {
+void GraphCompiler::InsertBufferHandlers(std::vector<std::unique_ptr<Instruction>>* instructions,
+                                         const std::unordered_set<std::string>& planned_vars) {
   utils::RecordEvent("GraphCompiler InsertBufferHandlers", utils::EventType::kOrdinary);
   std::unordered_map<int, std::vector<std::string>> step2malloc, step2free;
   AnalyzeVariableLifeTime(*instructions, &step2malloc, &step2free);
+  // the planned variables live in the memory arena, which is neither allocated nor freed by the handlers
+  for (auto* step2vars : {&step2malloc, &step2free}) {
+    for (auto it = step2vars->begin(); it != step2vars->end();) {
+      auto& var_names = it->second;
+      var_names.erase(std::remove_if(var_names.begin(),
+                                     var_names.end(),
+                                     [&planned_vars](const std::string& name) { return planned_vars.count(name); }),
+                      var_names.end());
+      it = var_names.empty() ? step2vars->erase(it) : std::next(it);
+    }
+  }
 
   std::vector<std::unique_ptr<Instruction>> results;
   for (auto step = 0; step < instructions->size(); ++step) {
@@ -1390,6 +1733,95 @@ void GraphCompiler::InsertBufferHandlers(std::vector<std::unique_ptr<Instruction
   instructions->swap(results);
 }
 
+std::shared_ptr<Buffer> GraphCompiler::PlanMemory(const std::vector<std::unique_ptr<Instruction>>& instructions,
+                                                  const std::unordered_set<std::string>& fetch_var_ids,
+                                                  std::unordered_set<std::string>* planned_vars) {
+  utils::RecordEvent("GraphCompiler PlanMemory", utils::EventType::kOrdinary);
+  std::unordered_map<int, std::vector<std::string>> step2malloc, step2free;
+  AnalyzeVariableLifeTime(instructions, &step2malloc, &step2free);
+
+  absl::flat_hash_map<std::string, int> variable_last_used, variable_last_read;
+  for (const auto& step2vars : step2free) {
+    for (const auto& var_name : step2vars.second) {
+      variable_last_used[var_name] = step2vars.first;
+    }
+  }
+  for (auto step = 0; step < instructions.size(); ++step) {
+    for (const auto& args : instructions.at(step)->GetInArgs()) {
+      for (const auto& var_name : args) {
+        variable_last_read[var_name] = step;
+      }
+    }
+  }
+
+  auto contains = [](const std::vector<std::vector<std::string>>& args, const std::string& var_name) {
+    return std::any_of(args.begin(), args.end(), [&var_name](const std::vector<std::string>& names) {
+      return std::find(names.begin(), names.end(), var_name) != names.end();
+    });
+  };
+
+  // the host tensors are allocated with 1024 bytes alignment in _Tensor_::mutable_data
+  size_t alignment = target_ == common::DefaultHostTarget() ? 1024 : 256;
+  MemoryPlanner planner(alignment);
+  absl::flat_hash_map<std::string, size_t> variable_size;
+  for (const auto& step2vars : step2malloc) {
+    auto first_step     = step2vars.first;
+    const auto& instr   = instructions.at(first_step);
+    const auto in_args  = instr->GetInArgs();
+    const auto out_args = instr->GetOutArgs();
+    for (const auto& var_name : step2vars.second) {
+      // only plan the intermediate variables, which are produced by an instruction and read by a later one,
+      // the inputs, parameters and outputs keep their own buffers
+      if (!contains(out_args, var_name) || contains(in_args, var_name)) continue;
+      if (!variable_last_read.count(var_name) || variable_last_read.at(var_name) <= first_step) continue;
+      if (fetch_var_ids.count(var_name)) continue;
+      // the variables sharing buffer with others are not planned
+      if (reuse_vars_map_.count(var_name) ||
+          std::any_of(reuse_vars_map_.begin(), reuse_vars_map_.end(), [&var_name](const auto& dst2src) {
+            return dst2src.second == var_name;
+          })) {
+        continue;
+      }
+      auto* var = scope_->FindVar(var_name);
+      if (!var) continue;
+      auto& tensor = absl::get<Tensor>(*var);
+      size_t size  = static_cast<size_t>(tensor->shape().numel()) * tensor->type().bytes();
+      if (size == 0) continue;
+
+      planner.AddVariable(var_name, size, first_step, variable_last_used.at(var_name));
+      variable_size[var_name] = size;
+    }
+  }
+
+  auto plan = planner.Solve();
+  if (plan.offsets.empty()) {
+    VLOG(3) << "No variable is planned";
+    return nullptr;
+  }
+  CHECK_LE(plan.arena_size, std::numeric_limits<uint32_t>::max()) << "The planned arena is too large";
+  LOG(INFO) << "Plan " << plan.offsets.size() << " variables into an arena of " << plan.arena_size
+            << " bytes, while allocating them separately takes " << plan.naive_size << " bytes";
+
+  auto arena = std::make_shared<Buffer>(target_);
+  if (target_ == common::DefaultHostTarget()) {
+    arena->Resize(alignment, plan.arena_size);
+  } else {
+    arena->Resize(plan.arena_size);
+  }
+  for (const auto& var2offset : plan.offsets) {
+    planned_vars->insert(var2offset.first);
+    auto& tensor = absl::get<Tensor>(*scope_->FindVar(var2offset.first));
+    auto buffer  = std::make_shared<Buffer>();
+    buffer->ShareMemory(arena, var2offset.second, variable_size.at(var2offset.first));
+    auto type = tensor->type();
+    tensor->set_buffer(buffer);
+    // restore the dimensions and type recorded in the new cinn_buffer_t
+    tensor->Resize(tensor->shape());
+    tensor->set_type(type);
+  }
+  return arena;
+}
+
 std::vector<std::string> GraphCompiler::OpGetInputNames(const Node* node) const {
   std::vector<std::string> res;
   if (node->op()->name == "cublas_gemm" || node->op()->name == "cublas_matmul" || node->op()->name == "conv2d" ||
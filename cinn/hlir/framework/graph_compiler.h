@@ -31,6 +31,7 @@
 #include "cinn/hlir/framework/instruction.h"
 #include "cinn/hlir/framework/op_strategy.h"
 #include "cinn/hlir/framework/parallel_compiler.h"
+#include "cinn/hlir/framework/parallel_executor.h"
 #include "cinn/hlir/framework/scope.h"
 #include "cinn/ir/lowered_func.h"
 #include "cinn/lang/packed_func.h"
@@ -54,6 +55,10 @@ class Program {
 
   void PreRun(const std::map<std::string, cinn_pod_value_t>* name2podargs = nullptr);
 
+  /**
+   * Export the program into a file loadable by the tiny runtime, which holds the data of \p persistent_vars, such
+   * as the parameters, and allocates the other variables when loaded.
+   */
   void Export(const std::vector<std::string>& persistent_vars, const std::string& filename);
 
   /**
@@ -63,13 +68,64 @@ class Program {
                void* stream                                                = nullptr,
                bool use_cache                                              = true);
 
+  // Deprecated, use BenchmarkProgram in program_benchmark.h for the statistics and per-instruction costs.
   void ExecuteTest(int repeat_);
 
+  /**
+   * Resolve the arguments of all the instructions into slots once, from \p name2podargs if given or the scope
+   * otherwise, so that the later executions with cache skip the lookups by name. Each distinct argument name
+   * gets a slot, whose value can be replaced by SetArg without resolving the arguments again.
+   */
+  void BindArgs(const std::map<std::string, cinn_pod_value_t>* name2podargs = nullptr);
+
+  // Get the slot of an argument bound by BindArgs, -1 if the argument is not used by any instruction.
+  int GetArgSlot(const std::string& name) const;
+
+  // Feed a new value, such as a cinn_buffer_t of another input, into the slot \p slot of all the instructions.
+  void SetArg(int slot, const cinn_pod_value_t& value);
+
+  /**
+   * Create a program sharing the compiled code and the read-only variables with this program, and holding the
+   * other variables in a scope of its own, so that the programs can be executed concurrently.
+   *
+   * The read-only variables are the ones never written by instructions, such as parameters, except those in
+   * \p private_var_names, which should include the inputs fed separately to each program. The compiled code is
+   * shared with this program, and kept alive by the clone as well if it is held by SetCodeOwner.
+   */
+  std::unique_ptr<Program> Clone(const std::unordered_set<std::string>& private_var_names = {}) const;
+
+  /**
+   * Set the number of threads running independent instructions concurrently on X86, the instructions are
+   * executed in order if it is 1. It defaults to FLAGS_cinn_inter_op_num_threads.
+   */
+  void SetNumThreads(int num_threads);
+
+  /**
+   * Set the threads of the program on X86, including the inter-op threads, the intra-op threads of each kernel
+   * and the cpus they are bound to, so that the programs running on one machine can share the cores without
+   * oversubscribing them. The inter-op threads override the ones set by SetNumThreads.
+   */
+  void SetThreadConfig(const runtime::cpu::ThreadConfig& config);
+
+  /**
+   * Hold the arena which the intermediate variables are planned in. The variables sharing the arena are not
+   * described by the arguments of instructions, so the instructions are always executed in order then.
+   */
+  void SetMemoryArena(const std::shared_ptr<Buffer>& arena) { arena_ = arena; }
+
+  /**
+   * Hold the owner of the compiled code, such as the ParallelCompiler whose engines hold the kernels and which
+   * compiles the lazy instructions on their first runs, so the program and its clones can outlive the GraphCompiler.
+   */
+  void SetCodeOwner(const std::shared_ptr<void>& owner) { code_owner_ = owner; }
+
   /**
    * Get the number of instructions.
    */
   size_t size() const { return instrs_.size(); }
 
+  const std::shared_ptr<Scope>& GetScope() const { return scope_; }
+
   const std::vector<std::unique_ptr<Instruction>>& GetPreRunInstructions() { return prerun_instrs_; }
   const std::vector<std::unique_ptr<Instruction>>& GetRunInstructions() { return instrs_; }
 
@@ -80,6 +136,25 @@ class Program {
   std::vector<std::unique_ptr<Instruction>> prerun_instrs_;
   // only runtime instructions
   std::vector<std::unique_ptr<Instruction>> instrs_;
+  // the number of threads running instructions
+  int num_threads_;
+  // created at the first execution when num_threads_ > 1
+  std::unique_ptr<ParallelExecutor> parallel_executor_;
+  // set by SetThreadConfig, null means the threads are decided by the flags
+  std::shared_ptr<const runtime::cpu::ThreadConfig> thread_config_;
+  // the memory of intermediate variables planned by GraphCompiler
+  std::shared_ptr<Buffer> arena_;
+  // keeps the compiled code alive, set by SetCodeOwner
+  std::shared_ptr<void> code_owner_;
+
+  // the position of an argument slot in the cached arguments of an instruction
+  struct ArgRef {
+    Instruction* instr;
+    int fn_idx;
+    int arg_idx;
+  };
+  absl::flat_hash_map<std::string, int> name2slot_;
+  std::vector<std::vector<ArgRef>> slot_refs_;
 };
 
 /**
@@ -99,6 +174,16 @@ class GraphCompiler final {
     bool with_instantiate_variables              = false;
     bool with_buffer_handle_instruction_inserted = false;
     bool remove_unused_variables                 = true;
+    // assign the intermediate variables fixed offsets inside one arena by their lifetimes,
+    // instead of allocating a buffer for each of them
+    bool with_static_memory_plan = false;
+    // lower the groups when building, but generate the code and JIT each group on the first run of its instruction,
+    // which shortens the time to the first run of programs with many groups rarely executed
+    bool lazy_compile = false;
+    // compile the lazy groups in a background thread in the order of execution
+    bool lazy_compile_prefetch = false;
+    // the LLVM optimization of the host code, e.g. the opt level, fast-math flags and vectorizers
+    backends::ExecutionOptions execution_options;
     // nodes group, it may come from the result of op fusion or graph tuning.
     // nodes in a group will be built into an Instruction
     std::vector<std::shared_ptr<Graph::Group>> groups;
@@ -114,7 +199,17 @@ class GraphCompiler final {
   CompilationResult Build(const CompileOptions& options,
                           std::unordered_set<std::string>&& fetch_var_ids = {},
                           void* stream                                    = nullptr);
-  void ExportObject(const std::string& path) { compiler_->ExportObject(path); }
+  bool ExportObject(const std::string& path) { return compiler_->ExportObject(path); }
+
+  /**
+   * Link the object code of the built program on X86 into a shared library by the system compiler \p linker, so
+   * that the program can be deployed without the compiler stack. \p linker is the name or path of the program run
+   * without a shell. The runtime functions called by the kernels, such as cinn_backend_parallel_launch, are left
+   * undefined and resolved from the process loading the library, the ones in the runtime IR are internal to every
+   * object, so the objects of several compiled tasks are linked together. The program compiled with
+   * ExecutionOptions::num_compile_threads > 1 keeps no object code to link, and fails to be exported.
+   */
+  void ExportLibrary(const std::string& path, const std::string& linker = "c++");
 
   std::unique_ptr<Program> Build(const std::string& code = "");
 
@@ -162,12 +257,33 @@ class GraphCompiler final {
 
   // insert a buffer malloc instruction applying on variables before they are
   // firstly used in the next instruction, and insert a buffer free instruction
-  // applying on variables after no instruction will use them anymore
-  void InsertBufferHandlers(std::vector<std::unique_ptr<Instruction>>* instructions);
+  // applying on variables after no instruction will use them anymore,
+  // except the variables planned in the memory arena
+  void InsertBufferHandlers(std::vector<std::unique_ptr<Instruction>>* instructions,
+                            const std::unordered_set<std::string>& planned_vars = {});
+
+  // plan the intermediate variables into one arena by the lifetimes analyzed by AnalyzeVariableLifeTime, and
+  // let their tensors refer to the assigned memory, return nullptr if there is no variable to plan. It runs on
+  // the compute instructions before the buffer handlers are inserted, and the fetched variables are never planned.
+  std::shared_ptr<Buffer> PlanMemory(const std::vector<std::unique_ptr<Instruction>>& instructions,
+                                     const std::unordered_set<std::string>& fetch_var_ids,
+                                     std::unordered_set<std::string>* planned_vars);
+
+  // load the object code of all fusion groups from the compilation cache and
+  // build instructions with it, return false if there is no valid cache entry
+  bool LoadFromCompilationCache(const std::string& signature,
+                                std::vector<std::unique_ptr<Instruction>>* instructions);
+
+  // save the object code generated by the parallel compiler into the compilation cache
+  void SaveToCompilationCache(const std::string& signature);
 
  private:
   // parallel compiler
   std::shared_ptr<ParallelCompiler> parallel_compiler_;
+  // the engines holding the object code loaded from compilation cache
+  std::vector<std::unique_ptr<backends::ExecutionEngine>> cached_engines_;
+  // the object files in the compilation cache which the cached engines are loaded from
+  std::vector<std::string> cached_object_files_;
 
   void ProcessFunction(const std::vector<ir::LoweredFunc>& lowered_funcs);
   void SetSubKernels(Instruction* instr, const std::string& func_name);
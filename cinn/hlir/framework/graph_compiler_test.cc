@@ -117,6 +117,72 @@ TEST(GraphCompilerTest, TestInsertBufferHandlers) {
             used_variable_names);
 }
 
+TEST(GraphCompilerTest, TestStaticMemoryPlan) {
+  frontend::NetBuilder builder("test");
+  auto a = builder.CreateInput(Float(32), {64, 256}, "A");
+  auto b = builder.CreateInput(Float(32), {64, 256}, "B");
+  auto c = builder.Relu(a);
+  auto d = builder.Scale(c, 2.0f, 1.0f);
+  auto e = builder.Relu(d);
+  auto f = builder.Add(e, b);
+
+  auto target  = common::DefaultHostTarget();
+  auto program = builder.Build();
+  // keep every operator in a group of its own, so the intermediate variables are arguments of the instructions
+  frontend::OptimizeOptions optimize_options;
+  optimize_options.graph_passes = {"BuildNonFusedGroupsPass"};
+
+  auto build = [&](bool with_static_memory_plan, bool with_buffer_handle_instruction_inserted) {
+    auto graph = Optimize(&program, {f->id}, target, optimize_options);
+    auto scope = BuildScope(target, graph);
+    GraphCompiler gc(target, scope, graph);
+    GraphCompiler::CompileOptions options;
+    options.with_instantiate_variables              = true;
+    options.with_static_memory_plan                 = with_static_memory_plan;
+    options.with_buffer_handle_instruction_inserted = with_buffer_handle_instruction_inserted;
+    auto runtime_program                            = gc.Build(options, {f->id}).runtime_program;
+    SetRandData<float>(scope->GetTensor("A"), target, 1);
+    SetRandData<float>(scope->GetTensor("B"), target, 2);
+    return std::make_pair(std::move(runtime_program), scope);
+  };
+
+  auto naive   = build(false, false);
+  auto planned = build(true, false);
+  naive.first->Execute();
+  planned.first->Execute();
+
+  // c and e are never alive at the same time, so they take the same memory of the arena
+  auto memory_of = [](const std::shared_ptr<Scope>& scope, const std::string& name) {
+    return scope->GetTensor(name)->get_buffer()->data()->memory;
+  };
+  EXPECT_NE(memory_of(naive.second, c->id), memory_of(naive.second, e->id));
+  EXPECT_EQ(memory_of(planned.second, c->id), memory_of(planned.second, e->id));
+
+  auto naive_f   = GetTensorData<float>(naive.second->GetTensor(f->id), target);
+  auto planned_f = GetTensorData<float>(planned.second->GetTensor(f->id), target);
+  ASSERT_EQ(naive_f.size(), planned_f.size());
+  for (int i = 0; i < naive_f.size(); ++i) {
+    ASSERT_FLOAT_EQ(naive_f[i], planned_f[i]);
+  }
+
+  // the planned variables are neither allocated nor freed by the buffer handlers
+  auto with_handlers = build(true, true);
+  for (auto& instr : with_handlers.first->GetRunInstructions()) {
+    auto fn_name = instr->GetFnNames().front();
+    if (fn_name.find("malloc_buffer_instruction_") != 0 && fn_name.find("free_buffer_instruction_") != 0) {
+      continue;
+    }
+    for (const auto& args : {instr->GetInArgs(), instr->GetOutArgs()}) {
+      for (auto& names : args) {
+        for (auto& name : names) {
+          EXPECT_NE(name, c->id);
+          EXPECT_NE(name, e->id);
+        }
+      }
+    }
+  }
+}
+
 #ifdef CINN_WITH_CUDA
 std::vector<float> test_mul(
     const std::vector<float>& A, const std::vector<float>& B, int M, int K, int N, bool trans_a, bool trans_b) {
@@ -112,22 +112,55 @@ void Instruction::Finalize() {
     in_args_.erase(in_args_.begin());
   }
 
+  dispatch_kind_  = GetDispatchKind();
   finalized_flag_ = true;
 }
 
+void Instruction::ResolveLazyFunctions() {
+  utils::RecordEvent record_compile("LazyCompile " + function_name_, cinn::utils::EventType::kOrdinary);
+  for (int idx = 0; idx < lazy_fns_.size(); ++idx) {
+    if (lazy_fns_[idx]) {
+      VLOG(3) << "Compile the lazy function " << fn_names_[idx] << " on its first run";
+      fn_ptrs_[idx] = lazy_fns_[idx]->Get();
+    }
+  }
+  lazy_fns_resolved_ = true;
+}
+
+Instruction::DispatchKind Instruction::GetDispatchKind() const {
+  if (function_name_ == "no_run") return DispatchKind::kNoRun;
+#ifdef CINN_WITH_CUDA
+  if (target_.arch == Target::Arch::NVGPU) {
+    if (function_name_ == "cublas_gemm") return DispatchKind::kCublasGemm;
+    if (function_name_ == "cublas_matmul") return DispatchKind::kCublasMatmul;
+#ifdef CINN_WITH_CUDNN
+    if (function_name_ == "conv2d" || function_name_ == "depthwise_conv2d") return DispatchKind::kCudnnConv2d;
+    if (function_name_ == "pool2d") return DispatchKind::kCudnnPool2d;
+    if (function_name_ == "softmax") return DispatchKind::kCudnnSoftmax;
+    if (function_name_ == "mul") return DispatchKind::kCublasMul;
+#endif
+  }
+#endif
+  return DispatchKind::kLoweredFunc;
+}
+
 void Instruction::Run(const std::map<std::string, cinn_pod_value_t>* name2podargs,
                       bool dryrun,
                       void* stream,
                       bool use_cache) {
   utils::RecordEvent record_run(function_name_, cinn::utils::EventType::kInstruction);
   CHECK(finalized_flag_) << "Instruction must be finalized before run";
-  if (function_name_ == "no_run") {
+  if (dispatch_kind_ == DispatchKind::kNoRun) {
     VLOG(2) << "skip instruction";
     return;
   }
 
   VLOG(2) << "Run function " << function_name_;
 
+  if (!lazy_fns_resolved_ && !lazy_fns_.empty()) {
+    ResolveLazyFunctions();
+  }
+
   {
     utils::RecordEvent record_args("PrepareArgs", cinn::utils::EventType::kInstruction);
     if (!use_cache || args_cached_.size() != size()) {
@@ -136,134 +169,123 @@ void Instruction::Run(const std::map<std::string, cinn_pod_value_t>* name2podarg
   }
 
   utils::ProfilerRangePush("Compute");
-#if defined(CINN_WITH_CUDA) && !defined(CINN_WITH_CUDNN)
-  if (function_name_ == "cublas_gemm" && target_.arch == Target::Arch::NVGPU) {
-    auto& pod_args = args_cached_[0];
-    VLOG(3) << "The pod_args size of cublas_gemm: " << pod_args.size();
-    runtime::cuda::cinn_gpu_cublas_gemm(
-        attrs, pod_args[0], pod_args[1], pod_args[2], pod_args[3], static_cast<cudaStream_t>(stream));
-  } else if (function_name_ == "cublas_matmul" && target_.arch == Target::Arch::NVGPU) {
-    auto& pod_args = args_cached_[0];
-    VLOG(3) << "The pod_args size of cublas_matmul: " << pod_args.size();
-    runtime::cuda::cinn_gpu_cublas_gemm(
-        attrs, pod_args[0], pod_args[1], nullptr, pod_args[2], static_cast<cudaStream_t>(stream));
-  } else {
-    VLOG(3) << "Runing extern function " << function_name_;
-    for (int idx = 0; idx < fn_ptrs_.size(); ++idx) {
-      VLOG(3) << "Runing func name: " << fn_names_[idx];
-      auto& pod_args = args_cached_[idx];
-      CHECK(fn_ptrs_[idx]) << "The LoweredFunc address should be set first by calling SetLoweredFunc method";
-      if (!dryrun) {
-        if (target_ == common::DefaultNVGPUTarget()) {
-          ((lower_func_ptr_g)fn_ptrs_[idx])(static_cast<void*>(pod_args.data()), pod_args.size(), stream);
+  switch (dispatch_kind_) {
+#ifdef CINN_WITH_CUDA
+    case DispatchKind::kCublasGemm: {
+      auto& pod_args = args_cached_[0];
+      VLOG(3) << "The pod_args size of cublas_gemm: " << pod_args.size();
+      runtime::cuda::cinn_gpu_cublas_gemm(
+          attrs, pod_args[0], pod_args[1], pod_args[2], pod_args[3], static_cast<cudaStream_t>(stream));
+      break;
+    }
+    case DispatchKind::kCublasMatmul: {
+      auto& pod_args = args_cached_[0];
+      VLOG(3) << "The pod_args size of cublas_matmul: " << pod_args.size();
+      runtime::cuda::cinn_gpu_cublas_gemm(
+          attrs, pod_args[0], pod_args[1], nullptr, pod_args[2], static_cast<cudaStream_t>(stream));
+      break;
+    }
+#endif
+#ifdef CINN_WITH_CUDNN
+    // Here conv2d and depthwise_conv2d are implemented by one cudnn api cudnnConvolutionForward
+    case DispatchKind::kCudnnConv2d: {
+      auto& pod_args = args_cached_[0];
+      if (str_attrs[0] == "forward") {
+        if (str_attrs.size() > 1 && str_attrs[1] == "NHWC") {
+          absl::flat_hash_map<std::string, int> attrs_map = {
+              {"input_n", attrs[0]},     {"input_h", attrs[1]},     {"input_w", attrs[2]},   {"input_c", attrs[3]},
+              {"weights_n", attrs[4]},   {"weights_c", attrs[5]},   {"weights_h", attrs[6]}, {"weights_w", attrs[7]},
+              {"pad_h", attrs[8]},       {"pad_w", attrs[9]},       {"stride_h", attrs[10]}, {"stride_w", attrs[11]},
+              {"dilation_h", attrs[12]}, {"dilation_w", attrs[13]}, {"groups", attrs[14]},   {"output_n", attrs[15]},
+              {"output_h", attrs[16]},   {"output_w", attrs[17]},   {"output_c", attrs[18]},
+          };
+          runtime::cuda::cinn_gpu_cudnn_conv2d(attrs_map,
+                                               pod_args[0],
+                                               pod_args[1],
+                                               pod_args[2],
+                                               static_cast<cudaStream_t>(stream),
+                                               common::Layout::kNHWC);
+
         } else {
-          ((lower_func_ptr_t)fn_ptrs_[idx])(static_cast<void*>(pod_args.data()), pod_args.size());
+          absl::flat_hash_map<std::string, int> attrs_map = {
+              {"input_n", attrs[0]},     {"input_c", attrs[1]},     {"input_h", attrs[2]},   {"input_w", attrs[3]},
+              {"weights_n", attrs[4]},   {"weights_c", attrs[5]},   {"weights_h", attrs[6]}, {"weights_w", attrs[7]},
+              {"pad_h", attrs[8]},       {"pad_w", attrs[9]},       {"stride_h", attrs[10]}, {"stride_w", attrs[11]},
+              {"dilation_h", attrs[12]}, {"dilation_w", attrs[13]}, {"groups", attrs[14]},   {"output_n", attrs[15]},
+              {"output_c", attrs[16]},   {"output_h", attrs[17]},   {"output_w", attrs[18]},
+          };
+          runtime::cuda::cinn_gpu_cudnn_conv2d(attrs_map,
+                                               pod_args[0],
+                                               pod_args[1],
+                                               pod_args[2],
+                                               static_cast<cudaStream_t>(stream),
+                                               common::Layout::kNCHW);
         }
-      }
-    }
-    VLOG(3) << "Done Runing extern function " << function_name_;
-  }
-#elif defined(CINN_WITH_CUDNN)
-  auto& pod_args = args_cached_[0];
-  // Here conv2d and depthwise_conv2d are implemented by one cudnn api cudnnConvolutionForward
-  if ((function_name_ == "conv2d" || function_name_ == "depthwise_conv2d") && target_.arch == Target::Arch::NVGPU) {
-    if (str_attrs[0] == "forward") {
-      if (str_attrs.size() > 1 && str_attrs[1] == "NHWC") {
+      } else if (str_attrs[0] == "backward_data") {
+        // w, dy, dx
         absl::flat_hash_map<std::string, int> attrs_map = {
-            {"input_n", attrs[0]},     {"input_h", attrs[1]},     {"input_w", attrs[2]},   {"input_c", attrs[3]},
-            {"weights_n", attrs[4]},   {"weights_c", attrs[5]},   {"weights_h", attrs[6]}, {"weights_w", attrs[7]},
+            {"input_n", attrs[15]},    {"input_c", attrs[16]},    {"input_h", attrs[17]},  {"input_w", attrs[18]},
+            {"weights_n", attrs[0]},   {"weights_c", attrs[1]},   {"weights_h", attrs[2]}, {"weights_w", attrs[3]},
             {"pad_h", attrs[8]},       {"pad_w", attrs[9]},       {"stride_h", attrs[10]}, {"stride_w", attrs[11]},
-            {"dilation_h", attrs[12]}, {"dilation_w", attrs[13]}, {"groups", attrs[14]},   {"output_n", attrs[15]},
-            {"output_h", attrs[16]},   {"output_w", attrs[17]},   {"output_c", attrs[18]},
+            {"dilation_h", attrs[12]}, {"dilation_w", attrs[13]}, {"groups", attrs[14]},   {"output_n", attrs[4]},
+            {"output_c", attrs[5]},    {"output_h", attrs[6]},    {"output_w", attrs[7]},
         };
-        runtime::cuda::cinn_gpu_cudnn_conv2d(
-            attrs_map, pod_args[0], pod_args[1], pod_args[2], static_cast<cudaStream_t>(stream), common::Layout::kNHWC);
-
+        // w, dy, dx
+        runtime::cuda::cinn_gpu_cudnn_conv2d_backward_data(
+            attrs_map, pod_args[0], pod_args[1], pod_args[2], static_cast<cudaStream_t>(stream));
       } else {
+        // x, dy, w
         absl::flat_hash_map<std::string, int> attrs_map = {
-            {"input_n", attrs[0]},     {"input_c", attrs[1]},     {"input_h", attrs[2]},   {"input_w", attrs[3]},
-            {"weights_n", attrs[4]},   {"weights_c", attrs[5]},   {"weights_h", attrs[6]}, {"weights_w", attrs[7]},
-            {"pad_h", attrs[8]},       {"pad_w", attrs[9]},       {"stride_h", attrs[10]}, {"stride_w", attrs[11]},
-            {"dilation_h", attrs[12]}, {"dilation_w", attrs[13]}, {"groups", attrs[14]},   {"output_n", attrs[15]},
-            {"output_c", attrs[16]},   {"output_h", attrs[17]},   {"output_w", attrs[18]},
+            {"input_n", attrs[0]},     {"input_c", attrs[1]},     {"input_h", attrs[2]},    {"input_w", attrs[3]},
+            {"weights_n", attrs[15]},  {"weights_c", attrs[16]},  {"weights_h", attrs[17]}, {"weights_w", attrs[18]},
+            {"pad_h", attrs[8]},       {"pad_w", attrs[9]},       {"stride_h", attrs[10]},  {"stride_w", attrs[11]},
+            {"dilation_h", attrs[12]}, {"dilation_w", attrs[13]}, {"groups", attrs[14]},    {"output_n", attrs[4]},
+            {"output_c", attrs[5]},    {"output_h", attrs[6]},    {"output_w", attrs[7]},
         };
-        runtime::cuda::cinn_gpu_cudnn_conv2d(
-            attrs_map, pod_args[0], pod_args[1], pod_args[2], static_cast<cudaStream_t>(stream), common::Layout::kNCHW);
+        // x, dy, w
+        runtime::cuda::cinn_gpu_cudnn_conv2d_backward_filter(
+            attrs_map, pod_args[0], pod_args[1], pod_args[2], static_cast<cudaStream_t>(stream));
       }
-    } else if (str_attrs[0] == "backward_data") {
-      // w, dy, dx
-      absl::flat_hash_map<std::string, int> attrs_map = {
-          {"input_n", attrs[15]},    {"input_c", attrs[16]},    {"input_h", attrs[17]},  {"input_w", attrs[18]},
-          {"weights_n", attrs[0]},   {"weights_c", attrs[1]},   {"weights_h", attrs[2]}, {"weights_w", attrs[3]},
-          {"pad_h", attrs[8]},       {"pad_w", attrs[9]},       {"stride_h", attrs[10]}, {"stride_w", attrs[11]},
-          {"dilation_h", attrs[12]}, {"dilation_w", attrs[13]}, {"groups", attrs[14]},   {"output_n", attrs[4]},
-          {"output_c", attrs[5]},    {"output_h", attrs[6]},    {"output_w", attrs[7]},
-      };
-      // w, dy, dx
-      runtime::cuda::cinn_gpu_cudnn_conv2d_backward_data(
-          attrs_map, pod_args[0], pod_args[1], pod_args[2], static_cast<cudaStream_t>(stream));
-    } else {
-      // x, dy, w
-      absl::flat_hash_map<std::string, int> attrs_map = {
-          {"input_n", attrs[0]},     {"input_c", attrs[1]},     {"input_h", attrs[2]},    {"input_w", attrs[3]},
-          {"weights_n", attrs[15]},  {"weights_c", attrs[16]},  {"weights_h", attrs[17]}, {"weights_w", attrs[18]},
-          {"pad_h", attrs[8]},       {"pad_w", attrs[9]},       {"stride_h", attrs[10]},  {"stride_w", attrs[11]},
-          {"dilation_h", attrs[12]}, {"dilation_w", attrs[13]}, {"groups", attrs[14]},    {"output_n", attrs[4]},
-          {"output_c", attrs[5]},    {"output_h", attrs[6]},    {"output_w", attrs[7]},
-      };
-      // x, dy, w
-      runtime::cuda::cinn_gpu_cudnn_conv2d_backward_filter(
-          attrs_map, pod_args[0], pod_args[1], pod_args[2], static_cast<cudaStream_t>(stream));
+      break;
     }
-  } else if (function_name_ == "pool2d" && target_.arch == Target::Arch::NVGPU) {
-    runtime::cuda::cinn_gpu_cudnn_pool2d(attrs, str_attrs, pod_args[0], pod_args[1], static_cast<cudaStream_t>(stream));
-  } else if (function_name_ == "softmax" && target_.arch == Target::Arch::NVGPU) {
-    CHECK_EQ(pod_args.size(), 3);
-    runtime::cuda::cinn_gpu_cudnn_softmax(attrs, pod_args[0], pod_args[1], static_cast<cudaStream_t>(stream));
-  } else if (function_name_ == "mul" && target_.arch == Target::Arch::NVGPU) {
-    CHECK_EQ(pod_args.size(), 4);
-    runtime::cuda::cinn_gpu_cublas_mul(attrs, pod_args[0], pod_args[1], pod_args[2], static_cast<cudaStream_t>(stream));
-  } else if (function_name_ == "cublas_gemm" && target_.arch == Target::Arch::NVGPU) {
-    VLOG(3) << "The pod_args size of cublas_gemm: " << pod_args.size();
-    runtime::cuda::cinn_gpu_cublas_gemm(
-        attrs, pod_args[0], pod_args[1], pod_args[2], pod_args[3], static_cast<cudaStream_t>(stream));
-  } else if (function_name_ == "cublas_matmul" && target_.arch == Target::Arch::NVGPU) {
-    auto& pod_args = args_cached_[0];
-    VLOG(3) << "The pod_args size of cublas_matmul: " << pod_args.size();
-    runtime::cuda::cinn_gpu_cublas_gemm(
-        attrs, pod_args[0], pod_args[1], nullptr, pod_args[2], static_cast<cudaStream_t>(stream));
-  } else {
-    VLOG(3) << "Runing extern function " << function_name_;
-    for (int idx = 0; idx < fn_ptrs_.size(); ++idx) {
-      VLOG(3) << "Runing func name: " << fn_names_[idx];
-      auto& pod_args = args_cached_[idx];
-      CHECK(fn_ptrs_[idx]) << "The LoweredFunc address should be set first by calling SetLoweredFunc method";
-      if (!dryrun) {
-        if (target_ == common::DefaultNVGPUTarget()) {
-          ((lower_func_ptr_g)fn_ptrs_[idx])(static_cast<void*>(pod_args.data()), pod_args.size(), stream);
-        } else {
-          ((lower_func_ptr_t)fn_ptrs_[idx])(static_cast<void*>(pod_args.data()), pod_args.size());
-        }
-      }
+    case DispatchKind::kCudnnPool2d: {
+      auto& pod_args = args_cached_[0];
+      runtime::cuda::cinn_gpu_cudnn_pool2d(
+          attrs, str_attrs, pod_args[0], pod_args[1], static_cast<cudaStream_t>(stream));
+      break;
     }
-    VLOG(3) << "Done Runing extern function " << function_name_;
-  }
-#else
-  VLOG(3) << "Runing extern function " << function_name_;
-  for (int idx = 0; idx < fn_ptrs_.size(); ++idx) {
-    VLOG(3) << "Runing func name: " << fn_names_[idx];
-    auto& pod_args = args_cached_[idx];
-    CHECK(fn_ptrs_[idx]) << "The LoweredFunc address should be set first by calling SetLoweredFunc method";
-    if (!dryrun) {
-      if (target_ == common::DefaultNVGPUTarget()) {
-        ((lower_func_ptr_g)fn_ptrs_[idx])(static_cast<void*>(pod_args.data()), pod_args.size(), stream);
-      } else {
-        ((lower_func_ptr_t)fn_ptrs_[idx])(static_cast<void*>(pod_args.data()), pod_args.size());
+    case DispatchKind::kCudnnSoftmax: {
+      auto& pod_args = args_cached_[0];
+      CHECK_EQ(pod_args.size(), 3);
+      runtime::cuda::cinn_gpu_cudnn_softmax(attrs, pod_args[0], pod_args[1], static_cast<cudaStream_t>(stream));
+      break;
+    }
+    case DispatchKind::kCublasMul: {
+      auto& pod_args = args_cached_[0];
+      CHECK_EQ(pod_args.size(), 4);
+      runtime::cuda::cinn_gpu_cublas_mul(
+          attrs, pod_args[0], pod_args[1], pod_args[2], static_cast<cudaStream_t>(stream));
+      break;
+    }
+#endif
+    default: {
+      VLOG(3) << "Runing extern function " << function_name_;
+      bool is_nvgpu = target_ == common::DefaultNVGPUTarget();
+      for (int idx = 0; idx < fn_ptrs_.size(); ++idx) {
+        VLOG(3) << "Runing func name: " << fn_names_[idx];
+        auto& pod_args = args_cached_[idx];
+        CHECK(fn_ptrs_[idx]) << "The LoweredFunc address should be set first by calling SetLoweredFunc method";
+        if (!dryrun) {
+          if (is_nvgpu) {
+            ((lower_func_ptr_g)fn_ptrs_[idx])(static_cast<void*>(pod_args.data()), pod_args.size(), stream);
+          } else {
+            ((lower_func_ptr_t)fn_ptrs_[idx])(static_cast<void*>(pod_args.data()), pod_args.size());
+          }
+        }
       }
+      VLOG(3) << "Done Runing extern function " << function_name_;
     }
   }
-  VLOG(3) << "Done Runing extern function " << function_name_;
-#endif
   utils::ProfilerRangePop();
 
   if (!cinn::runtime::CheckStringFlagFalse(FLAGS_cinn_self_check_accuracy)) {
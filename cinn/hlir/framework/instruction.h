@@ -14,7 +14,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -31,6 +35,33 @@ namespace cinn {
 namespace hlir {
 namespace framework {
 
+/**
+ * LazyFunction holds a function which is compiled on the first call of Get. The compilation runs only once even if
+ * Get is called by multiple threads at the same time, the others wait for the result.
+ */
+class LazyFunction {
+ public:
+  explicit LazyFunction(std::function<void*()> compile) : compile_(std::move(compile)) {}
+
+  void* Get() {
+    std::call_once(flag_, [this]() {
+      fn_ptr_ = compile_();
+      CHECK(fn_ptr_) << "The lazily compiled function should not be null";
+      compile_ = nullptr;
+      compiled_.store(true, std::memory_order_release);
+    });
+    return fn_ptr_;
+  }
+
+  bool IsCompiled() const { return compiled_.load(std::memory_order_acquire); }
+
+ private:
+  std::function<void*()> compile_;
+  std::once_flag flag_;
+  void* fn_ptr_{nullptr};
+  std::atomic<bool> compiled_{false};
+};
+
 /**
  * Instruction is the basic executable element in runtime, it holds a pointer to the JIT-compiled LoweredFunc, and
  * collect the cinn_buffer of the inputs and outputs from the scope, prepare the arguments and finally pass them into
@@ -64,10 +95,43 @@ class Instruction {
     fn_names_.push_back(name);
   }
 
+  /**
+   * Set a function compiled on the first run of the instruction.
+   * @param fn The function compiled lazily, it can be shared by the clones of the instruction.
+   */
+  void SetLazyLoweredFunc(const std::shared_ptr<LazyFunction>& fn, const std::string& name = "") {
+    SetLoweredFunc(nullptr, name);
+    lazy_fns_.resize(fn_ptrs_.size());
+    lazy_fns_.back() = fn;
+  }
+
+  // whether all the functions of the instruction are compiled, it is safe to be called while the instruction runs
+  bool IsCompiled() const {
+    for (auto& fn : lazy_fns_) {
+      if (fn && !fn->IsCompiled()) return false;
+    }
+    return true;
+  }
+
   // explicitly finalize the instruction, and can't append function again after call it
   void Finalize();
 
+  // create an instruction sharing the compiled functions, but running with the variables in \p scope
+  std::unique_ptr<Instruction> Clone(Scope* scope) const {
+    auto instr    = std::make_unique<Instruction>(*this);
+    instr->scope_ = scope;
+    instr->args_cached_.clear();
+    return instr;
+  }
+
   void UpdateArgsCache(const std::map<std::string, cinn_pod_value_t>* name2podargs);
+
+  // replace the \p arg_idx-th cached argument of the \p fn_idx-th function, the inputs precede the outputs
+  void SetCachedArg(int fn_idx, int arg_idx, const cinn_pod_value_t& value) {
+    CHECK_LT(fn_idx, args_cached_.size()) << "The arguments should be cached first by calling UpdateArgsCache";
+    CHECK_LT(arg_idx, args_cached_[fn_idx].size());
+    args_cached_[fn_idx][arg_idx] = value;
+  }
   /**
    * Run the Instruction.
    */
@@ -122,6 +186,7 @@ class Instruction {
   void ClearInArgs() { in_args_.clear(); }
   void ClearOutArgs() { out_args_.clear(); }
   std::vector<std::string> GetFnNames() { return fn_names_; }
+  const std::string& GetFunctionName() const { return function_name_; }
   void AddInArgs(const std::vector<std::string>& in_args) { in_args_.push_back(in_args); }
   void AddOutArgs(const std::vector<std::string>& out_args) { out_args_.push_back(out_args); }
   std::vector<int> attrs;
@@ -133,7 +198,24 @@ class Instruction {
   void CheckResults(const std::map<std::string, cinn_pod_value_t>* name2podargs = nullptr, void* stream = nullptr);
 
  private:
-  bool finalized_flag_ = false;
+  // the way to run the instruction, decided once on finalization instead of comparing the names on every run
+  enum class DispatchKind {
+    kLoweredFunc,
+    kNoRun,
+    kCublasGemm,
+    kCublasMatmul,
+    kCublasMul,
+    kCudnnConv2d,
+    kCudnnPool2d,
+    kCudnnSoftmax,
+  };
+  DispatchKind GetDispatchKind() const;
+
+  // fill the addresses of the lazy functions, which are compiled if not yet
+  void ResolveLazyFunctions();
+
+  bool finalized_flag_        = false;
+  DispatchKind dispatch_kind_ = DispatchKind::kLoweredFunc;
   Scope* scope_{};
   std::string function_name_;
   std::vector<std::vector<std::string>> in_args_;
@@ -143,6 +225,11 @@ class Instruction {
 
   std::vector<void*> fn_ptrs_{};
   std::vector<std::string> fn_names_;
+  // the lazy functions in the same order of fn_ptrs_, which are never modified once the instruction is finalized, so
+  // IsCompiled can read them from other threads while the instruction runs
+  std::vector<std::shared_ptr<LazyFunction>> lazy_fns_;
+  // whether the addresses of the lazy functions are filled into fn_ptrs_, only accessed by the running thread
+  bool lazy_fns_resolved_{false};
 };
 
 }  // namespace framework
@@ -18,11 +18,13 @@
 
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "cinn/backends/llvm/simple_jit.h"
 #include "cinn/common/test_helper.h"
+#include "cinn/hlir/framework/graph_compiler.h"
 #include "cinn/hlir/framework/node.h"
 #include "cinn/hlir/framework/op.h"
 #include "cinn/hlir/framework/op_strategy.h"
@@ -155,6 +157,100 @@ TEST(Instruction, RunWithRawPodArgs) {
   check_equal_by_element();
 }
 
+TEST(Instruction, BindArgs) {
+  const int M = 10;
+  const int N = 20;
+
+  auto scope = std::make_shared<Scope>();
+  InstantiateScope(M, N, scope.get());
+  auto jit    = GetLoweredFunc(M, N);
+  auto fn_ptr = jit->Lookup("fn");
+  CHECK(fn_ptr);
+  std::vector<std::unique_ptr<Instruction>> instrs;
+  instrs.emplace_back(new Instruction(common::DefaultHostTarget(), scope.get(), {"x", "y"}, {"z"}));
+  instrs.back()->SetLoweredFunc(reinterpret_cast<void*>(fn_ptr));
+  instrs.back()->Finalize();
+  Program program(scope, std::move(instrs));
+
+  program.BindArgs();
+  ASSERT_EQ(program.GetArgSlot("x"), 0);
+  ASSERT_EQ(program.GetArgSlot("z"), 2);
+  ASSERT_EQ(program.GetArgSlot("w"), -1);
+  program.Execute();
+  {
+    auto* xd = scope->GetTensor("x")->data<float>();
+    auto* yd = scope->GetTensor("y")->data<float>();
+    auto* zd = scope->GetTensor("z")->data<float>();
+    for (int i = 0; i < M * N; i++) {
+      ASSERT_NEAR(xd[i] + yd[i], zd[i], 1e-5);
+    }
+  }
+
+  // feed another input into the slot of x
+  std::vector<float> new_x(M * N, 1.f);
+  cinn_buffer_t new_x_buffer = *scope->GetTensor("x")->buffer();
+  new_x_buffer.memory        = reinterpret_cast<uint8_t*>(new_x.data());
+  program.SetArg(program.GetArgSlot("x"), cinn_pod_value_t(&new_x_buffer));
+  program.Execute();
+  {
+    auto* yd = scope->GetTensor("y")->data<float>();
+    auto* zd = scope->GetTensor("z")->data<float>();
+    for (int i = 0; i < M * N; i++) {
+      ASSERT_NEAR(new_x[i] + yd[i], zd[i], 1e-5);
+    }
+  }
+}
+
+TEST(Instruction, ProgramClone) {
+  const int M = 10;
+  const int N = 20;
+
+  auto scope = std::make_shared<Scope>();
+  InstantiateScope(M, N, scope.get());
+  auto jit    = GetLoweredFunc(M, N);
+  auto fn_ptr = jit->Lookup("fn");
+  CHECK(fn_ptr);
+  std::vector<std::unique_ptr<Instruction>> instrs;
+  instrs.emplace_back(new Instruction(common::DefaultHostTarget(), scope.get(), {"x", "y"}, {"z"}));
+  instrs.back()->SetLoweredFunc(reinterpret_cast<void*>(fn_ptr));
+  instrs.back()->Finalize();
+  Program program(scope, std::move(instrs));
+
+  // x is the input fed to each program, and y is the parameter shared by them
+  std::vector<std::unique_ptr<Program>> clones;
+  for (int i = 0; i < 4; ++i) {
+    clones.emplace_back(program.Clone({"x"}));
+    auto& clone_scope = clones.back()->GetScope();
+    ASSERT_EQ(clone_scope->GetTensor("y")->data<float>(), scope->GetTensor("y")->data<float>());
+    ASSERT_NE(clone_scope->GetTensor("x")->data<float>(), scope->GetTensor("x")->data<float>());
+    ASSERT_NE(clone_scope->GetTensor("z")->data<float>(), scope->GetTensor("z")->data<float>());
+    auto* xd = clone_scope->GetTensor("x")->mutable_data<float>(common::DefaultHostTarget());
+    for (int j = 0; j < M * N; j++) {
+      xd[j] = i;
+    }
+  }
+
+  std::vector<std::thread> threads;
+  for (auto& clone : clones) {
+    threads.emplace_back([&clone]() {
+      for (int repeat = 0; repeat < 10; ++repeat) {
+        clone->Execute();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto* yd = scope->GetTensor("y")->data<float>();
+  for (int i = 0; i < clones.size(); ++i) {
+    auto* zd = clones[i]->GetScope()->GetTensor("z")->data<float>();
+    for (int j = 0; j < M * N; j++) {
+      ASSERT_NEAR(i + yd[j], zd[j], 1e-5);
+    }
+  }
+}
+
 #ifdef CINN_WITH_CUDNN
 
 class TestInstruction : public Instruction {
@@ -0,0 +1,90 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/hlir/framework/kernel_cost.h"
+
+#include "cinn/ir/ir_mutator.h"
+#include "cinn/utils/profiler.h"
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+namespace {
+
+struct FlopsCounter : public ir::IRMutator<> {
+  double flops{0.0};
+
+  void operator()(Expr* expr) { ir::IRMutator<>::Visit(expr, expr); }
+
+ private:
+  void Visit(const ir::For* op, Expr* expr) override {
+    double extent = op->extent.is_constant() ? op->extent.get_constant() : 1.0;
+    multiplier_ *= extent;
+    ir::IRMutator<>::Visit(op, expr);
+    multiplier_ /= extent;
+  }
+
+#define __(op__)                                          \
+  void Visit(const ir::op__* op, Expr* expr) override {   \
+    if (op->type().is_float()) Count(op->type().lanes()); \
+    ir::IRMutator<>::Visit(op, expr);                     \
+  }
+  __(Add)
+  __(Sub)
+  __(Mul)
+  __(Div)
+  __(Min)
+  __(Max)
+  __(Call)
+#undef __
+
+  void Count(int lanes) { flops += multiplier_ * lanes; }
+
+  double multiplier_{1.0};
+};
+
+}  // namespace
+
+utils::KernelCost EstimateKernelCost(const ir::LoweredFunc& func) {
+  utils::KernelCost cost;
+  Expr body = func->body;
+  FlopsCounter counter;
+  counter(&body);
+  cost.flops = counter.flops;
+
+  for (auto& arg : func->args) {
+    if (!arg.is_buffer()) continue;
+    double numel = 1.0;
+    for (auto& dim : arg.buffer_arg()->shape) {
+      if (dim.is_constant()) numel *= dim.get_constant();
+    }
+    cost.bytes += numel * arg.buffer_arg()->dtype.bytes();
+  }
+  return cost;
+}
+
+void RegisterKernelCosts(const std::vector<ir::LoweredFunc>& funcs) {
+  if (!utils::ProfilerHelper::IsEnableCPU()) return;
+  for (auto& func : funcs) {
+    auto cost = EstimateKernelCost(func);
+    VLOG(4) << "The estimated cost of function " << func->name << ": " << cost.flops << " flops, " << cost.bytes
+            << " bytes";
+    utils::KernelCostRegistry::Global().Register(func->name, cost);
+  }
+}
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
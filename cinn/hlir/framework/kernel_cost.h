@@ -0,0 +1,38 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "cinn/ir/lowered_func.h"
+#include "cinn/utils/event.h"
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+/**
+ * Estimate the cost of a single call of the lowered function from its IR.
+ *
+ * The flops are the floating-point arithmetic operations and math calls weighted by the extents of their enclosing
+ * loops, where a loop of non-constant extent counts once. The bytes are the sizes of the buffer arguments, that is
+ * the memory read and written at least once by the function.
+ */
+utils::KernelCost EstimateKernelCost(const ir::LoweredFunc& func);
+
+// register the estimated costs of the functions to KernelCostRegistry if the CPU profiler is enabled
+void RegisterKernelCosts(const std::vector<ir::LoweredFunc>& funcs);
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
@@ -0,0 +1,56 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/hlir/framework/kernel_cost.h"
+
+#include <gtest/gtest.h>
+
+#include "cinn/cinn.h"
+#include "cinn/lang/compute.h"
+#include "cinn/lang/lower.h"
+#include "cinn/lang/placeholder.h"
+#include "cinn/utils/profiler.h"
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+TEST(KernelCost, Elementwise) {
+  Expr M(100), N(15);
+  lang::Placeholder<float> A("A", {M, N});
+  lang::Placeholder<float> B("B", {M, N});
+  // 2 flops for each element
+  auto C = lang::Compute(
+      {M, N}, [=](Var i, Var j) -> Expr { return A(i, j) * B(i, j) + 1.f; }, "C");
+  auto stages = CreateStages({C});
+  auto func   = lang::Lower("elementwise", stages, {A, B, C});
+
+  auto cost = EstimateKernelCost(func);
+  EXPECT_DOUBLE_EQ(cost.flops, 2 * 100 * 15);
+  EXPECT_DOUBLE_EQ(cost.bytes, 3 * 100 * 15 * sizeof(float));
+
+  // the costs are only registered with the profiler enabled
+  utils::KernelCostRegistry::Global().Clear();
+  utils::KernelCost registered;
+  RegisterKernelCosts({func});
+  EXPECT_FALSE(utils::KernelCostRegistry::Global().Find("elementwise", &registered));
+  utils::ProfilerHelper::EnableCPU();
+  RegisterKernelCosts({func});
+  ASSERT_TRUE(utils::KernelCostRegistry::Global().Find("elementwise", &registered));
+  EXPECT_DOUBLE_EQ(registered.flops, cost.flops);
+}
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
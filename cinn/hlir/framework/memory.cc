@@ -14,6 +14,16 @@
 
 #include "cinn/hlir/framework/memory.h"
 
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #ifdef CINN_WITH_CUDA
 #include <cuda.h>
 #include <cuda_runtime.h>
@@ -21,6 +31,10 @@
 #include "cinn/backends/cuda_util.h"
 #endif
 
+#include "cinn/runtime/cinn_runtime.h"
+
+DECLARE_bool(cinn_x86_caching_allocator);
+
 namespace cinn {
 namespace hlir {
 namespace framework {
@@ -39,6 +53,228 @@ class X86MemoryMng : public MemoryInterface {
   void* aligned_alloc(size_t alignment, size_t nbytes) override { return ::aligned_alloc(alignment, nbytes); }
 };
 
+/**
+ * X86CachingMemoryMng caches the freed blocks in free lists of size classes instead of returning them to the
+ * system, and serves the later allocations of the same size class with them. There are four size classes in each
+ * power of two, so a block wastes less than a quarter of its size.
+ *
+ * Each thread keeps a few small blocks of every size class in its own cache, which is guarded by a lock of its own
+ * and rarely contended. The other blocks go to the free lists shared by all threads, and blocks larger than the
+ * largest size class are allocated from the system directly. Trim releases the blocks cached by all threads.
+ *
+ * The instance should live as long as the process, as the MemoryManager holding it does, since the thread caches
+ * return their blocks to it when threads exit.
+ */
+class X86CachingMemoryMng : public MemoryInterface {
+ public:
+  X86CachingMemoryMng();
+  ~X86CachingMemoryMng() { Trim(); }
+
+  void* malloc(size_t nbytes) override { return aligned_alloc(alignof(std::max_align_t), nbytes); }
+  void free(void* data) override;
+  void* aligned_alloc(size_t alignment, size_t nbytes) override;
+
+  void Trim() override;
+  MemoryStats GetStats() const override;
+
+  // the blocks cached by a thread, locked by the thread itself on each allocation and by Trim
+  struct ThreadCache {
+    std::mutex mtx;
+    std::vector<std::vector<void*>> blocks;
+  };
+
+  // return the blocks of a thread cache to the shared free lists and forget the cache, called when the thread exits
+  void ReleaseThreadCache(ThreadCache* thread_cache);
+
+ private:
+  // placed right before the memory returned to users
+  struct BlockHeader {
+    void* base;
+    size_t size;
+    // -1 means the block is allocated from the system directly
+    int size_class;
+  };
+
+  // the blocks no larger than it are cached in the thread caches
+  static constexpr size_t kMaxThreadCachedSize = 1UL << 20;
+  // the number of blocks of each size class in a thread cache
+  static constexpr size_t kThreadCacheCapacity = 4;
+
+  int SizeClass(size_t nbytes) const;
+  ThreadCache* GetThreadCache();
+  // move the blocks of a thread cache to the shared free lists, mtx_ should be held
+  void FlushThreadCache(ThreadCache* thread_cache);
+  void UpdatePeak(size_t bytes_in_use);
+
+  std::vector<size_t> class_sizes_;
+  // guards the free lists and the set of thread caches, acquired before the lock of any thread cache
+  std::mutex mtx_;
+  std::vector<std::vector<void*>> free_lists_;
+  std::unordered_set<ThreadCache*> thread_caches_;
+
+  std::atomic<size_t> bytes_in_use_{0};
+  std::atomic<size_t> bytes_cached_{0};
+  std::atomic<size_t> peak_bytes_in_use_{0};
+  std::atomic<size_t> num_allocs_{0};
+  std::atomic<size_t> num_cache_hits_{0};
+};
+
+// the per-thread caches of all the X86CachingMemoryMng instances
+struct ThreadCaches {
+  ~ThreadCaches() {
+    for (auto& mng2cache : caches) {
+      mng2cache.first->ReleaseThreadCache(&mng2cache.second);
+    }
+  }
+
+  std::unordered_map<X86CachingMemoryMng*, X86CachingMemoryMng::ThreadCache> caches;
+};
+
+X86CachingMemoryMng::X86CachingMemoryMng() {
+  // 256B, 320B, 384B, 448B, 512B, ..., 1.75GB
+  for (size_t base = 256; base <= (1UL << 30); base <<= 1) {
+    for (size_t quarter = 4; quarter < 8; ++quarter) {
+      class_sizes_.push_back(base / 4 * quarter);
+    }
+  }
+  free_lists_.resize(class_sizes_.size());
+}
+
+int X86CachingMemoryMng::SizeClass(size_t nbytes) const {
+  auto it = std::lower_bound(class_sizes_.begin(), class_sizes_.end(), nbytes);
+  return it == class_sizes_.end() ? -1 : static_cast<int>(it - class_sizes_.begin());
+}
+
+X86CachingMemoryMng::ThreadCache* X86CachingMemoryMng::GetThreadCache() {
+  static thread_local ThreadCaches thread_caches;
+  auto& cache = thread_caches.caches[this];
+  if (cache.blocks.empty()) {
+    cache.blocks.resize(class_sizes_.size());
+    std::lock_guard<std::mutex> lock(mtx_);
+    thread_caches_.insert(&cache);
+  }
+  return &cache;
+}
+
+void X86CachingMemoryMng::UpdatePeak(size_t bytes_in_use) {
+  size_t peak = peak_bytes_in_use_.load(std::memory_order_relaxed);
+  while (bytes_in_use > peak && !peak_bytes_in_use_.compare_exchange_weak(peak, bytes_in_use)) {
+  }
+}
+
+void* X86CachingMemoryMng::aligned_alloc(size_t alignment, size_t nbytes) {
+  alignment = std::max(alignment, alignof(std::max_align_t));
+  CHECK_EQ(alignment & (alignment - 1), 0) << "The alignment should be a power of two";
+  // the base returned by ::malloc is aligned to max_align_t, reserve the space to align it and hold the header
+  size_t required = nbytes + sizeof(BlockHeader) + alignment;
+  int size_class  = SizeClass(required);
+  size_t size     = size_class < 0 ? required : class_sizes_[size_class];
+
+  void* base = nullptr;
+  if (size_class >= 0) {
+    if (size <= kMaxThreadCachedSize) {
+      auto* thread_cache = GetThreadCache();
+      std::lock_guard<std::mutex> lock(thread_cache->mtx);
+      auto& blocks = thread_cache->blocks[size_class];
+      if (!blocks.empty()) {
+        base = blocks.back();
+        blocks.pop_back();
+      }
+    }
+    if (!base) {
+      std::lock_guard<std::mutex> lock(mtx_);
+      auto& blocks = free_lists_[size_class];
+      if (!blocks.empty()) {
+        base = blocks.back();
+        blocks.pop_back();
+      }
+    }
+    if (base) {
+      bytes_cached_.fetch_sub(size, std::memory_order_relaxed);
+      num_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  if (!base) {
+    base = ::malloc(size);
+    if (!base) return nullptr;
+  }
+  num_allocs_.fetch_add(1, std::memory_order_relaxed);
+  UpdatePeak(bytes_in_use_.fetch_add(size, std::memory_order_relaxed) + size);
+
+  uintptr_t data     = reinterpret_cast<uintptr_t>(base) + sizeof(BlockHeader);
+  data               = (data + alignment - 1) / alignment * alignment;
+  auto* header       = reinterpret_cast<BlockHeader*>(data) - 1;
+  header->base       = base;
+  header->size       = size;
+  header->size_class = size_class;
+  return reinterpret_cast<void*>(data);
+}
+
+void X86CachingMemoryMng::free(void* data) {
+  if (!data) return;
+  auto* header   = reinterpret_cast<BlockHeader*>(data) - 1;
+  void* base     = header->base;
+  size_t size    = header->size;
+  int size_class = header->size_class;
+  bytes_in_use_.fetch_sub(size, std::memory_order_relaxed);
+  if (size_class < 0) {
+    ::free(base);
+    return;
+  }
+
+  bytes_cached_.fetch_add(size, std::memory_order_relaxed);
+  if (size <= kMaxThreadCachedSize) {
+    auto* thread_cache = GetThreadCache();
+    std::lock_guard<std::mutex> lock(thread_cache->mtx);
+    auto& blocks = thread_cache->blocks[size_class];
+    if (blocks.size() < kThreadCacheCapacity) {
+      blocks.push_back(base);
+      return;
+    }
+  }
+  std::lock_guard<std::mutex> lock(mtx_);
+  free_lists_[size_class].push_back(base);
+}
+
+void X86CachingMemoryMng::FlushThreadCache(ThreadCache* thread_cache) {
+  std::lock_guard<std::mutex> lock(thread_cache->mtx);
+  for (int i = 0; i < thread_cache->blocks.size(); ++i) {
+    auto& blocks = thread_cache->blocks[i];
+    free_lists_[i].insert(free_lists_[i].end(), blocks.begin(), blocks.end());
+    blocks.clear();
+  }
+}
+
+void X86CachingMemoryMng::ReleaseThreadCache(ThreadCache* thread_cache) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  FlushThreadCache(thread_cache);
+  thread_caches_.erase(thread_cache);
+}
+
+void X86CachingMemoryMng::Trim() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (auto* thread_cache : thread_caches_) {
+    FlushThreadCache(thread_cache);
+  }
+  for (int i = 0; i < free_lists_.size(); ++i) {
+    for (void* base : free_lists_[i]) {
+      ::free(base);
+    }
+    bytes_cached_.fetch_sub(class_sizes_[i] * free_lists_[i].size(), std::memory_order_relaxed);
+    free_lists_[i].clear();
+  }
+}
+
+MemoryStats X86CachingMemoryMng::GetStats() const {
+  MemoryStats stats;
+  stats.bytes_in_use      = bytes_in_use_.load(std::memory_order_relaxed);
+  stats.bytes_cached      = bytes_cached_.load(std::memory_order_relaxed);
+  stats.peak_bytes_in_use = peak_bytes_in_use_.load(std::memory_order_relaxed);
+  stats.num_allocs        = num_allocs_.load(std::memory_order_relaxed);
+  stats.num_cache_hits    = num_cache_hits_.load(std::memory_order_relaxed);
+  return stats;
+}
+
 #ifdef CINN_WITH_CUDA
 class CudaMemoryMng : public MemoryInterface {
  public:
@@ -53,11 +289,30 @@ class CudaMemoryMng : public MemoryInterface {
 
 #endif
 
+// the allocator of the runtime functions, such as cinn_buffer_malloc called by kernels, which allocates the host
+// memory by the same MemoryInterface as Buffer, so either side can free the memory of the other
+void* X86HostAlloc(size_t alignment, size_t size) {
+  auto* mng = MemoryManager::Global().RetrieveSafely(Target::Arch::X86);
+  return alignment ? mng->aligned_alloc(alignment, size) : mng->malloc(size);
+}
+
+void X86HostFree(void* data) { MemoryManager::Global().RetrieveSafely(Target::Arch::X86)->free(data); }
+
+// installed when the library is loaded, before any host memory is allocated
+const bool x86_host_allocator_installed = []() {
+  cinn_set_host_allocator({&X86HostAlloc, &X86HostFree});
+  return true;
+}();
+
 }  // namespace
 
 MemoryManager::MemoryManager() {
   Register(Target::Arch::Unk, new X86MemoryMng);
-  Register(Target::Arch::X86, new X86MemoryMng);
+  if (FLAGS_cinn_x86_caching_allocator) {
+    Register(Target::Arch::X86, new X86CachingMemoryMng);
+  } else {
+    Register(Target::Arch::X86, new X86MemoryMng);
+  }
 #ifdef CINN_WITH_CUDA
   Register(Target::Arch::NVGPU, new CudaMemoryMng);
 #endif
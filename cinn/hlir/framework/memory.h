@@ -26,11 +26,31 @@ namespace cinn {
 namespace hlir {
 namespace framework {
 
+/**
+ * The counters of a MemoryInterface, all the sizes are in bytes.
+ */
+struct MemoryStats {
+  // the memory held by the allocated blocks
+  size_t bytes_in_use{0};
+  // the memory of freed blocks cached for reuse
+  size_t bytes_cached{0};
+  // the maximum of bytes_in_use
+  size_t peak_bytes_in_use{0};
+  // the number of allocations, and how many of them are served by the cached blocks
+  size_t num_allocs{0};
+  size_t num_cache_hits{0};
+
+  double hit_rate() const { return num_allocs ? static_cast<double>(num_cache_hits) / num_allocs : 0.0; }
+};
+
 class MemoryInterface {
  public:
   virtual void* malloc(size_t nbytes) = 0;
   virtual void free(void* data)       = 0;
   virtual void* aligned_alloc(size_t alignment, size_t nbytes) { return nullptr; }
+  // release the cached memory back to the system, it only works for the caching implementations
+  virtual void Trim() {}
+  virtual MemoryStats GetStats() const { return MemoryStats(); }
   virtual ~MemoryInterface() {}
 };
 
@@ -0,0 +1,87 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/hlir/framework/memory_planner.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+void MemoryPlanner::AddVariable(const std::string& name, size_t size, int first_step, int last_step) {
+  CHECK_LE(first_step, last_step) << "The lifetime of variable " << name << " is invalid";
+  size_t aligned_size = (size + alignment_ - 1) / alignment_ * alignment_;
+  variables_.push_back({name, aligned_size, first_step, last_step});
+}
+
+MemoryPlanner::Plan MemoryPlanner::Solve() const {
+  std::vector<int> order(variables_.size());
+  for (int i = 0; i < order.size(); ++i) order[i] = i;
+  // place the larger variables first, and the earlier one when the sizes are equal to make the plan stable
+  std::sort(order.begin(), order.end(), [this](int a, int b) {
+    if (variables_[a].size != variables_[b].size) return variables_[a].size > variables_[b].size;
+    if (variables_[a].first_step != variables_[b].first_step) {
+      return variables_[a].first_step < variables_[b].first_step;
+    }
+    return a < b;
+  });
+
+  Plan plan;
+  std::vector<int> placed;
+  std::vector<size_t> offsets(variables_.size(), 0);
+  for (int idx : order) {
+    const auto& var = variables_[idx];
+    plan.naive_size += var.size;
+
+    // the memory ranges of placed variables alive at the same time, sorted by offset
+    std::vector<std::pair<size_t, size_t>> occupied;
+    for (int other : placed) {
+      const auto& other_var = variables_[other];
+      if (other_var.last_step < var.first_step || var.last_step < other_var.first_step) continue;
+      occupied.emplace_back(offsets[other], offsets[other] + other_var.size);
+    }
+    std::sort(occupied.begin(), occupied.end());
+
+    size_t best_offset = std::numeric_limits<size_t>::max();
+    size_t best_gap    = std::numeric_limits<size_t>::max();
+    size_t cursor      = 0;
+    for (auto& range : occupied) {
+      if (range.first > cursor) {
+        size_t gap = range.first - cursor;
+        if (gap >= var.size && gap < best_gap) {
+          best_gap    = gap;
+          best_offset = cursor;
+        }
+      }
+      cursor = std::max(cursor, range.second);
+    }
+    if (best_offset == std::numeric_limits<size_t>::max()) {
+      best_offset = cursor;
+    }
+
+    offsets[idx] = best_offset;
+    placed.push_back(idx);
+    plan.offsets[var.name] = best_offset;
+    plan.arena_size        = std::max(plan.arena_size, best_offset + var.size);
+  }
+  return plan;
+}
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
@@ -0,0 +1,66 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <absl/container/flat_hash_map.h>
+
+#include <string>
+#include <vector>
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+/**
+ * MemoryPlanner assigns every variable a fixed offset inside one arena, such that the variables whose lifetimes
+ * overlap never share memory. The lifetime of a variable is the closed interval of steps from the first to the
+ * last instruction using it.
+ *
+ * The variables are placed by best-fit in the decreasing order of size: each variable takes the smallest gap
+ * between the variables already placed and alive at the same time which is large enough to hold it, or is
+ * appended to the end of the highest of them.
+ */
+class MemoryPlanner {
+ public:
+  struct Plan {
+    // the offset in bytes of each variable inside the arena
+    absl::flat_hash_map<std::string, size_t> offsets;
+    // the number of bytes of the arena
+    size_t arena_size{0};
+    // the number of bytes if every variable is allocated separately
+    size_t naive_size{0};
+  };
+
+  explicit MemoryPlanner(size_t alignment) : alignment_(alignment) {}
+
+  void AddVariable(const std::string& name, size_t size, int first_step, int last_step);
+
+  Plan Solve() const;
+
+ private:
+  struct Variable {
+    std::string name;
+    size_t size;
+    int first_step;
+    int last_step;
+  };
+
+  size_t alignment_;
+  std::vector<Variable> variables_;
+};
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
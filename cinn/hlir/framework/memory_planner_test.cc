@@ -0,0 +1,84 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/hlir/framework/memory_planner.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+TEST(MemoryPlanner, Chain) {
+  // a -> b -> c -> d, every variable is only alive with its neighbours
+  MemoryPlanner planner(64);
+  planner.AddVariable("a", 256, 0, 1);
+  planner.AddVariable("b", 128, 1, 2);
+  planner.AddVariable("c", 256, 2, 3);
+  planner.AddVariable("d", 100, 3, 4);
+  auto plan = planner.Solve();
+
+  ASSERT_EQ(plan.offsets.size(), 4UL);
+  EXPECT_EQ(plan.naive_size, 256 + 128 + 256 + 128);
+  // a and c are never alive at the same time, so do b and d
+  EXPECT_EQ(plan.offsets.at("a"), plan.offsets.at("c"));
+  EXPECT_EQ(plan.offsets.at("b"), plan.offsets.at("d"));
+  EXPECT_EQ(plan.arena_size, 256 + 128);
+}
+
+TEST(MemoryPlanner, NoOverlap) {
+  struct Var {
+    std::string name;
+    size_t size;
+    int first_step;
+    int last_step;
+  };
+  std::vector<Var> vars = {{"x0", 1000, 0, 5},
+                           {"x1", 64, 1, 2},
+                           {"x2", 4096, 2, 3},
+                           {"x3", 512, 3, 7},
+                           {"x4", 200, 4, 4},
+                           {"x5", 4096, 5, 8},
+                           {"x6", 64, 6, 8},
+                           {"x7", 3000, 8, 9}};
+  const size_t alignment = 128;
+  MemoryPlanner planner(alignment);
+  for (auto& var : vars) {
+    planner.AddVariable(var.name, var.size, var.first_step, var.last_step);
+  }
+  auto plan = planner.Solve();
+
+  ASSERT_EQ(plan.offsets.size(), vars.size());
+  EXPECT_LE(plan.arena_size, plan.naive_size);
+  for (int i = 0; i < vars.size(); ++i) {
+    auto begin_i = plan.offsets.at(vars[i].name);
+    auto end_i   = begin_i + vars[i].size;
+    EXPECT_EQ(begin_i % alignment, 0UL);
+    EXPECT_LE(end_i, plan.arena_size);
+    for (int j = i + 1; j < vars.size(); ++j) {
+      if (vars[i].last_step < vars[j].first_step || vars[j].last_step < vars[i].first_step) continue;
+      auto begin_j = plan.offsets.at(vars[j].name);
+      auto end_j   = begin_j + vars[j].size;
+      EXPECT_TRUE(end_i <= begin_j || end_j <= begin_i)
+          << vars[i].name << " and " << vars[j].name << " are alive at the same time but overlap";
+    }
+  }
+}
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
@@ -0,0 +1,129 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/hlir/framework/memory.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "cinn/runtime/cinn_runtime.h"
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+TEST(X86CachingMemoryMng, ReuseAndTrim) {
+  auto* memory_mng = MemoryManager::Global().RetrieveSafely(common::Target::Arch::X86);
+  memory_mng->Trim();
+  auto before = memory_mng->GetStats();
+
+  void* data = memory_mng->aligned_alloc(1024, 4000);
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % 1024, 0UL);
+  auto allocated = memory_mng->GetStats();
+  EXPECT_EQ(allocated.num_allocs, before.num_allocs + 1);
+  EXPECT_GE(allocated.bytes_in_use, before.bytes_in_use + 4000);
+  EXPECT_GE(allocated.peak_bytes_in_use, allocated.bytes_in_use);
+
+  memory_mng->free(data);
+  auto freed = memory_mng->GetStats();
+  EXPECT_EQ(freed.bytes_in_use, before.bytes_in_use);
+  EXPECT_GT(freed.bytes_cached, before.bytes_cached);
+
+  // a block of the same size class is served from the cache
+  void* reused = memory_mng->aligned_alloc(1024, 3900);
+  EXPECT_EQ(reused, data);
+  EXPECT_EQ(memory_mng->GetStats().num_cache_hits, before.num_cache_hits + 1);
+  EXPECT_GT(memory_mng->GetStats().hit_rate(), 0.0);
+  memory_mng->free(reused);
+
+  memory_mng->Trim();
+  EXPECT_EQ(memory_mng->GetStats().bytes_cached, 0UL);
+}
+
+TEST(X86CachingMemoryMng, MultiThreads) {
+  auto* memory_mng = MemoryManager::Global().RetrieveSafely(common::Target::Arch::X86);
+  auto before      = memory_mng->GetStats();
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.emplace_back([memory_mng, tid]() {
+      for (int i = 0; i < 1000; ++i) {
+        size_t nbytes = 64 << ((i + tid) % 16);
+        auto* data    = static_cast<char*>(memory_mng->malloc(nbytes));
+        ASSERT_NE(data, nullptr);
+        data[0]          = 1;
+        data[nbytes - 1] = 1;
+        memory_mng->free(data);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // the thread caches are returned to the shared free lists when threads exit
+  auto after = memory_mng->GetStats();
+  EXPECT_EQ(after.bytes_in_use, before.bytes_in_use);
+  EXPECT_EQ(after.num_allocs, before.num_allocs + 4000);
+  EXPECT_GT(after.num_cache_hits, before.num_cache_hits);
+  memory_mng->Trim();
+  EXPECT_EQ(memory_mng->GetStats().bytes_cached, 0UL);
+}
+
+TEST(X86CachingMemoryMng, TrimOtherThreads) {
+  auto* memory_mng = MemoryManager::Global().RetrieveSafely(common::Target::Arch::X86);
+  memory_mng->Trim();
+
+  // the block freed by the worker stays in its thread cache while it is alive
+  std::promise<void> freed, trimmed;
+  std::thread worker([&]() {
+    memory_mng->free(memory_mng->malloc(1000));
+    freed.set_value();
+    trimmed.get_future().wait();
+  });
+  freed.get_future().wait();
+  EXPECT_GT(memory_mng->GetStats().bytes_cached, 0UL);
+  memory_mng->Trim();
+  EXPECT_EQ(memory_mng->GetStats().bytes_cached, 0UL);
+  trimmed.set_value();
+  worker.join();
+}
+
+TEST(X86CachingMemoryMng, SharedWithRuntime) {
+  auto* memory_mng = MemoryManager::Global().RetrieveSafely(common::Target::Arch::X86);
+  auto before      = memory_mng->GetStats();
+
+  // the memory allocated by the runtime functions of kernels and by the framework is freed by the other side
+  void* data = cinn_host_alloc(64, 1000);
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % 64, 0UL);
+  EXPECT_EQ(memory_mng->GetStats().num_allocs, before.num_allocs + 1);
+  memory_mng->free(data);
+
+  cinn_buffer_t buffer;
+  buffer.memory      = static_cast<uint8_t*>(memory_mng->aligned_alloc(1024, 1000));
+  buffer.memory_size = 1000;
+  cinn_x86_device_interface()->impl->free(nullptr, &buffer);
+  EXPECT_EQ(buffer.memory, nullptr);
+  EXPECT_EQ(memory_mng->GetStats().bytes_in_use, before.bytes_in_use);
+}
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
@@ -16,19 +16,30 @@
 
 #include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "cinn/backends/codegen_cuda_dev.h"
 #include "cinn/backends/codegen_cuda_host.h"
 #include "cinn/backends/codegen_cuda_util.h"
 #include "cinn/backends/compiler.h"
 #include "cinn/backends/llvm/codegen_x86.h"
+#include "cinn/backends/llvm/object_cache.h"
 #include "cinn/backends/llvm/runtime_symbol_registry.h"
 #include "cinn/backends/nvrtc/nvrtc_util.h"
 #include "cinn/common/context.h"
+#include "cinn/hlir/framework/kernel_cost.h"
 #include "cinn/hlir/framework/pass.h"
 #include "cinn/ir/module.h"
+#include "cinn/utils/event.h"
+#include "cinn/utils/multi_threading.h"
+#include "cinn/utils/profiler.h"
+#include "cinn/utils/timer.h"
 
+DECLARE_bool(cinn_deduplicate_groups);
+DECLARE_string(cinn_llvm_object_cache_dir);
 DECLARE_int32(cinn_parallel_compile_size);
 DECLARE_int32(cinn_parallel_compile_thread);
 
@@ -41,6 +52,16 @@ std::vector<std::unique_ptr<Instruction>> ParallelCompiler::operator()() {
   if (graph_->fusion_groups.size() == 0) {
     hlir::framework::ApplyPasses(graph_.get(), {"BuildNonFusedGroupsPass"});
   }
+  DeduplicateGroups();
+  if (option_.lazy_compile) {
+    LaunchLazyTask();
+    auto res = MergeResult();
+    // started after merging, as the groups compiled on a fallback add their lazy functions
+    if (option_.lazy_compile_prefetch) {
+      prefetcher_ = std::thread(&ParallelCompiler::PrefetchLazyFunctions, this);
+    }
+    return res;
+  }
   // Task Spilt
   SplitTask();
   // launch task
@@ -64,49 +85,254 @@ OpPatternKind GetOpKind(const framework::Node* node) {
   return kind;
 }
 
+void ParallelCompiler::DeduplicateGroups() {
+  int num_groups = graph_->fusion_groups.size();
+  representatives_.resize(num_groups);
+  task_of_group_.assign(num_groups, -1);
+  slot_of_group_.assign(num_groups, -1);
+  // the given lowered functions are not deduplicated, as their groups may be scheduled differently
+  bool deduplicate = FLAGS_cinn_deduplicate_groups && option_.lowered_funcs.empty();
+  if (deduplicate) {
+    group_vars_.resize(num_groups);
+  }
+  // the groups compiled on a fallback are added as tasks later, which must not move the tasks captured by the lazy
+  // functions
+  tasks_.reserve(num_groups);
+
+  // the function of the representative is called with the variables at the same positions of the duplicate, so
+  // all the arguments of the representative have to be numbered by the key
+  auto maps_arguments = [this](int rep_idx, int idx) {
+    if (group_vars_[rep_idx].size() != group_vars_[idx].size()) {
+      return false;
+    }
+    std::unordered_set<std::string> vars(group_vars_[rep_idx].begin(), group_vars_[rep_idx].end());
+    auto numbered = [&](const Node* node, bool inputs) {
+      for (auto& link : inputs ? node->inlinks_in_order() : node->outlinks_in_order()) {
+        auto* var = (inputs ? link->source() : link->sink())->safe_as<NodeData>();
+        if (!var || !vars.count(var->id())) {
+          return false;
+        }
+      }
+      return true;
+    };
+    auto& rep_group = graph_->fusion_groups[rep_idx];
+    for (auto* node : rep_group->CollectNodes()) {
+      if (!numbered(node, true)) return false;
+    }
+    for (auto* node : rep_group->output_nodes) {
+      if (!numbered(node, false)) return false;
+    }
+    return true;
+  };
+
+  std::unordered_map<std::string, int> key_to_group;
+  for (int idx = 0; idx < num_groups; ++idx) {
+    representatives_[idx] = idx;
+    if (deduplicate) {
+      auto key     = graph_->GroupStructuralKey(graph_->fusion_groups[idx], &group_vars_[idx]);
+      auto rep_idx = key_to_group.emplace(key, idx).first->second;
+      if (rep_idx != idx && maps_arguments(rep_idx, idx)) {
+        representatives_[idx] = rep_idx;
+      } else if (rep_idx != idx) {
+        VLOG(3) << "Group " << idx << " is compiled itself, as the arguments of group " << rep_idx
+                << " can't be mapped to it";
+      }
+    }
+    if (representatives_[idx] == idx) {
+      unique_groups_.push_back(idx);
+    } else {
+      VLOG(3) << "Group " << idx << " is structurally identical to group " << representatives_[idx];
+    }
+  }
+  stats_.num_deduplicated_groups = num_groups - unique_groups_.size();
+  VLOG(2) << "Compile " << unique_groups_.size() << " of " << num_groups << " groups after deduplication";
+}
+
 void ParallelCompiler::SplitTask() {
   CHECK(graph_->fusion_groups.size());
   CHECK(graph_->fusion_groups.size() == option_.lowered_funcs.size() || option_.lowered_funcs.size() == 0);
-  // split task
-  int max_task_num =
-      FLAGS_cinn_parallel_compile_thread > 0 ? FLAGS_cinn_parallel_compile_thread : graph_->fusion_groups.size();
-
-  int group_per_task = graph_->fusion_groups.size();
-  if (max_task_num > 1) {
-    group_per_task = FLAGS_cinn_parallel_compile_size > 0
-                         ? FLAGS_cinn_parallel_compile_size
-                         : ((graph_->fusion_groups.size() + max_task_num - 1) / max_task_num);
+  int num_groups = unique_groups_.size();
+  num_threads_   = FLAGS_cinn_parallel_compile_thread > 0 ? FLAGS_cinn_parallel_compile_thread
+                                                          : std::max<int>(std::thread::hardware_concurrency(), 1);
+  // the thread budget set on the calling thread by runtime::cpu::ScopedThreadConfig
+  if (FLAGS_cinn_parallel_compile_thread <= 0 && utils::GetThreadLocalMaxThreads() > 0) {
+    num_threads_ = utils::GetThreadLocalMaxThreads();
   }
+  num_threads_ = std::min(num_threads_, num_groups);
 
-  for (int idx = 0; idx < graph_->fusion_groups.size(); idx += group_per_task) {
-    tasks_.emplace_back(this, scope_, graph_, option_, target_);
+  // split task, several tasks for each thread by default so that they can be balanced by stealing
+  int group_per_task = FLAGS_cinn_parallel_compile_size > 0
+                           ? FLAGS_cinn_parallel_compile_size
+                           : std::max((num_groups + num_threads_ * 4 - 1) / (num_threads_ * 4), 1);
+  for (int idx = 0; idx < num_groups; idx += group_per_task) {
+    AddTask(std::vector<int>(unique_groups_.begin() + idx,
+                             unique_groups_.begin() + std::min(idx + group_per_task, num_groups)));
   }
-  VLOG(2) << "Split task to " << tasks_.size() << " sub-task!";
+  VLOG(2) << "Split task to " << tasks_.size() << " sub-task, compiled by " << num_threads_ << " threads!";
 }
 
-void RunTask(ParallelCompiler::Task* task) {
-  VLOG(2) << "Stark run sub-task, Thread Id : " << std::this_thread::get_id();
-  VLOG(4) << "Start Lowering";
-  task->Lowering();
-  VLOG(4) << "Start CodegenAndJit";
-  task->CodegenAndJit();
-  VLOG(4) << "Start BuildInstruction";
-  task->BuildInstruction();
-  VLOG(2) << "Finish run sub-task, Thread Id : " << std::this_thread::get_id();
+void ParallelCompiler::AddTask(const std::vector<int>& groups) {
+  tasks_.emplace_back(this, scope_, graph_, option_, target_);
+  auto& task = tasks_.back();
+  for (int idx : groups) {
+    task_of_group_[idx] = tasks_.size() - 1;
+    slot_of_group_[idx] = task.gidx.size();
+    task.gidx.push_back(idx);
+  }
+  task.lowered_funcs.resize(task.gidx.size());
+  remaining_groups_.push_back(task.gidx.size());
 }
 
 void ParallelCompiler::LaunchTask() {
+  utils::Timer timer;
+  timer.Start();
+  ready_tasks_.resize(num_threads_);
   // start sub-task.
   std::vector<std::thread> threads;
-  for (int idx = 1; idx < tasks_.size(); ++idx) {
-    threads.emplace_back(RunTask, &tasks_[idx]);
+  for (int idx = 1; idx < num_threads_; ++idx) {
+    threads.emplace_back(&ParallelCompiler::RunWorker, this, idx);
   }
 
-  RunTask(&tasks_[0]);
+  RunWorker(0);
   // syncthreads.
   for (auto& worker : threads) {
     worker.join();
   }
+  stats_.num_threads = num_threads_;
+  stats_.num_tasks   = tasks_.size();
+  stats_.wall_ms     = timer.Stop();
+  VLOG(1) << "Parallel compile " << graph_->fusion_groups.size() << " groups: " << stats_.ToString();
+  if (!FLAGS_cinn_llvm_object_cache_dir.empty()) {
+    VLOG(1) << "LLVM object cache of the process: " << backends::DiskObjectCache::GetStats().ToString();
+  }
+}
+
+void ParallelCompiler::RunWorker(int worker_id) {
+  VLOG(2) << "Start run worker " << worker_id << ", Thread Id : " << std::this_thread::get_id();
+  Stats stats;
+  utils::Timer timer;
+  while (true) {
+    int task_idx = -1, group_idx = -1;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      timer.Start();
+      while (true) {
+        // the tasks queued by itself first, whose groups are just lowered
+        if (!ready_tasks_[worker_id].empty()) {
+          task_idx = ready_tasks_[worker_id].front();
+          ready_tasks_[worker_id].pop_front();
+          break;
+        }
+        if (index < unique_groups_.size()) {
+          group_idx = unique_groups_[index++];
+          break;
+        }
+        // steal the task queued last by another thread
+        for (int i = 1; i < num_threads_ && task_idx < 0; ++i) {
+          auto& queue = ready_tasks_[(worker_id + i) % num_threads_];
+          if (!queue.empty()) {
+            task_idx = queue.back();
+            queue.pop_back();
+            ++stats.num_steals;
+          }
+        }
+        if (task_idx >= 0 || num_finished_tasks_ == tasks_.size()) {
+          break;
+        }
+        cv_.wait(lock);
+      }
+      stats.idle_ms += timer.Stop();
+    }
+    if (task_idx < 0 && group_idx < 0) {
+      break;
+    }
+
+    if (group_idx >= 0) {
+      int owner  = task_of_group_[group_idx];
+      auto& task = tasks_[owner];
+      timer.Start();
+      task.LowerGroup(slot_of_group_[group_idx]);
+      stats.lowering_ms += timer.Stop();
+
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (--remaining_groups_[owner] == 0) {
+        ready_tasks_[worker_id].push_back(owner);
+        cv_.notify_all();
+      }
+      continue;
+    }
+
+    auto& task = tasks_[task_idx];
+    timer.Start();
+    task.CodegenAndJit();
+    stats.codegen_ms += timer.Stop();
+    timer.Start();
+    task.BuildInstruction();
+    stats.build_instruction_ms += timer.Stop();
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++num_finished_tasks_;
+    cv_.notify_all();
+  }
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  stats_.num_steals += stats.num_steals;
+  stats_.lowering_ms += stats.lowering_ms;
+  stats_.codegen_ms += stats.codegen_ms;
+  stats_.build_instruction_ms += stats.build_instruction_ms;
+  stats_.idle_ms += stats.idle_ms;
+  VLOG(2) << "Finish run worker " << worker_id << ", Thread Id : " << std::this_thread::get_id();
+}
+
+std::string ParallelCompiler::Stats::ToString() const {
+  std::stringstream ss;
+  ss << num_tasks << " tasks by " << num_threads << " threads in " << wall_ms << " ms, lowering: " << lowering_ms
+     << " ms, codegen and jit: " << codegen_ms << " ms, build instruction: " << build_instruction_ms
+     << " ms, idle: " << idle_ms << " ms, steals: " << num_steals
+     << ", deduplicated groups: " << num_deduplicated_groups;
+  return ss.str();
+}
+
+ParallelCompiler::~ParallelCompiler() {
+  stop_prefetch_ = true;
+  if (prefetcher_.joinable()) {
+    prefetcher_.join();
+  }
+}
+
+void ParallelCompiler::LaunchLazyTask() {
+  CHECK(graph_->fusion_groups.size() == option_.lowered_funcs.size() || option_.lowered_funcs.size() == 0);
+  int num_groups = unique_groups_.size();
+  for (int idx : unique_groups_) {
+    AddTask({idx});
+  }
+  VLOG(2) << "Lower " << num_groups << " groups and compile them lazily";
+
+  // the lowering is still done ahead, as the arguments of the instructions are decided by it
+  utils::parallel_run(
+      [this](int idx) { tasks_[idx].LowerGroup(0); },
+      utils::SequenceDispatcher(0, num_groups),
+      FLAGS_cinn_parallel_compile_thread > 0 ? FLAGS_cinn_parallel_compile_thread : -1);
+
+  for (auto& task : tasks_) {
+    task.BuildLazyInstruction();
+    lazy_functions_.push_back(task.lazy_function);
+  }
+}
+
+void ParallelCompiler::PrefetchLazyFunctions() {
+  for (auto& fn : lazy_functions_) {
+    if (stop_prefetch_) {
+      return;
+    }
+    fn->Get();
+  }
+}
+
+void ParallelCompiler::CompileLazyFunctions() {
+  for (auto& fn : lazy_functions_) {
+    fn->Get();
+  }
 }
 
 std::vector<std::unique_ptr<Instruction>> ParallelCompiler::MergeResult() {
@@ -116,35 +342,99 @@ std::vector<std::unique_ptr<Instruction>> ParallelCompiler::MergeResult() {
       res[task.gidx[idx]] = std::move(task.instructions[idx]);
     }
   }
+  for (int idx = 0; idx < res.size(); ++idx) {
+    if (representatives_[idx] != idx) {
+      res[idx] = BuildDuplicateInstruction(idx);
+    }
+  }
   return std::move(res);
 }
 
-void ParallelCompiler::Task::Lowering() {
+std::unique_ptr<Instruction> ParallelCompiler::BuildDuplicateInstruction(int gidx) {
+  int rep_idx     = representatives_[gidx];
+  auto& rep_group = graph_->fusion_groups[rep_idx];
+  auto& group     = graph_->fusion_groups[gidx];
+  // the arguments of the shared function are the variables at the same positions of the group
+  std::unordered_map<std::string, std::string> var_map;
+  for (int i = 0; i < group_vars_[rep_idx].size(); ++i) {
+    var_map[group_vars_[rep_idx][i]] = group_vars_[gidx][i];
+  }
+  bool mapped    = true;
+  auto map_names = [&](const std::vector<std::string>& names) {
+    std::vector<std::string> res;
+    for (auto& name : names) {
+      if (!var_map.count(name)) {
+        LOG(WARNING) << "The argument " << name << " of group " << rep_idx << " is not a variable of group " << gidx
+                     << ", compile the group itself";
+        mapped = false;
+        break;
+      }
+      res.push_back(var_map.at(name));
+    }
+    return res;
+  };
+  auto input_names  = map_names(rep_group->input_names);
+  auto output_names = map_names(rep_group->output_names);
+  if (!mapped) {
+    return CompileGroup(gidx);
+  }
+  group->input_names  = std::move(input_names);
+  group->output_names = std::move(output_names);
+
+  auto instr = std::unique_ptr<Instruction>(
+      new Instruction(target_, scope_.get(), group->input_names, group->output_names, group->GetFuncName()));
+  auto& rep_task = tasks_[task_of_group_[rep_idx]];
+  auto rep_name  = rep_group->GetFuncName();
+  if (rep_task.lazy_function) {
+    instr->SetLazyLoweredFunc(rep_task.lazy_function, rep_name);
+  } else {
+    auto fn_ptr = rep_task.engine->Lookup(rep_name);
+    CHECK(fn_ptr) << "Can't find jit function : " << rep_name;
+    instr->SetLoweredFunc(reinterpret_cast<void*>(fn_ptr), rep_name);
+  }
+  instr->Finalize();
+
+  utils::KernelCost cost;
+  if (utils::KernelCostRegistry::Global().Find(rep_name, &cost)) {
+    utils::KernelCostRegistry::Global().Register(group->GetFuncName(), cost);
+  }
+  return instr;
+}
+
+std::unique_ptr<Instruction> ParallelCompiler::CompileGroup(int gidx) {
+  representatives_[gidx] = gidx;
+  --stats_.num_deduplicated_groups;
+  AddTask({gidx});
+  auto& task = tasks_.back();
+  task.LowerGroup(0);
+  if (option_.lazy_compile) {
+    task.BuildLazyInstruction();
+    lazy_functions_.push_back(task.lazy_function);
+  } else {
+    task.CodegenAndJit();
+    task.BuildInstruction();
+  }
+  return std::move(task.instructions[0]);
+}
+
+void ParallelCompiler::Task::LowerGroup(int i) {
+  int idx = gidx[i];
   if (options.lowered_funcs.size()) {
-    CHECK_EQ(options.lowered_funcs.size(), graph->fusion_groups.size());
+    lowered_funcs[i] = options.lowered_funcs[idx];
+    RegisterKernelCosts(lowered_funcs[i]);
+    return;
   }
   auto& dtype_dict = graph->GetMutableAttrs<absl::flat_hash_map<std::string, Type>>("inferdtype");
   auto& shape_dict = graph->GetMutableAttrs<absl::flat_hash_map<std::string, shape_t>>("infershape");
 
   OpLowerer op_lowerer(dtype_dict, shape_dict, target);
-  while (true) {
-    int idx = compiler->GetGroupIdx();
-    if (idx < 0) {
-      break;
-    }
-
-    gidx.push_back(idx);
-    if (options.lowered_funcs.size()) {
-      lowered_funcs.push_back(options.lowered_funcs[idx]);
-      continue;
-    }
-    auto& group = graph->fusion_groups[idx];
-    VLOG(1) << "Start Lowering Group " << idx << " at " << std::this_thread::get_id() << " :\n"
-            << "Group " << idx << " {\n"
-            << graph->DebugGroupedGraph(group->CollectNodes()) << "}\n";
-    lowered_funcs.emplace_back(std::move(op_lowerer.Lower(group)));
-    CHECK_EQ(lowered_funcs.back().size(), 1) << "Lowerd Function Is Not Equal 1!";
-  }
+  auto& group = graph->fusion_groups[idx];
+  VLOG(1) << "Start Lowering Group " << idx << " at " << std::this_thread::get_id() << " :\n"
+          << "Group " << idx << " {\n"
+          << graph->DebugGroupedGraph(group->CollectNodes()) << "}\n";
+  lowered_funcs[i] = op_lowerer.Lower(group);
+  CHECK_EQ(lowered_funcs[i].size(), 1) << "Lowerd Function Is Not Equal 1!";
+  RegisterKernelCosts(lowered_funcs[i]);
 }
 
 void ParallelCompiler::Task::CodegenAndJit() {
@@ -189,11 +479,11 @@ void ParallelCompiler::Task::CodegenAndJit() {
       CHECK(cufunc);
       symbols.RegisterVar(fn->name + "_ptr_", reinterpret_cast<void*>(cufunc));
     }
-    engine = backends::ExecutionEngine::Create(backends::ExecutionOptions(), std::move(symbols));
+    engine = backends::ExecutionEngine::Create(options.execution_options, std::move(symbols));
     engine->Link<backends::CodeGenCUDA_Host>(hmodule);
 #endif
   } else {
-    engine = backends::ExecutionEngine::Create(backends::ExecutionOptions());
+    engine = backends::ExecutionEngine::Create(options.execution_options);
     engine->Link<backends::CodeGenX86>(ir_module);
   }
 }
@@ -216,13 +506,25 @@ void ParallelCompiler::Task::BuildInstruction() {
   }
 }
 
-int ParallelCompiler::GetGroupIdx() {
-  std::lock_guard<std::mutex> lock(mtx_);
-  if (index < graph_->fusion_groups.size()) {
-    return index++;
-  } else {
-    return -1;
-  }
+void ParallelCompiler::Task::BuildLazyInstruction() {
+  CHECK_EQ(gidx.size(), 1) << "A lazy task should hold exactly one group";
+  auto& group = graph->fusion_groups[gidx[0]];
+  CHECK(group->input_names.size() > 0 || group->output_names.size() > 0);
+  auto instr = std::unique_ptr<Instruction>(
+      new Instruction(target, scope.get(), group->input_names, group->output_names, group->GetFuncName()));
+
+  auto func_name = group->GetFuncName();
+  lazy_function  = std::make_shared<LazyFunction>([this, func_name]() {
+    utils::RecordEvent record_event("ParallelCompiler::LazyCodegenAndJit", utils::EventType::kOrdinary);
+    CodegenAndJit();
+    auto fn_ptr = engine->Lookup(func_name);
+    CHECK(fn_ptr) << "Can't find jit function : " << func_name;
+    return reinterpret_cast<void*>(fn_ptr);
+  });
+  instr->SetLazyLoweredFunc(lazy_function, func_name);
+
+  instr->Finalize();
+  instructions.push_back(std::move(instr));
 }
 
 }  // namespace framework
@@ -13,7 +13,13 @@
 // limitations under the License.
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "cinn/backends/llvm/execution_engine.h"
@@ -29,10 +35,24 @@ namespace cinn {
 namespace hlir {
 namespace framework {
 
+/**
+ * ParallelCompiler compiles the fusion groups of a graph into instructions by a pool of threads.
+ *
+ * The groups are split into tasks of consecutive groups, and each task is compiled into one module. The threads
+ * lower the groups one by one in order, and the thread lowering the last group of a task queues the task for
+ * codegen and JIT on its own queue, so the codegen of a task overlaps the lowering of the next groups. A thread
+ * prefers the tasks in its own queue, then lowers the next group, and steals a task from the other queues once
+ * all the groups are lowered, so a heavy task does not leave the other threads idle.
+ */
 class ParallelCompiler {
  public:
   struct CompileOptions {
     std::vector<std::vector<ir::LoweredFunc>> lowered_funcs;
+    // lower the groups ahead, but codegen and JIT each group on the first run of its instruction
+    bool lazy_compile{false};
+    // compile the lazy groups in the background in the order of execution, so the first run stalls less
+    bool lazy_compile_prefetch{false};
+    backends::ExecutionOptions execution_options;
   };
 
  public:
@@ -41,13 +61,49 @@ class ParallelCompiler {
                             const CompileOptions& option,
                             const common::Target& target)
       : scope_(scope), graph_(graph), option_(option), target_(target) {}
-  ~ParallelCompiler() {}
+  ~ParallelCompiler();
   std::vector<std::unique_ptr<Instruction>> operator()();
 
+  // compile all the groups which are still lazy, it is a no-op unless lazy_compile is set
+  void CompileLazyFunctions();
+
+  // the time of each stage summed over the threads, in milliseconds
+  struct Stats {
+    int num_threads{0};
+    int num_tasks{0};
+    // the tasks compiled by a thread other than the one which lowered their last group
+    int num_steals{0};
+    // the groups sharing the function of a structurally identical group instead of being compiled
+    int num_deduplicated_groups{0};
+    double lowering_ms{0};
+    double codegen_ms{0};
+    double build_instruction_ms{0};
+    // the time spent waiting for the groups lowered by other threads
+    double idle_ms{0};
+    double wall_ms{0};
+
+    std::string ToString() const;
+  };
+  const Stats& GetStats() const { return stats_; }
+
+  // the group whose function is shared by the \p gidx-th group, which is itself if it is compiled
+  int GetRepresentativeGroup(int gidx) const { return representatives_[gidx]; }
+
  private:
+  // find the groups structurally identical to a preceding group, which are not compiled again
+  void DeduplicateGroups();
   void SplitTask();
+  void AddTask(const std::vector<int>& groups);
   void LaunchTask();
+  void RunWorker(int worker_id);
+  // lower each group by a task of its own, and leave the codegen and JIT to the first run
+  void LaunchLazyTask();
+  void PrefetchLazyFunctions();
   std::vector<std::unique_ptr<Instruction>> MergeResult();
+  // build the instruction of a deduplicated group, calling the function of its representative
+  std::unique_ptr<Instruction> BuildDuplicateInstruction(int gidx);
+  // compile a group that can't share the function of its representative after all
+  std::unique_ptr<Instruction> CompileGroup(int gidx);
 
  public:
   struct Task {
@@ -58,20 +114,25 @@ class ParallelCompiler {
          const CompileOptions& cp,
          const Target& t)
         : compiler(p), scope(s), graph(g), options(cp), target(t) {}
-    void Lowering();
+    // lower the \p i-th group of the task
+    void LowerGroup(int i);
     void CodegenAndJit();
     void BuildInstruction();
+    void BuildLazyInstruction();
 
    public:
     const Target target;
     ParallelCompiler* compiler;
     std::shared_ptr<Scope> scope;
     std::shared_ptr<Graph> graph;
+    // the options owned by the compiler, which outlives its tasks
     const CompileOptions& options;
 
     std::vector<int> gidx;
     std::vector<std::unique_ptr<Instruction>> instructions;
     std::vector<std::vector<ir::LoweredFunc>> lowered_funcs;
+    // the function compiled on the first run, only set by the lazy tasks
+    std::shared_ptr<LazyFunction> lazy_function;
 
    public:
     std::unique_ptr<backends::ExecutionEngine> engine;
@@ -80,14 +141,36 @@ class ParallelCompiler {
 #endif
   };
   std::vector<Task> tasks_;
-  int GetGroupIdx();
 
  private:
+  int num_threads_{1};
+  std::vector<int> representatives_;
+  // the variables of each group numbered by Graph::GroupStructuralKey
+  std::vector<std::vector<std::string>> group_vars_;
+  // the groups to compile
+  std::vector<int> unique_groups_;
+  // the next group to lower in unique_groups_
   int index{0};
+  // the task of each group to compile and the position of the group in the task
+  std::vector<int> task_of_group_;
+  std::vector<int> slot_of_group_;
+  // the number of groups left to lower of each task
+  std::vector<int> remaining_groups_;
+  int num_finished_tasks_{0};
+  // the tasks ready for codegen of each thread
+  std::vector<std::deque<int>> ready_tasks_;
   std::mutex mtx_;
+  std::condition_variable cv_;
+  Stats stats_;
+
+  // the lazy function of each group in the order of groups
+  std::vector<std::shared_ptr<LazyFunction>> lazy_functions_;
+  std::atomic<bool> stop_prefetch_{false};
+  std::thread prefetcher_;
 
   const common::Target target_;
-  const CompileOptions& option_;
+  // a copy, since the lazy groups are compiled after the caller's options go out of scope
+  const CompileOptions option_;
   std::shared_ptr<Scope> scope_;
   std::shared_ptr<Graph> graph_;
 };
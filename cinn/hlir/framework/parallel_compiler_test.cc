@@ -16,11 +16,15 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 #include "cinn/common/target.h"
 #include "cinn/frontend/net_builder.h"
 #include "cinn/frontend/optimize.h"
 #include "cinn/hlir/framework/graph_compiler.h"
 
+DECLARE_bool(cinn_deduplicate_groups);
+
 namespace cinn {
 namespace hlir {
 namespace framework {
@@ -78,6 +82,149 @@ TEST(ParallelCompilerTest, Matmul_Test_0) {
   auto runtime_program = pc();
 }
 
+TEST(ParallelCompilerTest, WorkStealing) {
+  frontend::NetBuilder builder("WorkStealing");
+  frontend::Variable x = builder.CreateInput(Float(32), {32, 32}, "X");
+  for (int i = 0; i < 16; ++i) {
+    x = builder.Relu(builder.Add(x, x));
+  }
+  auto target  = common::DefaultHostTarget();
+  auto program = builder.Build();
+  auto graph   = std::make_shared<Graph>(program, target);
+  auto scope   = BuildScope(target, graph);
+
+  ParallelCompiler::CompileOptions option;
+  ParallelCompiler pc(scope, graph, option, target);
+  auto instructions = pc();
+  ASSERT_EQ(instructions.size(), graph->fusion_groups.size());
+  for (auto& instr : instructions) {
+    ASSERT_TRUE(instr);
+  }
+
+  auto& stats = pc.GetStats();
+  LOG(INFO) << stats.ToString();
+  ASSERT_EQ(stats.num_tasks, pc.tasks_.size());
+  ASSERT_GE(stats.num_threads, 1);
+  ASSERT_GT(stats.lowering_ms, 0);
+  ASSERT_GT(stats.codegen_ms, 0);
+}
+
+TEST(ParallelCompilerTest, DeduplicateGroups) {
+  frontend::NetBuilder builder("DeduplicateGroups");
+  auto A       = builder.CreateInput(Float(32), {32, 32}, "A");
+  auto B       = builder.CreateInput(Float(32), {32, 32}, "B");
+  auto C       = builder.Relu(A);
+  auto D       = builder.Relu(B);
+  auto target  = common::DefaultHostTarget();
+  auto program = builder.Build();
+  auto graph   = std::make_shared<Graph>(program, target);
+  auto scope   = BuildScope(target, graph);
+
+  ParallelCompiler::CompileOptions option;
+  // the deduplication is opt-in
+  ParallelCompiler plain_pc(scope, graph, option, target);
+  ASSERT_EQ(plain_pc().size(), 2);
+  ASSERT_EQ(plain_pc.GetStats().num_deduplicated_groups, 0);
+  ASSERT_EQ(plain_pc.GetRepresentativeGroup(1), 1);
+
+  FLAGS_cinn_deduplicate_groups = true;
+  ParallelCompiler pc(scope, graph, option, target);
+  auto instructions             = pc();
+  FLAGS_cinn_deduplicate_groups = false;
+  ASSERT_EQ(instructions.size(), 2);
+  ASSERT_EQ(pc.GetStats().num_deduplicated_groups, 1);
+  ASSERT_EQ(pc.GetRepresentativeGroup(1), 0);
+  ASSERT_EQ(graph->GroupStructuralKey(graph->fusion_groups[0]), graph->GroupStructuralKey(graph->fusion_groups[1]));
+  ASSERT_EQ(instructions[1]->GetFnNames(), instructions[0]->GetFnNames());
+
+  auto* a = scope->GetTensor("A")->mutable_data<float>(target);
+  auto* b = scope->GetTensor("B")->mutable_data<float>(target);
+  for (int i = 0; i < 32 * 32; ++i) {
+    a[i] = i % 2 ? i : -i;
+    b[i] = i % 3 ? -i : i;
+  }
+  for (auto& instr : instructions) {
+    instr->Run();
+  }
+
+  auto* c = scope->GetTensor(C->id)->data<float>();
+  auto* d = scope->GetTensor(D->id)->data<float>();
+  for (int i = 0; i < 32 * 32; ++i) {
+    ASSERT_FLOAT_EQ(c[i], std::max(a[i], 0.f));
+    ASSERT_FLOAT_EQ(d[i], std::max(b[i], 0.f));
+  }
+}
+
+TEST(ParallelCompilerTest, LazyCompile) {
+  frontend::NetBuilder builder("LazyCompile");
+  auto A       = builder.CreateInput(Float(32), {32, 32}, "A");
+  auto B       = builder.CreateInput(Float(32), {32, 32}, "B");
+  auto C       = builder.Add(A, B);
+  auto D       = builder.Relu(C);
+  auto target  = common::DefaultHostTarget();
+  auto program = builder.Build();
+  auto graph   = std::make_shared<Graph>(program, target);
+  auto scope   = BuildScope(target, graph);
+
+  ParallelCompiler::CompileOptions option;
+  option.lazy_compile = true;
+  ParallelCompiler pc(scope, graph, option, target);
+  auto instructions = pc();
+  ASSERT_FALSE(instructions.empty());
+  for (auto& instr : instructions) {
+    ASSERT_FALSE(instr->IsCompiled());
+  }
+
+  auto* a = scope->GetTensor("A")->mutable_data<float>(target);
+  auto* b = scope->GetTensor("B")->mutable_data<float>(target);
+  for (int i = 0; i < 32 * 32; ++i) {
+    a[i] = i % 2 ? i : -i;
+    b[i] = 1.f;
+  }
+  for (auto& instr : instructions) {
+    instr->Run();
+    ASSERT_TRUE(instr->IsCompiled());
+  }
+
+  auto* d = scope->GetTensor(D->id)->data<float>();
+  for (int i = 0; i < 32 * 32; ++i) {
+    ASSERT_FLOAT_EQ(d[i], std::max(a[i] + b[i], 0.f));
+  }
+}
+
+TEST(ParallelCompilerTest, LazyProgramOutlivesGraphCompiler) {
+  frontend::NetBuilder builder("LazyProgramOutlivesGraphCompiler");
+  auto A       = builder.CreateInput(Float(32), {32, 32}, "A");
+  auto B       = builder.CreateInput(Float(32), {32, 32}, "B");
+  auto C       = builder.Add(A, B);
+  auto D       = builder.Relu(C);
+  auto target  = common::DefaultHostTarget();
+  auto program = builder.Build();
+  auto graph   = std::make_shared<Graph>(program, target);
+  auto scope   = BuildScope(target, graph);
+
+  std::unique_ptr<Program> runtime_program;
+  {
+    GraphCompiler gc(target, scope, graph);
+    GraphCompiler::CompileOptions options;
+    options.lazy_compile = true;
+    runtime_program      = std::move(gc.Build(options).runtime_program);
+  }
+
+  // the groups are compiled on the first run after the GraphCompiler is destroyed
+  auto* a = scope->GetTensor("A")->mutable_data<float>(target);
+  auto* b = scope->GetTensor("B")->mutable_data<float>(target);
+  for (int i = 0; i < 32 * 32; ++i) {
+    a[i] = i % 2 ? i : -i;
+    b[i] = 1.f;
+  }
+  runtime_program->Execute();
+  auto* d = scope->GetTensor(D->id)->data<float>();
+  for (int i = 0; i < 32 * 32; ++i) {
+    ASSERT_FLOAT_EQ(d[i], std::max(a[i] + b[i], 0.f));
+  }
+}
+
 }  // namespace framework
 }  // namespace hlir
 }  // namespace cinn
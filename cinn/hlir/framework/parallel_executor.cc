@@ -0,0 +1,188 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/hlir/framework/parallel_executor.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "cinn/utils/profiler.h"
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+ParallelExecutor::ParallelExecutor(const std::vector<std::unique_ptr<Instruction>>& instrs,
+                                   int num_threads,
+                                   const runtime::cpu::ThreadConfig& config)
+    : num_threads_(num_threads), config_(config) {
+  CHECK_GT(num_threads_, 0) << "The number of threads of ParallelExecutor should be greater than 0";
+  for (auto& instr : instrs) {
+    instrs_.push_back(instr.get());
+  }
+  config_.inter_op_num_threads = num_threads_;
+  config_.intra_op_num_threads = config_.GetIntraOpNumThreads();
+  config_.cpus                 = config_.GetCpus();
+  BuildDependency();
+
+  pending_.reset(new std::atomic<int>[instrs_.size()]);
+  // the calling thread of Run works as the first worker
+  for (int i = 1; i < num_threads_; ++i) {
+    workers_.emplace_back(&ParallelExecutor::WorkerLoop, this);
+  }
+  VLOG(3) << "Create ParallelExecutor of " << instrs_.size() << " instructions with " << roots_.size()
+          << " roots, inter-op threads: " << num_threads_ << ", intra-op threads: " << config_.intra_op_num_threads;
+}
+
+ParallelExecutor::~ParallelExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ParallelExecutor::BuildDependency() {
+  int num_instrs = instrs_.size();
+  successors_.assign(num_instrs, {});
+  num_predecessors_.assign(num_instrs, 0);
+  roots_.clear();
+
+  std::unordered_map<std::string, int> last_writer;
+  std::unordered_map<std::string, std::vector<int>> readers;
+  for (int i = 0; i < num_instrs; ++i) {
+    std::vector<int> predecessors;
+    std::vector<std::string> in_names, out_names;
+    for (auto& args : instrs_[i]->GetInArgs()) {
+      in_names.insert(in_names.end(), args.begin(), args.end());
+    }
+    for (auto& args : instrs_[i]->GetOutArgs()) {
+      out_names.insert(out_names.end(), args.begin(), args.end());
+    }
+
+    // read after write
+    for (auto& name : in_names) {
+      if (last_writer.count(name)) predecessors.push_back(last_writer.at(name));
+    }
+    // write after write and write after read
+    for (auto& name : out_names) {
+      if (last_writer.count(name)) predecessors.push_back(last_writer.at(name));
+      if (readers.count(name)) {
+        auto& name_readers = readers.at(name);
+        predecessors.insert(predecessors.end(), name_readers.begin(), name_readers.end());
+      }
+    }
+
+    std::sort(predecessors.begin(), predecessors.end());
+    predecessors.erase(std::unique(predecessors.begin(), predecessors.end()), predecessors.end());
+    for (int pred : predecessors) {
+      if (pred == i) continue;
+      successors_[pred].push_back(i);
+      ++num_predecessors_[i];
+    }
+    if (num_predecessors_[i] == 0) roots_.push_back(i);
+
+    for (auto& name : in_names) {
+      readers[name].push_back(i);
+    }
+    for (auto& name : out_names) {
+      last_writer[name] = i;
+      readers[name].clear();
+    }
+  }
+}
+
+void ParallelExecutor::Run(const std::map<std::string, cinn_pod_value_t>* name2podargs, void* stream, bool use_cache) {
+  utils::RecordEvent("ParallelExecutor Run", utils::EventType::kOrdinary);
+  int num_instrs = instrs_.size();
+  if (num_instrs == 0) return;
+
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    name2podargs_ = name2podargs;
+    stream_       = stream;
+    use_cache_    = use_cache;
+    for (int i = 0; i < num_instrs; ++i) {
+      pending_[i].store(num_predecessors_[i], std::memory_order_relaxed);
+    }
+    num_finished_.store(0, std::memory_order_relaxed);
+    ready_.assign(roots_.begin(), roots_.end());
+  }
+  cv_.notify_all();
+
+  runtime::cpu::ScopedThreadConfig thread_config(config_);
+  while (true) {
+    int idx = -1;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      cv_.wait(lock, [this, num_instrs] {
+        return !ready_.empty() || num_finished_.load(std::memory_order_acquire) == num_instrs;
+      });
+      if (ready_.empty()) break;
+      idx = ready_.front();
+      ready_.pop_front();
+    }
+    RunInstruction(idx);
+  }
+}
+
+void ParallelExecutor::WorkerLoop() {
+  runtime::cpu::ScopedThreadConfig thread_config(config_);
+  while (true) {
+    int idx = -1;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      cv_.wait(lock, [this] { return stop_ || !ready_.empty(); });
+      if (stop_) return;
+      idx = ready_.front();
+      ready_.pop_front();
+    }
+    RunInstruction(idx);
+  }
+}
+
+void ParallelExecutor::RunInstruction(int idx) {
+  int num_instrs = instrs_.size();
+  while (idx != -1) {
+    instrs_[idx]->Run(name2podargs_, false, stream_, use_cache_);
+
+    int next = -1;
+    for (int succ : successors_[idx]) {
+      if (pending_[succ].fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+      if (next == -1) {
+        next = succ;
+      } else {
+        {
+          std::lock_guard<std::mutex> lock(mtx_);
+          ready_.push_back(succ);
+        }
+        cv_.notify_one();
+      }
+    }
+
+    if (num_finished_.fetch_add(1, std::memory_order_acq_rel) + 1 == num_instrs) {
+      // wake up the calling thread of Run
+      { std::lock_guard<std::mutex> lock(mtx_); }
+      cv_.notify_all();
+    }
+    idx = next;
+  }
+}
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
@@ -0,0 +1,103 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cinn/hlir/framework/instruction.h"
+#include "cinn/runtime/cinn_runtime.h"
+#include "cinn/runtime/cpu/thread_config.h"
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+/**
+ * ParallelExecutor runs the instructions of a Program by their data dependencies instead of their order.
+ *
+ * A DAG is built from the argument names of instructions: an instruction depends on the last writer of each of
+ * its inputs (read after write), and on the last writer and readers of each of its outputs (write after write,
+ * write after read). Every instruction holds an atomic counter of unfinished predecessors, and it is pushed to
+ * the ready queue by the thread finishing its last predecessor. The ready instructions are consumed by a pool of
+ * persistent workers together with the calling thread.
+ *
+ * The executor shares the thread budget with the intra-op parallelism: each worker limits the kernels it runs
+ * to max_concurrency() / num_threads threads, so that the total number of busy threads stays the same. The budget
+ * and the cpus the threads are bound to can be given by a runtime::cpu::ThreadConfig instead.
+ */
+class ParallelExecutor {
+ public:
+  /**
+   * @param instrs The instructions to run, they should outlive the executor.
+   * @param num_threads The number of threads running instructions concurrently, including the calling thread.
+   * @param config The intra-op threads and the cpus of the workers, whose inter_op_num_threads is overridden by
+   * num_threads.
+   */
+  ParallelExecutor(const std::vector<std::unique_ptr<Instruction>>& instrs,
+                   int num_threads,
+                   const runtime::cpu::ThreadConfig& config = {});
+  ~ParallelExecutor();
+
+  // Run all the instructions, and return after all of them finished. It should not be called concurrently.
+  void Run(const std::map<std::string, cinn_pod_value_t>* name2podargs = nullptr,
+           void* stream                                                = nullptr,
+           bool use_cache                                              = true);
+
+  int num_threads() const { return num_threads_; }
+
+  // The instructions that \p idx-th instruction should run before, exposed for test.
+  const std::vector<int>& GetSuccessors(int idx) const { return successors_.at(idx); }
+
+ private:
+  void BuildDependency();
+  void WorkerLoop();
+  // run an instruction, and keep running the first successor it makes ready on the same thread
+  void RunInstruction(int idx);
+
+  int num_threads_;
+  // applied to the calling thread of Run and the workers, whose intra-op threads are resolved
+  runtime::cpu::ThreadConfig config_;
+  std::vector<Instruction*> instrs_;
+  std::vector<std::vector<int>> successors_;
+  std::vector<int> num_predecessors_;
+  std::vector<int> roots_;
+  // the number of unfinished predecessors of each instruction in the current run
+  std::unique_ptr<std::atomic<int>[]> pending_;
+  std::atomic<int> num_finished_{0};
+
+  // arguments of the current run
+  const std::map<std::string, cinn_pod_value_t>* name2podargs_{nullptr};
+  void* stream_{nullptr};
+  bool use_cache_{true};
+
+  std::mutex mtx_;
+  // notified when an instruction becomes ready, the run finishes or the executor stops
+  std::condition_variable cv_;
+  std::deque<int> ready_;
+  bool stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
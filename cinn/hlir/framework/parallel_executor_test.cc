@@ -0,0 +1,118 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/hlir/framework/parallel_executor.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cinn/hlir/framework/graph_compiler.h"
+#include "cinn/hlir/framework/scope.h"
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+constexpr int kNumel = 64;
+
+float* GetData(void* args, int idx) {
+  auto* buffer = cinn_pod_value_to_buffer_p(static_cast<cinn_pod_value_t*>(args) + idx);
+  return reinterpret_cast<float*>(buffer->memory);
+}
+
+// out = x + 1
+void AddOne(void* args, int32_t num_args) {
+  for (int i = 0; i < kNumel; ++i) GetData(args, 1)[i] = GetData(args, 0)[i] + 1;
+}
+
+// out = x * 2
+void MulTwo(void* args, int32_t num_args) {
+  for (int i = 0; i < kNumel; ++i) GetData(args, 1)[i] = GetData(args, 0)[i] * 2;
+}
+
+// out = x + y
+void Add(void* args, int32_t num_args) {
+  for (int i = 0; i < kNumel; ++i) GetData(args, 2)[i] = GetData(args, 0)[i] + GetData(args, 1)[i];
+}
+
+// out = 0
+void Zero(void* args, int32_t num_args) {
+  for (int i = 0; i < kNumel; ++i) GetData(args, 0)[i] = 0;
+}
+
+std::unique_ptr<Instruction> CreateInstruction(Scope* scope,
+                                               const std::vector<std::string>& in_args,
+                                               const std::vector<std::string>& out_args,
+                                               lower_func_ptr_t fn) {
+  auto instr = std::make_unique<Instruction>(common::DefaultHostTarget(), scope, in_args, out_args);
+  instr->SetLoweredFunc(reinterpret_cast<void*>(fn));
+  instr->Finalize();
+  return instr;
+}
+
+// x -> (a, b) -> c, and x is rewritten after being read, then out = c + x
+std::vector<std::unique_ptr<Instruction>> CreateDiamond(Scope* scope) {
+  for (auto& name : std::vector<std::string>({"x", "a", "b", "c", "out"})) {
+    auto* var    = scope->Var<Tensor>(name);
+    auto& tensor = absl::get<Tensor>(*var);
+    tensor->Resize(Shape{{kNumel}});
+    auto* data = tensor->mutable_data<float>(common::DefaultHostTarget());
+    for (int i = 0; i < kNumel; ++i) data[i] = i;
+  }
+
+  std::vector<std::unique_ptr<Instruction>> instrs;
+  instrs.emplace_back(CreateInstruction(scope, {"x"}, {"a"}, AddOne));
+  instrs.emplace_back(CreateInstruction(scope, {"x"}, {"b"}, MulTwo));
+  instrs.emplace_back(CreateInstruction(scope, {"a", "b"}, {"c"}, Add));
+  instrs.emplace_back(CreateInstruction(scope, {}, {"x"}, Zero));
+  instrs.emplace_back(CreateInstruction(scope, {"c", "x"}, {"out"}, Add));
+  return instrs;
+}
+
+TEST(ParallelExecutor, Dependency) {
+  Scope scope;
+  auto instrs = CreateDiamond(&scope);
+  ParallelExecutor executor(instrs, 2);
+
+  ASSERT_EQ(executor.GetSuccessors(0), std::vector<int>({2, 3}));
+  ASSERT_EQ(executor.GetSuccessors(1), std::vector<int>({2, 3}));
+  ASSERT_EQ(executor.GetSuccessors(2), std::vector<int>({4}));
+  ASSERT_EQ(executor.GetSuccessors(3), std::vector<int>({4}));
+  ASSERT_TRUE(executor.GetSuccessors(4).empty());
+}
+
+TEST(ParallelExecutor, Program) {
+  auto scope = std::make_shared<Scope>();
+  Program program(scope, CreateDiamond(scope.get()));
+  program.SetNumThreads(4);
+
+  for (int repeat = 0; repeat < 100; ++repeat) {
+    auto* x = scope->GetTensor("x")->mutable_data<float>(common::DefaultHostTarget());
+    for (int i = 0; i < kNumel; ++i) x[i] = i;
+
+    program.Execute();
+
+    auto* out = scope->GetTensor("out")->data<float>();
+    for (int i = 0; i < kNumel; ++i) {
+      ASSERT_FLOAT_EQ(out[i], (i + 1) + i * 2);
+    }
+  }
+}
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
@@ -0,0 +1,203 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/hlir/framework/program_benchmark.h"
+
+#ifdef CINN_WITH_CUDA
+#include <cuda_runtime.h>
+
+#include "cinn/backends/cuda_util.h"
+#endif
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include "cinn/utils/string.h"
+#include "cinn/utils/timer.h"
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+namespace {
+
+void Synchronize(const Target& target, void* stream) {
+#ifdef CINN_WITH_CUDA
+  if (target.arch == Target::Arch::NVGPU) {
+    if (stream) {
+      CUDA_CALL(cudaStreamSynchronize(static_cast<cudaStream_t>(stream)));
+    } else {
+      CUDA_CALL(cudaDeviceSynchronize());
+    }
+  }
+#endif
+}
+
+// write a buffer larger than the last level cache, so that the next run starts with cold caches
+void FlushCache(const Target& target, size_t nbytes) {
+  static int round = 0;
+  ++round;
+#ifdef CINN_WITH_CUDA
+  if (target.arch == Target::Arch::NVGPU) {
+    static void* device_buffer = nullptr;
+    static size_t device_bytes = 0;
+    if (device_bytes < nbytes) {
+      if (device_buffer) CUDA_CALL(cudaFree(device_buffer));
+      CUDA_CALL(cudaMalloc(&device_buffer, nbytes));
+      device_bytes = nbytes;
+    }
+    CUDA_CALL(cudaMemset(device_buffer, round & 0xff, nbytes));
+    CUDA_CALL(cudaDeviceSynchronize());
+    return;
+  }
+#endif
+  static std::vector<char> host_buffer;
+  if (host_buffer.size() < nbytes) {
+    host_buffer.resize(nbytes);
+  }
+  std::fill(host_buffer.begin(), host_buffer.begin() + nbytes, static_cast<char>(round));
+  // read it back so that the writes are not optimized away
+  volatile char sink = 0;
+  for (size_t i = 0; i < nbytes; i += 64) sink += host_buffer[i];
+}
+
+}  // namespace
+
+BenchmarkStats BenchmarkStats::Compute(std::vector<double> costs) {
+  BenchmarkStats stats;
+  if (costs.empty()) return stats;
+  std::sort(costs.begin(), costs.end());
+  // the nearest-rank percentile
+  auto percentile = [&costs](double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p * costs.size()));
+    return costs[std::max<size_t>(rank, 1) - 1];
+  };
+
+  size_t n     = costs.size();
+  stats.count  = n;
+  stats.min    = costs.front();
+  stats.median = n % 2 ? costs[n / 2] : (costs[n / 2 - 1] + costs[n / 2]) / 2;
+  stats.p90    = percentile(0.9);
+  stats.p99    = percentile(0.99);
+  for (double cost : costs) stats.mean += cost;
+  stats.mean /= n;
+  for (double cost : costs) stats.stddev += (cost - stats.mean) * (cost - stats.mean);
+  stats.stddev = std::sqrt(stats.stddev / n);
+  return stats;
+}
+
+std::string BenchmarkStats::ToJson() const {
+  std::ostringstream os;
+  os << std::setprecision(6) << "{\"count\": " << count << ", \"min_ms\": " << min << ", \"median_ms\": " << median
+     << ", \"mean_ms\": " << mean << ", \"p90_ms\": " << p90 << ", \"p99_ms\": " << p99 << ", \"stddev_ms\": " << stddev
+     << "}";
+  return os.str();
+}
+
+std::string BenchmarkResult::ToJson() const {
+  std::ostringstream os;
+  os << "{\"total\": " << total.ToJson() << ", \"instructions\": [";
+  for (int i = 0; i < instructions.size(); ++i) {
+    if (i) os << ", ";
+    os << "{\"name\": \"" << instructions[i].first << "\", \"stats\": " << instructions[i].second.ToJson() << "}";
+  }
+  os << "]}";
+  return os.str();
+}
+
+std::string BenchmarkResult::ToString() const {
+  size_t name_width = 20;
+  for (auto& instr : instructions) name_width = std::max(name_width, instr.first.size() + 1);
+
+  std::ostringstream os;
+  auto print_row = [&](const std::string& name, const BenchmarkStats& stats) {
+    os << std::left << std::setw(name_width) << name << std::setw(10) << stats.count;
+    for (double value : {stats.min, stats.median, stats.mean, stats.p90, stats.p99, stats.stddev}) {
+      os << std::setw(14) << std::to_string(value);
+    }
+    os << "\n";
+  };
+  os << std::left << std::setw(name_width) << "Name" << std::setw(10) << "Count";
+  for (auto title : {"Min(ms)", "Median(ms)", "Mean(ms)", "P90(ms)", "P99(ms)", "Stddev(ms)"}) {
+    os << std::setw(14) << title;
+  }
+  os << "\n";
+  print_row("[total]", total);
+  for (auto& instr : instructions) {
+    print_row(instr.first, instr.second);
+  }
+  return os.str();
+}
+
+BenchmarkResult BenchmarkProgram(Program* program,
+                                 const BenchmarkOptions& options,
+                                 const std::map<std::string, cinn_pod_value_t>* name2podargs,
+                                 void* stream) {
+  CHECK(program);
+  CHECK_GE(options.warmup, 0);
+  CHECK_GT(options.repeat, 0);
+  auto& instrs = program->GetRunInstructions();
+  CHECK(!instrs.empty()) << "The program to benchmark has no instruction";
+  Target target = instrs[0]->target_;
+
+  for (int i = 0; i < options.warmup; ++i) {
+    program->Execute(name2podargs, stream);
+  }
+  Synchronize(target, stream);
+
+  BenchmarkResult result;
+  std::vector<double> costs;
+  double elapsed = 0.0;
+  utils::Timer timer;
+  while (costs.size() < options.repeat || elapsed < options.min_time_ms) {
+    if (options.flush_cache) {
+      FlushCache(target, options.flush_cache_bytes);
+    }
+    timer.Start();
+    program->Execute(name2podargs, stream);
+    Synchronize(target, stream);
+    costs.push_back(timer.Stop());
+    elapsed += costs.back();
+  }
+  result.total = BenchmarkStats::Compute(costs);
+
+  if (options.per_instruction) {
+    std::vector<std::vector<double>> instr_costs(instrs.size());
+    for (int i = 0; i < result.total.count; ++i) {
+      if (options.flush_cache) {
+        FlushCache(target, options.flush_cache_bytes);
+      }
+      for (int j = 0; j < instrs.size(); ++j) {
+        timer.Start();
+        instrs[j]->Run(name2podargs, false, stream);
+        Synchronize(target, stream);
+        instr_costs[j].push_back(timer.Stop());
+      }
+    }
+    for (int j = 0; j < instrs.size(); ++j) {
+      auto name = instrs[j]->GetFunctionName();
+      if (name.empty()) name = utils::Join(instrs[j]->GetFnNames(), ",");
+      result.instructions.emplace_back(name, BenchmarkStats::Compute(instr_costs[j]));
+    }
+  }
+  return result;
+}
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
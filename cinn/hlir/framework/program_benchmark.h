@@ -0,0 +1,79 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cinn/hlir/framework/graph_compiler.h"
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+struct BenchmarkOptions {
+  // the number of runs before measuring
+  int warmup{10};
+  // the minimum number of measured runs
+  int repeat{100};
+  // keep measuring until the measured runs take at least min_time_ms in total, 0 means repeat runs exactly
+  double min_time_ms{0.0};
+  // evict the caches by touching a large buffer before every run, which is not measured
+  bool flush_cache{false};
+  size_t flush_cache_bytes{64UL << 20};
+  // also measure every instruction, by running and synchronizing the instructions one by one
+  bool per_instruction{false};
+};
+
+// the statistics of the costs of runs in milliseconds
+struct BenchmarkStats {
+  int count{0};
+  double min{0.0};
+  double median{0.0};
+  double mean{0.0};
+  double p90{0.0};
+  double p99{0.0};
+  double stddev{0.0};
+
+  static BenchmarkStats Compute(std::vector<double> costs);
+
+  std::string ToJson() const;
+};
+
+struct BenchmarkResult {
+  BenchmarkStats total;
+  // the statistics of each instruction in the order of execution, named by its function
+  std::vector<std::pair<std::string, BenchmarkStats>> instructions;
+
+  std::string ToJson() const;
+
+  std::string ToString() const;
+};
+
+/**
+ * Benchmark the execution of a program. The runs are synchronized with the device, so the costs include the
+ * kernels on GPU. The program is executed as Program::Execute does, while the per-instruction costs are measured
+ * in separate runs executing the instructions in order, so that they do not disturb the total costs.
+ */
+BenchmarkResult BenchmarkProgram(Program* program,
+                                 const BenchmarkOptions& options,
+                                 const std::map<std::string, cinn_pod_value_t>* name2podargs = nullptr,
+                                 void* stream                                                = nullptr);
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
@@ -0,0 +1,96 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/hlir/framework/program_benchmark.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cinn/hlir/framework/scope.h"
+
+namespace cinn {
+namespace hlir {
+namespace framework {
+
+constexpr int kNumel = 1024;
+
+// y = x * 2
+void Scale(void* args, int32_t num_args) {
+  auto* x = reinterpret_cast<float*>(cinn_pod_value_to_buffer_p(static_cast<cinn_pod_value_t*>(args))->memory);
+  auto* y = reinterpret_cast<float*>(cinn_pod_value_to_buffer_p(static_cast<cinn_pod_value_t*>(args) + 1)->memory);
+  for (int i = 0; i < kNumel; ++i) y[i] = x[i] * 2;
+}
+
+TEST(BenchmarkStats, Compute) {
+  std::vector<double> costs;
+  for (int i = 100; i >= 1; --i) costs.push_back(i);
+  auto stats = BenchmarkStats::Compute(costs);
+  EXPECT_EQ(stats.count, 100);
+  EXPECT_DOUBLE_EQ(stats.min, 1);
+  EXPECT_DOUBLE_EQ(stats.median, 50.5);
+  EXPECT_DOUBLE_EQ(stats.mean, 50.5);
+  EXPECT_DOUBLE_EQ(stats.p90, 90);
+  EXPECT_DOUBLE_EQ(stats.p99, 99);
+  EXPECT_NEAR(stats.stddev, 28.866, 1e-3);
+}
+
+TEST(BenchmarkProgram, PerInstruction) {
+  auto scope = std::make_shared<Scope>();
+  for (auto& name : std::vector<std::string>({"a", "b", "c"})) {
+    auto& tensor = absl::get<Tensor>(*scope->Var<Tensor>(name));
+    tensor->Resize(Shape{{kNumel}});
+    tensor->mutable_data<float>(common::DefaultHostTarget());
+  }
+  std::vector<std::unique_ptr<Instruction>> instrs;
+  for (auto& args : std::vector<std::pair<std::string, std::string>>({{"a", "b"}, {"b", "c"}})) {
+    auto instr = std::make_unique<Instruction>(common::DefaultHostTarget(),
+                                               scope.get(),
+                                               std::vector<std::string>({args.first}),
+                                               std::vector<std::string>({args.second}),
+                                               "scale_" + args.second);
+    instr->SetLoweredFunc(reinterpret_cast<void*>(Scale));
+    instr->Finalize();
+    instrs.emplace_back(std::move(instr));
+  }
+  Program program(scope, std::move(instrs));
+
+  BenchmarkOptions options;
+  options.warmup            = 2;
+  options.repeat            = 5;
+  options.min_time_ms       = 1.0;
+  options.flush_cache       = true;
+  options.flush_cache_bytes = 1 << 20;
+  options.per_instruction   = true;
+  auto result               = BenchmarkProgram(&program, options);
+  LOG(INFO) << "\n" << result.ToString();
+
+  EXPECT_GE(result.total.count, 5);
+  EXPECT_GE(result.total.mean * result.total.count, 1.0);
+  EXPECT_LE(result.total.min, result.total.p99);
+  ASSERT_EQ(result.instructions.size(), 2UL);
+  EXPECT_EQ(result.instructions[0].first, "scale_b");
+  EXPECT_EQ(result.instructions[1].first, "scale_c");
+  EXPECT_EQ(result.instructions[0].second.count, result.total.count);
+
+  auto json = result.ToJson();
+  EXPECT_EQ(json.find("{\"total\": {\"count\": "), 0UL);
+  EXPECT_NE(json.find("{\"name\": \"scale_c\", \"stats\": {"), std::string::npos);
+}
+
+}  // namespace framework
+}  // namespace hlir
+}  // namespace cinn
@@ -14,6 +14,8 @@
 
 #include "cinn/hlir/framework/tensor.h"
 
+#include <algorithm>
+
 #include "cinn/runtime/cinn_runtime.h"
 
 namespace cinn {
@@ -51,6 +53,23 @@ void _Tensor_::set_type(Type type) {
   }
 }
 
+void _Tensor_::ShareExternalData(void* data,
+                                 size_t size,
+                                 const Target& target,
+                                 const Type& type,
+                                 size_t alignment,
+                                 std::shared_ptr<void> holder) {
+  CHECK(data) << "The external data should not be null";
+  size_t nbytes = shape_.numel() * type.bytes();
+  CHECK_GE(size, nbytes) << "The external data of " << size << " bytes can't hold the tensor of " << nbytes
+                         << " bytes";
+  if (alignment == 0) alignment = std::max(type.bytes(), 1);
+  CHECK_EQ(reinterpret_cast<uintptr_t>(data) % alignment, 0UL)
+      << "The external data at " << data << " is not aligned to " << alignment << " bytes";
+  set_type(type);
+  buffer_->ShareExternalMemory(data, size, target, std::move(holder));
+}
+
 }  // namespace framework
 }  // namespace hlir
 }  // namespace cinn
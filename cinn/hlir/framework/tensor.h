@@ -82,6 +82,19 @@ class _Tensor_ : public Object {
     return reinterpret_cast<T*>(buffer_->data()->memory);
   }
 
+  /**
+   * Use the caller-owned memory \p data of \p size bytes as the memory of this tensor, without allocating or
+   * copying, so the compiled programs read and write the memory directly. The memory should hold the whole tensor,
+   * be aligned to \p alignment or the element size if it is 0, and outlive the use of this tensor unless it is
+   * owned by \p holder, which is then kept alive by the tensor.
+   */
+  void ShareExternalData(void* data,
+                         size_t size,
+                         const Target& target,
+                         const Type& type,
+                         size_t alignment             = 0,
+                         std::shared_ptr<void> holder = nullptr);
+
   template <typename T>
   const T* data() const {
     return reinterpret_cast<T*>(buffer_->data()->memory);
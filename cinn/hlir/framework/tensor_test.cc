@@ -16,6 +16,8 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 namespace cinn {
 namespace hlir {
 namespace framework {
@@ -31,6 +33,38 @@ TEST(Tensor, basic) {
   }
 }
 
+TEST(Tensor, ShareExternalData) {
+  _Tensor_ tensor;
+  tensor.Resize(Shape{{3, 2}});
+
+  std::vector<float> external(6, 1.f);
+  tensor.ShareExternalData(external.data(), external.size() * sizeof(float), common::DefaultHostTarget(), Float(32));
+  ASSERT_TRUE(tensor.get_buffer()->IsExternalMemory());
+
+  // the external data is used without allocation or copy
+  auto* data = tensor.mutable_data<float>(common::DefaultHostTarget());
+  ASSERT_EQ(data, external.data());
+  for (int i = 0; i < tensor.shape().numel(); i++) {
+    data[i] = i;
+  }
+  for (int i = 0; i < external.size(); i++) {
+    ASSERT_EQ(external[i], i);
+  }
+
+  // a smaller shape keeps using the external data
+  tensor.Resize(Shape{{2, 2}});
+  ASSERT_EQ(tensor.mutable_data<float>(common::DefaultHostTarget()), external.data());
+  ASSERT_TRUE(tensor.get_buffer()->IsExternalMemory());
+
+  // growing beyond the external data is reported rather than silently detaching from it
+  tensor.Resize(Shape{{4, 4}});
+  ASSERT_DEATH(tensor.mutable_data<float>(common::DefaultHostTarget()), "external memory");
+
+  // the size of a buffer is 32 bits, a larger external memory is rejected rather than truncated
+  ASSERT_DEATH(tensor.get_buffer()->ShareExternalMemory(external.data(), size_t(1) << 32, common::DefaultHostTarget()),
+               "exceeds the maximum size");
+}
+
 }  // namespace framework
 }  // namespace hlir
 }  // namespace cinn
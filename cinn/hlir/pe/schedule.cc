@@ -85,7 +85,7 @@ int SplitEven(int origin) {
 }
 
 int GetBasicFactor(const Type &type, const common::Target &target) {
-  int target_native_vector_bits = target.get_target_bits() * 8;
+  int target_native_vector_bits = target.vector_bits();
   int type_bits                 = type.bits();
   return target_native_vector_bits / type_bits;
 }
@@ -148,7 +148,7 @@ void ScheduleInjectiveCPU1(poly::Stage *stage,
     CHECK_EQ(stage->n_out_dims(), output_shape.size())
         << "The origin stage out dims should be same with output_shape sizes";
     poly::Iterator fused          = stage->axis(dims - 1);
-    int target_native_vector_bits = target.get_target_bits() * 8;
+    int target_native_vector_bits = target.vector_bits();
     int type_bits                 = stage->tensor()->type().bits();
     int prod_size                 = output_shape.back();
     // fuse conservatively for the complex index from poly and may not benefit a lot compared with llvm optimization,
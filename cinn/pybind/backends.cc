@@ -29,16 +29,35 @@ namespace cinn::pybind {
 using backends::Compiler;
 using backends::ExecutionEngine;
 using backends::ExecutionOptions;
+using backends::OptimizeOptions;
 
 namespace {
 
 void BindExecutionEngine(py::module *);
 
 void BindExecutionEngine(py::module *m) {
+  py::class_<OptimizeOptions> optimize_options(*m, "OptimizeOptions");
+  optimize_options.def(py::init<>())
+      .def_readwrite("use_new_pass_manager", &OptimizeOptions::use_new_pass_manager)
+      .def_readwrite("quick", &OptimizeOptions::quick)
+      .def_readwrite("loop_vectorize", &OptimizeOptions::loop_vectorize)
+      .def_readwrite("slp_vectorize", &OptimizeOptions::slp_vectorize)
+      .def_readwrite("unroll_threshold", &OptimizeOptions::unroll_threshold)
+      .def_readwrite("fast_math_reassoc", &OptimizeOptions::fast_math_reassoc)
+      .def_readwrite("fast_math_nnan", &OptimizeOptions::fast_math_nnan)
+      .def_readwrite("fast_math_ninf", &OptimizeOptions::fast_math_ninf)
+      .def_readwrite("fast_math_contract", &OptimizeOptions::fast_math_contract)
+      .def("__str__", &OptimizeOptions::ToString);
+
   py::class_<ExecutionOptions> options(*m, "ExecutionOptions");
   options.def(py::init<>())
       .def_readwrite("opt_level", &ExecutionOptions::opt_level)
-      .def_readwrite("enable_debug_info", &ExecutionOptions::enable_debug_info);
+      .def_readwrite("enable_debug_info", &ExecutionOptions::enable_debug_info)
+      .def_readwrite("num_compile_threads", &ExecutionOptions::num_compile_threads)
+      .def_readwrite("enable_fast_math", &ExecutionOptions::enable_fast_math)
+      .def_readwrite("optimize_options", &ExecutionOptions::optimize_options)
+      .def_readwrite("export_isa_variants", &ExecutionOptions::export_isa_variants)
+      .def("__str__", &ExecutionOptions::ToString);
 
   auto lookup = [](ExecutionEngine &self, absl::string_view name) {
     auto *function_ptr    = reinterpret_cast<void (*)(void **, int32_t)>(self.Lookup(name));
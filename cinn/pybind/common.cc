@@ -69,7 +69,8 @@ void BindTarget(py::module *m) {
       .def(py::init<>())
       .def(py::init<Target::OS, Target::Arch, Target::Bit, const std::vector<Target::Feature> &>())
       .def("defined", &Target::defined)
-      .def("runtime_arch", &Target::runtime_arch);
+      .def("runtime_arch", &Target::runtime_arch)
+      .def("vector_bits", &Target::vector_bits);
 
   m->def("DefaultHostTarget", &common::DefaultHostTarget)
       .def("DefaultNVGPUTarget", &common::DefaultNVGPUTarget)
@@ -88,7 +89,11 @@ void BindTarget(py::module *m) {
   bit.value("Unk", Target::Bit::Unk).value("k32", Target::Bit::k32).value("k64", Target::Bit::k64);
 
   py::enum_<Target::Feature> feature(target, "Feature");
-  feature.value("JIT", Target::Feature::JIT).value("Debug", Target::Feature::Debug);
+  feature.value("JIT", Target::Feature::JIT)
+      .value("Debug", Target::Feature::Debug)
+      .value("SSE", Target::Feature::SSE)
+      .value("AVX2", Target::Feature::AVX2)
+      .value("AVX512", Target::Feature::AVX512);
 
   m->def("is_compiled_with_cuda", IsCompiledWithCUDA);
   m->def("is_compiled_with_cudnn", IsCompiledWithCUDNN);
@@ -774,7 +774,9 @@ void BindFrontend(pybind11::module *m) {
       .def_readwrite("use_decomposer", &CinnComputation::CompileOptions::use_decomposer)
       .def_readwrite("do_prerun", &CinnComputation::CompileOptions::do_prerun)
       .def_readwrite("use_default_passes", &CinnComputation::CompileOptions::use_default_passes)
-      .def_readwrite("passes", &CinnComputation::CompileOptions::passes);
+      .def_readwrite("passes", &CinnComputation::CompileOptions::passes)
+      .def_readwrite("with_static_memory_plan", &CinnComputation::CompileOptions::with_static_memory_plan)
+      .def_readwrite("execution_options", &CinnComputation::CompileOptions::execution_options);
 
   computation
       .def("default_compile_options", &CinnComputation::DefaultCompileOptions)
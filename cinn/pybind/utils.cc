@@ -47,6 +47,8 @@ void BindUtils(py::module *m) {
   py::class_<HostEventRecorder>(*m, "HostEventRecorder")
       .def_static("instance", &HostEventRecorder::GetInstance)
       .def_static("table", &HostEventRecorder::Table)
+      .def_static("kernel_table", &HostEventRecorder::KernelTable)
+      .def_static("save_chrome_trace", &HostEventRecorder::SaveChromeTrace)
       .def("events", &HostEventRecorder::Events)
       .def("clear", &HostEventRecorder::Clear);
 
@@ -0,0 +1,37 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file The allocator of host memory shared by the runtime functions in the compiled code and the framework. It is
+ * kept out of cinn_runtime.cc, whose copies are compiled into every module, so there is only one allocator in a
+ * process.
+ */
+
+#include "cinn/runtime/cinn_runtime.h"
+
+namespace {
+void* cinn_default_host_alloc(size_t alignment, size_t size) {
+  if (alignment == 0) return malloc(size);
+  // aligned_alloc requires the size to be a multiple of the alignment
+  return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+cinn_host_allocator_t cinn_current_host_allocator = {&cinn_default_host_alloc, &free};
+}  // namespace
+
+void cinn_set_host_allocator(cinn_host_allocator_t allocator) { cinn_current_host_allocator = allocator; }
+
+void* cinn_host_alloc(size_t alignment, size_t size) { return cinn_current_host_allocator.alloc(alignment, size); }
+
+void cinn_host_free(void* data) { cinn_current_host_allocator.free(data); }
@@ -168,6 +168,26 @@ extern int cinn_buffer_malloc(void* context, struct cinn_buffer_t* buf);
 //! Free device memory.
 extern int cinn_buffer_free(void* context, struct cinn_buffer_t* buf);
 
+//! The allocator of the host memory of buffers, which defaults to the C library.
+typedef struct cinn_host_allocator_t {
+  void* (*alloc)(size_t alignment, size_t size);
+  void (*free)(void* data);
+} cinn_host_allocator_t;
+
+/**
+ * Replace the allocator of the host memory, which cinn_x86_malloc and cinn_x86_free allocate and free the memory of
+ * buffers by. The framework installs its MemoryInterface of X86 when it is loaded, so the memory of a buffer is always
+ * freed by the allocator it comes from, whichever side allocates it. It should be called before any host memory is
+ * allocated.
+ */
+extern void cinn_set_host_allocator(cinn_host_allocator_t allocator);
+
+//! Allocate host memory by the current allocator, the alignment is ignored if it is 0.
+extern void* cinn_host_alloc(size_t alignment, size_t size);
+
+//! Free host memory allocated by cinn_host_alloc.
+extern void cinn_host_free(void* data);
+
 //! Get the memory address in buffer.
 extern void* cinn_buffer_get_data_handle(struct cinn_buffer_t* buf);
 extern void* cinn_buffer_get_data_const_handle(const struct cinn_buffer_t* buf);
@@ -29,14 +29,11 @@ int cinn_x86_malloc(void* context, cinn_buffer_t* buf) {
   }
   CINN_CHECK(memory_size > 0);
   if (buf->memory_size < memory_size || need_malloc) {
+    // the memory may be allocated by the framework, so it is freed by the allocator shared with it
     if (buf->memory) {
-      free(buf->memory);
-    }
-    if (buf->align == 0) {
-      buf->memory = (unsigned char*)malloc(memory_size);
-    } else {
-      buf->memory = (unsigned char*)aligned_alloc(buf->align, memory_size);
+      cinn_host_free(buf->memory);
     }
+    buf->memory = (unsigned char*)cinn_host_alloc(buf->align, memory_size);
     buf->memory_size = memory_size;
     CINN_LOG("buf.memory size is %ld\n", buf->memory_size);
   }
@@ -48,7 +45,7 @@ int cinn_x86_free(void* context, cinn_buffer_t* buf) {
   // ASSERT_NOT_NULL(context);
   ASSERT_NOT_NULL(buf);
   if (buf->memory) {
-    free(buf->memory);
+    cinn_host_free(buf->memory);
     buf->memory = NULL;
   }
   return 0;
@@ -0,0 +1,41 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file The detection of the x86 instruction set level, shared by the framework and the tiny runtime, which both
+ * provide the function called by the multi-versioned kernels.
+ */
+
+#include "cinn/runtime/cpu/host_intrinsics.h"
+
+extern "C" {
+
+int cinn_x86_isa_level() {
+#if defined(__x86_64__) || defined(_M_X64)
+  // the builtins check the support of the OS for the AVX registers as well
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") &&
+      __builtin_cpu_supports("avx512vl")) {
+    return cinn_x86_isa_avx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("bmi2")) {
+    return cinn_x86_isa_avx2;
+  }
+  if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")) {
+    return cinn_x86_isa_sse4_2;
+  }
+#endif
+  return cinn_x86_isa_baseline;
+}
+}  // extern "C"
@@ -421,5 +421,15 @@ CINN_REGISTER_HELPER(host_intrinsics) {
       .AddInputType<bool>()   // only_warning
       .End();
 
+  // called by the trampolines of the multi-versioned kernels rather than by the IR
+  cinn::backends::GlobalSymbolRegistry::Global().RegisterFn("cinn_x86_isa_level",
+                                                            reinterpret_cast<void*>(&cinn_x86_isa_level));
+
+  // called by cinn_x86_malloc and cinn_x86_free in the runtime functions compiled into every module
+  cinn::backends::GlobalSymbolRegistry::Global().RegisterFn("cinn_host_alloc",
+                                                            reinterpret_cast<void*>(&cinn_host_alloc));
+  cinn::backends::GlobalSymbolRegistry::Global().RegisterFn("cinn_host_free",
+                                                            reinterpret_cast<void*>(&cinn_host_free));
+
   return true;
 }
@@ -20,6 +20,20 @@
 
 extern "C" {
 
+//! The x86 instruction set levels which the multi-versioned kernels are dispatched by.
+typedef enum cinn_x86_isa_level_t {
+  cinn_x86_isa_baseline = 0,  // x86-64
+  cinn_x86_isa_sse4_2   = 1,  // SSE4.2 and POPCNT, e.g. Nehalem
+  cinn_x86_isa_avx2     = 2,  // AVX2, FMA and BMI2, e.g. Haswell
+  cinn_x86_isa_avx512   = 3,  // AVX-512 F, BW, DQ and VL, e.g. Skylake-AVX512
+} cinn_x86_isa_level_t;
+
+/**
+ * @brief The highest x86 instruction set level supported by the CPU and the OS, which the trampolines of the
+ * multi-versioned kernels call to select a variant.
+ */
+int cinn_x86_isa_level();
+
 //! math extern functions
 //@{
 void __cinn_host_tanh_v(const cinn_buffer_t* x, cinn_buffer_t* out);
@@ -14,14 +14,38 @@
 
 #include "cinn/runtime/cpu/thread_backend.h"
 
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
 #include <algorithm>
+#include <atomic>
 #include <vector>
 
 #include "cinn/backends/extern_func_jit_register.h"
 #include "cinn/backends/llvm/runtime_symbol_registry.h"
 #include "cinn/common/cas.h"
+#include "cinn/runtime/cpu/thread_config.h"
+#include "cinn/runtime/cpu/thread_pool.h"
 #include "cinn/runtime/intrinsic.h"
 
+DECLARE_string(cinn_parallel_backend);
+
+namespace {
+// the number of threads a parallel launch from the current thread uses, 0 means max_concurrency()
+thread_local int intra_op_num_threads = 0;
+
+cinn_parallel_backend_t GetBackendFromFlag() {
+  if (FLAGS_cinn_parallel_backend == "thread_pool") return cinn_parallel_backend_thread_pool;
+  CHECK_EQ(FLAGS_cinn_parallel_backend, "openmp") << "Unknown parallel backend " << FLAGS_cinn_parallel_backend;
+  return cinn_parallel_backend_openmp;
+}
+
+std::atomic<int>& ParallelBackend() {
+  static std::atomic<int> backend(GetBackendFromFlag());
+  return backend;
+}
+}  // namespace
+
 int max_concurrency() {
   int max_concurrency = 1;
   const char* val     = getenv("CINN_NUM_THREADS");
@@ -39,12 +63,29 @@ int max_concurrency() {
   return std::max(max_concurrency, 1);
 }
 
+void cinn_set_intra_op_num_threads(int num_threads) { intra_op_num_threads = std::max(num_threads, 0); }
+
+int cinn_get_intra_op_num_threads() { return intra_op_num_threads; }
+
+void cinn_set_parallel_backend(cinn_parallel_backend_t backend) { ParallelBackend() = backend; }
+
 int cinn_backend_parallel_launch(FCINNParallelLambda flambda, void* datas, int num_task) {
-  int num_workers = max_concurrency();
+  int num_workers = intra_op_num_threads > 0 ? intra_op_num_threads : max_concurrency();
   if (num_task == 0) num_task = num_workers;
+  // the threads of the launch are bound to the cpus set by cinn::runtime::cpu::ScopedThreadConfig
+  auto& affinity = cinn::runtime::cpu::CurrentThreadAffinity();
+  if (ParallelBackend() == cinn_parallel_backend_thread_pool) {
+    auto* pool = affinity.pool_threads > 0
+                     ? cinn::runtime::cpu::ThreadPool::ForCurrentThread(
+                           affinity.cpus ? *affinity.cpus : std::vector<int>(), affinity.pool_threads)
+                     : cinn::runtime::cpu::ThreadPool::Global();
+    pool->Launch(flambda, datas, num_task, intra_op_num_threads);
+    return 0;
+  }
   omp_set_num_threads(num_task);
 #pragma omp parallel num_threads(num_task)
   {
+    cinn::runtime::cpu::ApplyThreadAffinity(affinity);
     int thread_num = omp_get_thread_num();
     (*flambda)(thread_num, num_task, datas);
   }
@@ -23,6 +23,28 @@ extern "C" {
 
 int max_concurrency();
 
+/**
+ * @brief Limit the number of threads used by the parallel jobs launched from the calling thread, so that the
+ * threads running instructions concurrently share the thread budget of max_concurrency().
+ * @param num_threads The number of threads, 0 means no limit.
+ */
+void cinn_set_intra_op_num_threads(int num_threads);
+
+/**
+ * @brief The number of threads set by cinn_set_intra_op_num_threads on the calling thread, 0 means no limit.
+ */
+int cinn_get_intra_op_num_threads();
+
+typedef enum cinn_parallel_backend_t {
+  cinn_parallel_backend_openmp      = 0,  // an OpenMP parallel region for each launch
+  cinn_parallel_backend_thread_pool = 1,  // the persistent threads of cinn::runtime::cpu::ThreadPool
+} cinn_parallel_backend_t;
+
+/**
+ * @brief Select the backend running the parallel jobs, which is decided by FLAGS_cinn_parallel_backend by default.
+ */
+void cinn_set_parallel_backend(cinn_parallel_backend_t backend);
+
 /**
  * @brief The callback function to execute a parallel lambda
  * @param task_id the task id of the function.
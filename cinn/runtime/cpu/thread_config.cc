@@ -0,0 +1,172 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/runtime/cpu/thread_config.h"
+
+#include <glog/logging.h>
+#include <omp.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#ifdef CINN_WITH_MKL_CBLAS
+#include <mkl_service.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "cinn/runtime/cpu/thread_backend.h"
+#include "cinn/runtime/cpu/thread_pool.h"
+#include "cinn/utils/multi_threading.h"
+
+namespace cinn {
+namespace runtime {
+namespace cpu {
+
+namespace {
+
+thread_local ThreadAffinity current_affinity;
+// the id of the affinity the calling thread is bound by
+thread_local uint64_t applied_affinity_id = 0;
+
+uint64_t NextAffinityId() {
+  static std::atomic<uint64_t> next_id(1);
+  return next_id++;
+}
+
+#ifdef __linux__
+// the affinity of the process when it starts, restored by binding a thread to no specific cpus
+const cpu_set_t& ProcessCpuSet() {
+  static const cpu_set_t cpuset = []() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &set) != 0) {
+      LOG(WARNING) << "Failed to get the affinity of the process, all the cpus are used instead";
+      for (int cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) CPU_SET(cpu, &set);
+    }
+    return set;
+  }();
+  return cpuset;
+}
+
+// capture the affinity when the library is loaded, before any thread is bound by a ScopedThreadConfig
+const bool process_cpu_set_captured = (ProcessCpuSet(), true);
+#endif
+
+}  // namespace
+
+std::vector<int> ThreadConfig::GetCpus() const {
+  if (!cpus.empty() || numa_node < 0) {
+    return cpus;
+  }
+  std::string path = "/sys/devices/system/node/node" + std::to_string(numa_node) + "/cpulist";
+  std::ifstream ifs(path);
+  CHECK(ifs.is_open()) << "Failed to read the cpus of NUMA node " << numa_node << " from " << path;
+  std::string cpulist;
+  std::getline(ifs, cpulist);
+  return ParseCpuList(cpulist, 0);
+}
+
+int ThreadConfig::GetIntraOpNumThreads() const {
+  if (intra_op_num_threads > 0) {
+    return intra_op_num_threads;
+  }
+  auto bound_cpus = GetCpus();
+  int budget      = bound_cpus.empty() ? max_concurrency() : bound_cpus.size();
+  return std::max(budget / std::max(inter_op_num_threads, 1), 1);
+}
+
+ScopedThreadConfig::ScopedThreadConfig(const ThreadConfig& config) : cpus_(config.GetCpus()) {
+  int num_threads = config.GetIntraOpNumThreads();
+
+  prev_intra_op_num_threads_ = cinn_get_intra_op_num_threads();
+  cinn_set_intra_op_num_threads(num_threads);
+  prev_max_threads_     = utils::SetThreadLocalMaxThreads(num_threads);
+  prev_omp_num_threads_ = omp_get_max_threads();
+  // oneDNN runs by OpenMP, and the threads of its parallel regions follow the calling thread
+  omp_set_num_threads(num_threads);
+#ifdef CINN_WITH_MKL_CBLAS
+  prev_mkl_num_threads_ = mkl_set_num_threads_local(num_threads);
+#endif
+
+  prev_affinity_id_   = current_affinity.id;
+  prev_affinity_cpus_ = current_affinity.cpus;
+  prev_pool_threads_  = current_affinity.pool_threads;
+  // each thread under the config launches on a pool of its own, as the inter-op threads run kernels concurrently
+  current_affinity.pool_threads = num_threads;
+  if (!cpus_.empty()) {
+    current_affinity.id   = NextAffinityId();
+    current_affinity.cpus = &cpus_;
+    SetCurrentThreadCpus(cpus_, &prev_cpus_);
+  }
+}
+
+ScopedThreadConfig::~ScopedThreadConfig() {
+  if (!cpus_.empty()) {
+    SetCurrentThreadCpus(prev_cpus_);
+    current_affinity.id   = prev_affinity_id_;
+    current_affinity.cpus = prev_affinity_cpus_;
+  }
+  current_affinity.pool_threads = prev_pool_threads_;
+#ifdef CINN_WITH_MKL_CBLAS
+  mkl_set_num_threads_local(prev_mkl_num_threads_);
+#endif
+  omp_set_num_threads(prev_omp_num_threads_);
+  utils::SetThreadLocalMaxThreads(prev_max_threads_);
+  cinn_set_intra_op_num_threads(prev_intra_op_num_threads_);
+}
+
+const ThreadAffinity& CurrentThreadAffinity() { return current_affinity; }
+
+void ApplyThreadAffinity(const ThreadAffinity& affinity) {
+  if (applied_affinity_id == affinity.id) {
+    return;
+  }
+  SetCurrentThreadCpus(affinity.cpus ? *affinity.cpus : std::vector<int>());
+  applied_affinity_id = affinity.id;
+}
+
+void SetCurrentThreadCpus(const std::vector<int>& cpus, std::vector<int>* prev_cpus) {
+#ifdef __linux__
+  cpu_set_t cpuset;
+  if (prev_cpus) {
+    prev_cpus->clear();
+    CPU_ZERO(&cpuset);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) == 0) {
+      for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &cpuset)) prev_cpus->push_back(cpu);
+      }
+    }
+  }
+
+  if (cpus.empty()) {
+    cpuset = ProcessCpuSet();
+  } else {
+    CPU_ZERO(&cpuset);
+    for (int cpu : cpus) CPU_SET(cpu, &cpuset);
+  }
+  if (sched_setaffinity(0, sizeof(cpu_set_t), &cpuset) != 0) {
+    LOG(WARNING) << "Failed to bind the thread to cpus";
+  }
+#else
+  LOG_FIRST_N(WARNING, 1) << "Binding threads to cpus is only supported on Linux";
+#endif
+}
+
+}  // namespace cpu
+}  // namespace runtime
+}  // namespace cinn
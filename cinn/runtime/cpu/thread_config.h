@@ -0,0 +1,88 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace cinn {
+namespace runtime {
+namespace cpu {
+
+/**
+ * ThreadConfig describes the threads a program may use on X86, so that the models co-located on one machine do not
+ * oversubscribe the cores. It is applied to all the parallel backends: the parallel loops of kernels by OpenMP or
+ * the thread pool, MKL and oneDNN, and utils::parallel_run.
+ */
+struct ThreadConfig {
+  // the threads running the parallel loops of one kernel, 0 means dividing the cpus among the inter-op threads
+  int intra_op_num_threads{0};
+  // the threads running independent instructions concurrently, 1 means running instructions in order
+  int inter_op_num_threads{1};
+  // the cpus the threads are bound to, empty means no binding
+  std::vector<int> cpus;
+  // the NUMA node whose cpus the threads are bound to if cpus is empty, -1 means no binding
+  int numa_node{-1};
+
+  // the cpus to bind the threads to, from cpus or the NUMA node
+  std::vector<int> GetCpus() const;
+
+  // the threads of one kernel, which is the number of bound cpus or max_concurrency() divided by the inter-op threads
+  // unless intra_op_num_threads is set
+  int GetIntraOpNumThreads() const;
+};
+
+/**
+ * ScopedThreadConfig applies a ThreadConfig to the calling thread until it is destroyed, and restores the previous
+ * settings then. The calling thread is bound to the cpus of the config, and the kernels it runs use the intra-op
+ * threads bound to the same cpus.
+ */
+class ScopedThreadConfig {
+ public:
+  explicit ScopedThreadConfig(const ThreadConfig& config);
+  ~ScopedThreadConfig();
+
+ private:
+  std::vector<int> cpus_;
+  int prev_intra_op_num_threads_;
+  int prev_max_threads_;
+  int prev_omp_num_threads_;
+  int prev_mkl_num_threads_{0};
+  std::vector<int> prev_cpus_;
+  uint64_t prev_affinity_id_;
+  const std::vector<int>* prev_affinity_cpus_;
+  int prev_pool_threads_;
+};
+
+// the affinity set by ScopedThreadConfig on the calling thread, which the parallel backends apply to their threads
+struct ThreadAffinity {
+  // 0 means no binding, each ScopedThreadConfig binding cpus has an id of its own
+  uint64_t id{0};
+  const std::vector<int>* cpus{nullptr};
+  // the threads of the pool owned by each thread running kernels, 0 means ThreadPool::Global()
+  int pool_threads{0};
+};
+const ThreadAffinity& CurrentThreadAffinity();
+
+// bind the calling thread to the cpus of \p affinity, it is a no-op if the thread is bound by the same affinity
+void ApplyThreadAffinity(const ThreadAffinity& affinity);
+
+// bind the calling thread to \p cpus, empty means the cpus the process is allowed to run on when it starts, which
+// may be limited by taskset or cgroups, and return the previous cpus if not null
+void SetCurrentThreadCpus(const std::vector<int>& cpus, std::vector<int>* prev_cpus = nullptr);
+
+}  // namespace cpu
+}  // namespace runtime
+}  // namespace cinn
@@ -0,0 +1,222 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/runtime/cpu/thread_pool.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "cinn/runtime/cpu/thread_backend.h"
+#include "cinn/utils/string.h"
+
+DECLARE_string(cinn_thread_pool_affinity);
+
+namespace cinn {
+namespace runtime {
+namespace cpu {
+
+namespace {
+
+// whether the current thread is running the tasks of a launch
+thread_local bool in_parallel_task = false;
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64)
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+// the low bits of the generation hold the number of threads running the launch
+constexpr int kParticipantBits = 16;
+
+void BindToCpu(std::thread* thread, int cpu) {
+#ifdef __linux__
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu, &cpuset);
+  int ret = pthread_setaffinity_np(thread->native_handle(), sizeof(cpu_set_t), &cpuset);
+  if (ret != 0) {
+    LOG(WARNING) << "Failed to bind the thread pool worker to cpu " << cpu << ", error code: " << ret;
+  }
+#else
+  LOG(WARNING) << "Binding threads to cpus is only supported on Linux";
+#endif
+}
+
+}  // namespace
+
+ThreadPool::ThreadPool(int num_threads, const std::vector<int>& cpus, int spin_count) : spin_count_(spin_count) {
+  CHECK_GT(num_threads, 0) << "The thread pool should have at least one thread";
+  CHECK_LT(num_threads, 1 << kParticipantBits) << "Too many threads for the thread pool";
+  for (int i = 0; i + 1 < num_threads; ++i) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    if (!cpus.empty()) {
+      BindToCpu(&workers_.back(), cpus[(i + 1) % cpus.size()]);
+    }
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  stop_ = true;
+  {
+    std::lock_guard<std::mutex> lock(park_mtx_);
+    park_cv_.notify_all();
+  }
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+ThreadPool* ThreadPool::Global() {
+  static ThreadPool pool(max_concurrency(), ParseCpuList(FLAGS_cinn_thread_pool_affinity, max_concurrency()));
+  return &pool;
+}
+
+ThreadPool* ThreadPool::ForCurrentThread(const std::vector<int>& cpus, int num_threads) {
+  thread_local std::map<std::pair<std::vector<int>, int>, std::unique_ptr<ThreadPool>> pools;
+  auto& pool = pools[std::make_pair(cpus, num_threads)];
+  if (!pool) {
+    pool.reset(new ThreadPool(num_threads));
+  }
+  return pool.get();
+}
+
+void ThreadPool::Launch(Lambda flambda, void* datas, int num_task, int max_threads) {
+  int num_participants = std::min(num_task, num_threads());
+  if (max_threads > 0) {
+    num_participants = std::min(num_participants, max_threads);
+  }
+
+  std::unique_lock<std::mutex> lock(launch_mtx_, std::defer_lock);
+  if (in_parallel_task || num_participants <= 1 || !lock.try_lock()) {
+    bool nested      = in_parallel_task;
+    in_parallel_task = true;
+    for (int task_id = 0; task_id < num_task; ++task_id) {
+      (*flambda)(task_id, num_task, datas);
+    }
+    in_parallel_task = nested;
+    return;
+  }
+
+  flambda_  = flambda;
+  datas_    = datas;
+  num_task_ = num_task;
+  next_task_.store(0, std::memory_order_relaxed);
+  num_running_.store(num_participants - 1, std::memory_order_relaxed);
+  // only the launcher holding launch_mtx_ writes the generation
+  generation_.store((((generation_.load() >> kParticipantBits) + 1) << kParticipantBits) | num_participants);
+  if (num_parked_ > 0) {
+    std::lock_guard<std::mutex> park_lock(park_mtx_);
+    park_cv_.notify_all();
+  }
+
+  in_parallel_task = true;
+  RunTasks();
+  in_parallel_task = false;
+
+  for (int spins = 0; num_running_.load(std::memory_order_acquire) > 0; ++spins) {
+    if (spins < spin_count_) {
+      CpuRelax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void ThreadPool::RunTasks() {
+  while (true) {
+    int task_id = next_task_.fetch_add(1, std::memory_order_relaxed);
+    if (task_id >= num_task_) {
+      break;
+    }
+    (*flambda_)(task_id, num_task_, datas_);
+  }
+}
+
+void ThreadPool::WorkerLoop(int worker_id) {
+  uint64_t seen = 0;
+  while (true) {
+    uint64_t generation = generation_.load();
+    for (int spins = 0; generation == seen && !stop_; generation = generation_.load()) {
+      if (++spins < spin_count_) {
+        CpuRelax();
+        continue;
+      }
+      // park until the next launch, the launcher wakes up the parked workers after increasing generation_
+      std::unique_lock<std::mutex> lock(park_mtx_);
+      ++num_parked_;
+      park_cv_.wait(lock, [this, seen] { return generation_.load() != seen || stop_; });
+      --num_parked_;
+      spins = 0;
+    }
+    if (stop_) {
+      return;
+    }
+
+    seen = generation;
+    // the workers beyond the participants of the launch skip it, the fields of the launch are only read by the
+    // participants, which the launcher waits for before the next launch
+    int num_participants = generation & ((1 << kParticipantBits) - 1);
+    if (worker_id + 1 < num_participants) {
+      in_parallel_task = true;
+      RunTasks();
+      in_parallel_task = false;
+      num_running_.fetch_sub(1, std::memory_order_release);
+    }
+  }
+}
+
+std::vector<int> ParseCpuList(const std::string& cpus, int num_threads) {
+  std::vector<int> res;
+  if (cpus.empty()) {
+    return res;
+  }
+  if (cpus == "compact") {
+    for (int i = 0; i < num_threads; ++i) {
+      res.push_back(i);
+    }
+    return res;
+  }
+  for (auto& item : utils::Split(cpus, ",")) {
+    auto pos = item.find('-');
+    if (pos == std::string::npos) {
+      res.push_back(std::stoi(item));
+      continue;
+    }
+    int begin = std::stoi(item.substr(0, pos)), end = std::stoi(item.substr(pos + 1));
+    CHECK_LE(begin, end) << "Invalid cpu range " << item << " in " << cpus;
+    for (int cpu = begin; cpu <= end; ++cpu) {
+      res.push_back(cpu);
+    }
+  }
+  return res;
+}
+
+}  // namespace cpu
+}  // namespace runtime
+}  // namespace cinn
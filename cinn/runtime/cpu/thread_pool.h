@@ -0,0 +1,103 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cinn {
+namespace runtime {
+namespace cpu {
+
+/**
+ * ThreadPool runs the parallel loops of kernels by persistent workers instead of opening a parallel region on every
+ * launch. The idle workers poll for a new launch for a while before parking, so that the short parallel loops
+ * following each other do not pay for waking up threads. The calling thread runs tasks as well.
+ *
+ * A launch from inside a task, or while the pool is busy with a launch from another thread, runs its tasks serially
+ * in the calling thread, so nested parallel loops never oversubscribe the cores.
+ */
+class ThreadPool {
+ public:
+  using Lambda = int (*)(int task_id, int num_task, void* datas);
+
+  static constexpr int kDefaultSpinCount = 20000;
+
+  /**
+   * @param num_threads The number of threads running the tasks of a launch, including the calling thread.
+   * @param cpus The cpus to bind the workers to, the i-th worker is bound to cpus[(i + 1) % cpus.size()] and cpus[0]
+   * is left to the calling thread. Empty means no binding.
+   * @param spin_count The times an idle worker polls for a new launch before parking.
+   */
+  explicit ThreadPool(int num_threads, const std::vector<int>& cpus = {}, int spin_count = kDefaultSpinCount);
+  ~ThreadPool();
+
+  // the pool of max_concurrency() threads bound by FLAGS_cinn_thread_pool_affinity
+  static ThreadPool* Global();
+
+  /**
+   * The pool of \p num_threads threads owned by the calling thread, which is created on the first call and shared by
+   * the later launches of the thread, so that the threads running kernels concurrently do not serialize on one pool.
+   * The workers inherit the affinity of the calling thread when the pool is created, which is bound to \p cpus.
+   */
+  static ThreadPool* ForCurrentThread(const std::vector<int>& cpus, int num_threads);
+
+  /**
+   * Run flambda(task_id, num_task, datas) for each task_id in [0, num_task), and return after all of them finished.
+   * @param max_threads The max number of threads running the tasks, 0 means all the threads of the pool.
+   */
+  void Launch(Lambda flambda, void* datas, int num_task, int max_threads = 0);
+
+  int num_threads() const { return workers_.size() + 1; }
+
+ private:
+  void WorkerLoop(int worker_id);
+  void RunTasks();
+
+  const int spin_count_;
+  std::vector<std::thread> workers_;
+  // the pool runs one launch at a time
+  std::mutex launch_mtx_;
+
+  // the current launch, which is published to the workers by increasing generation_
+  Lambda flambda_{nullptr};
+  void* datas_{nullptr};
+  int num_task_{0};
+  std::atomic<int> next_task_{0};
+  // the workers which have not finished the current launch
+  std::atomic<int> num_running_{0};
+  // the count of launches, and the number of threads running the current launch in the low bits
+  std::atomic<uint64_t> generation_{0};
+  std::atomic<bool> stop_{false};
+
+  std::mutex park_mtx_;
+  std::condition_variable park_cv_;
+  std::atomic<int> num_parked_{0};
+};
+
+/**
+ * Parse the cpus to bind threads to, which is "compact" for the cpus from 0 to num_threads - 1, or a list like
+ * "0-3,8,10". Empty means no binding.
+ */
+std::vector<int> ParseCpuList(const std::string& cpus, int num_threads);
+
+}  // namespace cpu
+}  // namespace runtime
+}  // namespace cinn
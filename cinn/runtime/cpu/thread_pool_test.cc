@@ -0,0 +1,203 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cinn/runtime/cpu/thread_pool.h"
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "cinn/runtime/cpu/thread_backend.h"
+#include "cinn/runtime/cpu/thread_config.h"
+#include "cinn/utils/multi_threading.h"
+#include "cinn/utils/timer.h"
+
+namespace cinn {
+namespace runtime {
+namespace cpu {
+
+int CountTask(int task_id, int num_task, void* datas) {
+  auto* counts = static_cast<std::vector<std::atomic<int>>*>(datas);
+  (*counts)[task_id].fetch_add(1);
+  return 0;
+}
+
+int NestedLaunch(int task_id, int num_task, void* datas) {
+  // the nested launch runs serially in the calling thread
+  cinn_backend_parallel_launch(&CountTask, datas, num_task);
+  return 0;
+}
+
+int EmptyTask(int task_id, int num_task, void* datas) { return 0; }
+
+struct RendezvousData {
+  std::atomic<int>* started{nullptr};
+  int expected{0};
+  std::mutex mtx;
+  std::set<std::thread::id> threads;
+};
+
+// wait for the tasks of all the launches to start, so that the task returns in time only if they run concurrently
+int RendezvousTask(int task_id, int num_task, void* datas) {
+  auto* data    = static_cast<RendezvousData*>(datas);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  data->started->fetch_add(1);
+  while (data->started->load() < data->expected && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+  std::lock_guard<std::mutex> lock(data->mtx);
+  data->threads.insert(std::this_thread::get_id());
+  return 0;
+}
+
+TEST(ThreadPool, Launch) {
+  ThreadPool pool(4);
+  std::vector<std::atomic<int>> counts(100);
+  for (int round = 0; round < 1000; ++round) {
+    pool.Launch(&CountTask, &counts, counts.size(), round % 5);
+  }
+  for (auto& count : counts) {
+    ASSERT_EQ(count.load(), 1000);
+  }
+}
+
+TEST(ThreadPool, Nested) {
+  cinn_set_parallel_backend(cinn_parallel_backend_thread_pool);
+  std::vector<std::atomic<int>> counts(16);
+  cinn_backend_parallel_launch(&NestedLaunch, &counts, counts.size());
+  for (auto& count : counts) {
+    ASSERT_EQ(count.load(), counts.size());
+  }
+  cinn_set_parallel_backend(cinn_parallel_backend_openmp);
+}
+
+TEST(ThreadPool, ParseCpuList) {
+  ASSERT_TRUE(ParseCpuList("", 4).empty());
+  ASSERT_EQ(ParseCpuList("compact", 3), std::vector<int>({0, 1, 2}));
+  ASSERT_EQ(ParseCpuList("0-2,5,8-9", 4), std::vector<int>({0, 1, 2, 5, 8, 9}));
+}
+
+TEST(ThreadConfig, GetIntraOpNumThreads) {
+  ThreadConfig config;
+  config.inter_op_num_threads = 2;
+  config.cpus                 = {0, 1, 2, 3, 4, 5};
+  ASSERT_EQ(config.GetIntraOpNumThreads(), 3);
+  config.inter_op_num_threads = 8;
+  ASSERT_EQ(config.GetIntraOpNumThreads(), 1);
+  config.intra_op_num_threads = 4;
+  ASSERT_EQ(config.GetIntraOpNumThreads(), 4);
+}
+
+TEST(ThreadConfig, ScopedThreadConfig) {
+  ThreadConfig config;
+  config.intra_op_num_threads = 2;
+  config.cpus                 = {0};
+  {
+    ScopedThreadConfig thread_config(config);
+    ASSERT_EQ(cinn_get_intra_op_num_threads(), 2);
+    ASSERT_EQ(utils::GetThreadLocalMaxThreads(), 2);
+    ASSERT_EQ(CurrentThreadAffinity().cpus->size(), 1);
+
+    // the launch runs by the thread pool bound to the cpus of the config
+    cinn_set_parallel_backend(cinn_parallel_backend_thread_pool);
+    std::vector<std::atomic<int>> counts(8);
+    cinn_backend_parallel_launch(&CountTask, &counts, counts.size());
+    for (auto& count : counts) {
+      ASSERT_EQ(count.load(), 1);
+    }
+    cinn_set_parallel_backend(cinn_parallel_backend_openmp);
+  }
+  ASSERT_EQ(cinn_get_intra_op_num_threads(), 0);
+  ASSERT_EQ(utils::GetThreadLocalMaxThreads(), 0);
+  ASSERT_EQ(CurrentThreadAffinity().cpus, nullptr);
+  ASSERT_EQ(CurrentThreadAffinity().pool_threads, 0);
+}
+
+TEST(ThreadConfig, InterOpThreadPools) {
+  ThreadConfig config;
+  config.intra_op_num_threads = 2;
+  config.inter_op_num_threads = 2;
+  cinn_set_parallel_backend(cinn_parallel_backend_thread_pool);
+  // the kernels launched concurrently by the inter-op threads run on the intra-op threads of each of them
+  std::atomic<int> started{0};
+  std::vector<RendezvousData> datas(config.inter_op_num_threads);
+  std::vector<std::thread> threads;
+  for (auto& data : datas) {
+    data.started  = &started;
+    data.expected = config.inter_op_num_threads * config.intra_op_num_threads;
+    threads.emplace_back([&config, &data]() {
+      ScopedThreadConfig thread_config(config);
+      cinn_backend_parallel_launch(&RendezvousTask, &data, config.intra_op_num_threads);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(started.load(), config.inter_op_num_threads * config.intra_op_num_threads);
+  for (auto& data : datas) {
+    ASSERT_EQ(data.threads.size(), config.intra_op_num_threads);
+  }
+  cinn_set_parallel_backend(cinn_parallel_backend_openmp);
+}
+
+#ifdef __linux__
+TEST(ThreadConfig, RestoreProcessAffinity) {
+  cpu_set_t process_cpuset;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &process_cpuset), 0);
+  // binding a thread to no specific cpus restores the affinity of the process rather than all the cpus
+  std::thread thread([&process_cpuset]() {
+    cpu_set_t cpuset;
+    SetCurrentThreadCpus({0});
+    ASSERT_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &cpuset), 0);
+    ASSERT_EQ(CPU_COUNT(&cpuset), 1);
+    SetCurrentThreadCpus({});
+    ASSERT_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &cpuset), 0);
+    ASSERT_TRUE(CPU_EQUAL(&cpuset, &process_cpuset));
+  });
+  thread.join();
+}
+#endif
+
+// compare the overhead of launching an empty parallel job by the backends
+TEST(ThreadPool, LaunchOverhead) {
+  constexpr int kRepeat = 10000;
+  utils::Timer timer;
+  for (auto backend : {cinn_parallel_backend_openmp, cinn_parallel_backend_thread_pool}) {
+    cinn_set_parallel_backend(backend);
+    for (int i = 0; i < 100; ++i) {
+      cinn_backend_parallel_launch(&EmptyTask, nullptr, 0);
+    }
+    timer.Start();
+    for (int i = 0; i < kRepeat; ++i) {
+      cinn_backend_parallel_launch(&EmptyTask, nullptr, 0);
+    }
+    double us = timer.Stop() * 1000 / kRepeat;
+    LOG(INFO) << (backend == cinn_parallel_backend_openmp ? "openmp" : "thread_pool") << " launches with "
+              << max_concurrency() << " threads in " << us << " us";
+  }
+  cinn_set_parallel_backend(cinn_parallel_backend_openmp);
+}
+
+}  // namespace cpu
+}  // namespace runtime
+}  // namespace cinn
@@ -42,6 +42,76 @@ DEFINE_int32(cinn_parallel_compile_thread,
              Int32FromEnv("FLAGS_cinn_parallel_compile_thread", -1),
              "How much thread the parallel compile used.");
 
+DEFINE_bool(cinn_deduplicate_groups,
+            BoolFromEnv("FLAGS_cinn_deduplicate_groups", false),
+            "Whether to compile the structurally identical fusion groups once and share the function among them.");
+
+DEFINE_string(cinn_parallel_backend,
+              StringFromEnv("FLAGS_cinn_parallel_backend", "openmp"),
+              "The backend running the parallel loops of kernels on X86, \"openmp\" opens an OpenMP parallel region on "
+              "every launch, and \"thread_pool\" runs them by a pool of persistent threads.");
+
+DEFINE_string(cinn_thread_pool_affinity,
+              StringFromEnv("FLAGS_cinn_thread_pool_affinity", ""),
+              "The cpus to bind the threads of the thread_pool parallel backend to, \"compact\" binds them to the cpus "
+              "from 0, or a list like \"0-3,8\" binds them in order. Empty means no binding.");
+
+DEFINE_bool(cinn_x86_caching_allocator,
+            BoolFromEnv("FLAGS_cinn_x86_caching_allocator", false),
+            "Whether to cache the freed host memory in size classes for reuse instead of returning it to the system. "
+            "The cached memory is only released by MemoryInterface::Trim, so it is off by default.");
+
+DEFINE_int32(cinn_inter_op_num_threads,
+             Int32FromEnv("FLAGS_cinn_inter_op_num_threads", 1),
+             "The number of threads running independent instructions of a program concurrently on X86, "
+             "the threads of kernels are divided from the thread budget. 1 means running instructions in order.");
+
+DEFINE_bool(cinn_load_params_by_mmap,
+            BoolFromEnv("FLAGS_cinn_load_params_by_mmap", false),
+            "Whether to map the parameter files of paddle models into memory and let the parameters on X86 refer to "
+            "the mapped pages rather than copying them, the pages are shared by the processes loading the same model.");
+
+DEFINE_int32(cinn_load_params_num_threads,
+             Int32FromEnv("FLAGS_cinn_load_params_num_threads", 1),
+             "The number of threads reading the combined parameter file of paddle models, -1 means the hardware "
+             "concurrency and 1 means reading it sequentially. When it is not 1, the program is built from the model "
+             "while the parameters are streaming in.");
+
+DEFINE_string(cinn_compilation_cache_dir,
+              StringFromEnv("FLAGS_cinn_compilation_cache_dir", ""),
+              "Specify the directory to persist the compiled object code of graphs across processes, "
+              "an empty value disables the compilation cache. Only works on X86 target now.");
+
+DEFINE_string(cinn_llvm_object_cache_dir,
+              StringFromEnv("FLAGS_cinn_llvm_object_cache_dir", ""),
+              "Specify the directory to persist the object code compiled by LLVM on X86 across processes, which is "
+              "keyed by the hash of the LLVM IR and the target. An empty value disables the object cache.");
+
+DEFINE_int32(cinn_llvm_object_cache_max_size_mb,
+             Int32FromEnv("FLAGS_cinn_llvm_object_cache_max_size_mb", 1024),
+             "The max size in MB of the LLVM object cache directory, the least recently used objects are evicted "
+             "beyond it.");
+
+DEFINE_int32(cinn_x86_vector_bits,
+             Int32FromEnv("FLAGS_cinn_x86_vector_bits", 0),
+             "The width in bits of the vectors which the kernels on X86 are vectorized to, e.g. 256 to keep AVX-512 "
+             "hosts on AVX2 to avoid the frequency drop. 0 means the widest one supported by the host CPU.");
+
+DEFINE_bool(cinn_llvm_perf_jitdump,
+            BoolFromEnv("FLAGS_cinn_llvm_perf_jitdump", false),
+            "Whether to write the functions compiled by the LLVM JIT into the jitdump files of Linux perf, which are "
+            "merged into the profile by `perf inject --jit`. It requires LLVM built with LLVM_USE_PERF.");
+
+DEFINE_bool(cinn_llvm_gdb_registration,
+            BoolFromEnv("FLAGS_cinn_llvm_gdb_registration", false),
+            "Whether to register the objects compiled by the LLVM JIT to GDB, so that GDB resolves the frames of "
+            "kernels.");
+
+DEFINE_bool(cinn_llvm_perf_map,
+            BoolFromEnv("FLAGS_cinn_llvm_perf_map", false),
+            "Whether to append the functions compiled by the LLVM JIT to /tmp/perf-<pid>.map, which Linux perf reads "
+            "to symbolize the samples in kernels.");
+
 DEFINE_bool(cinn_use_op_fusion, BoolFromEnv("FLAGS_cinn_use_op_fusion", true), "Whether to use op fusion pass.");
 
 DEFINE_bool(cinn_use_common_subexpression_elimination,
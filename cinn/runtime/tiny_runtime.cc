@@ -12,12 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "tiny_runtime.h"
+
 #include <dlfcn.h>
+#include <fcntl.h>
 #include <omp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -25,37 +32,56 @@
 
 extern "C" {
 int max_num_workers = std::thread::hardware_concurrency();
+
+typedef void (*func_t)(cinn_pod_value_t *, int);
+
 // move to standlone file
 struct param_context_t {
+  ~param_context_t() {
+    if (map_addr) munmap(map_addr, map_size);
+    if (lib_handle) dlclose(lib_handle);
+  }
+
   int major_v;
   int minor_v;
-  std::vector<uint8_t> buf;
+  // the param file mapped privately, the pages of the parameters are shared by the processes loading the same file,
+  // only the pages of the pointers patched when loaded are copied
+  void *map_addr{nullptr};
+  size_t map_size{0};
+  // the shared library holding the kernels, the symbols of the process are used if it is null
+  void *lib_handle{nullptr};
   std::vector<std::vector<uint8_t>> temporary;
   std::map<std::string, cinn_pod_value_t> name2podvalue;
   std::vector<std::string> instructions;
+  std::vector<func_t> funcs;
   std::vector<int> inst_argc;
   std::vector<cinn_pod_value_t *> inst_argv;
 };
 
-void *load_program(const char *paramfile) {
-  FILE *f = fopen(paramfile, "r");
-  fseek(f, 0, SEEK_END);
-  int fsize = ftell(f);
-  rewind(f);
-  if (fsize < 32) {
-    fclose(f);
+// take the ownership of lib_handle, which is closed along with the context, including on failures
+static void *load_program_impl(void *lib_handle, const char *paramfile) {
+  std::unique_ptr<param_context_t> ctx(new param_context_t{});
+  ctx->lib_handle = lib_handle;
+
+  int fd = open(paramfile, O_RDONLY);
+  if (fd < 0) {
     return nullptr;
   }
-
-  std::unique_ptr<param_context_t> ctx(new param_context_t{});
-  int alignment = std::max(alignof(cinn_pod_value_t), alignof(cinn_buffer_t));
-  ctx->buf.resize(fsize + alignment);
-  uint8_t *buf = ctx->buf.data();
-  if ((uintptr_t)buf % alignment) {
-    buf = buf + alignment - ((uintptr_t)buf % alignment);
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < 32) {
+    close(fd);
+    return nullptr;
+  }
+  size_t fsize = st.st_size;
+  // the mapping is aligned to the page, which satisfies the alignment of all the sections
+  void *addr = mmap(nullptr, fsize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return nullptr;
   }
-  fread(buf, 1, fsize, f);
-  fclose(f);
+  ctx->map_addr = addr;
+  ctx->map_size = fsize;
+  uint8_t *buf  = (uint8_t *)addr;
 
   if (std::string(buf, buf + 4) != "CINN") {
     // TODO LOG fatal
@@ -104,34 +130,49 @@ void *load_program(const char *paramfile) {
   for (int i = 0; i < inst_pos[1]; i++) {
     const char *inst = (const char *)(buf + inst_pos[2 + i * 3 + 0]);
     ctx->instructions.push_back(inst);
+    // resolve the kernels once rather than in every run
+    void *sym = dlsym(lib_handle ? lib_handle : RTLD_DEFAULT, inst);
+    if (!sym) {
+      return nullptr;
+    }
+    ctx->funcs.push_back((func_t)sym);
     int instargc = inst_pos[2 + i * 3 + 1];
     ctx->inst_argc.push_back(instargc);
     cinn_pod_value_t *argv = (cinn_pod_value_t *)(buf + inst_pos[2 + i * 3 + 2]);
-    for (int i = 0; i < instargc; i++) {
-      int idx = (uintptr_t)((cinn_buffer_t *)argv[i]);
+    for (int j = 0; j < instargc; j++) {
+      int idx = (uintptr_t)((cinn_buffer_t *)argv[j]);
       cinn_value_t tmp_v;
       tmp_v.v_handle = &cb[idx];
-      argv[i].set_value(tmp_v);
+      argv[j].set_value(tmp_v);
     }
     ctx->inst_argv.push_back(argv);
   }
   return ctx.release();
 }
 
+void *load_program(const char *paramfile) { return load_program_impl(nullptr, paramfile); }
+
+void *load_program_from_library(const char *libfile, const char *paramfile) {
+  // the kernels resolve the runtime functions, such as cinn_backend_parallel_launch, from the process
+  void *lib_handle = dlopen(libfile, RTLD_NOW | RTLD_LOCAL);
+  if (!lib_handle) {
+    return nullptr;
+  }
+  return load_program_impl(lib_handle, paramfile);
+}
+
+void free_program(void *ctx) { delete (param_context_t *)ctx; }
+
 int set_maxconcurrency(int c) {
   int old_c       = max_num_workers;
   max_num_workers = c;
   return old_c;
 }
 
-typedef void (*func_t)(cinn_pod_value_t *, int);
 void run_program(void *ctx) {
   param_context_t *pc = (param_context_t *)ctx;
-  for (int i = 0; i < pc->instructions.size(); i++) {
-    const char *sym = pc->instructions[i].c_str();
-    void *p         = dlsym(RTLD_DEFAULT, sym);
-    func_t f        = (func_t)p;
-    f(pc->inst_argv[i], pc->inst_argc[i]);
+  for (int i = 0; i < pc->funcs.size(); i++) {
+    pc->funcs[i](pc->inst_argv[i], pc->inst_argc[i]);
   }
 }
 
@@ -143,6 +184,32 @@ cinn_pod_value_t *get_pod_value(void *ctx, const char *tname) {
   return nullptr;
 }
 
+void *get_tensor_data(void *ctx, const char *tname, size_t *size) {
+  cinn_pod_value_t *value = get_pod_value(ctx, tname);
+  if (!value) {
+    return nullptr;
+  }
+  cinn_buffer_t *buffer = (cinn_buffer_t *)(*value);
+  if (size) {
+    *size = buffer->memory_size;
+  }
+  return buffer->memory;
+}
+
+int set_tensor_data(void *ctx, const char *tname, void *data, size_t size) {
+  cinn_pod_value_t *value = get_pod_value(ctx, tname);
+  if (!value || !data) {
+    return -1;
+  }
+  cinn_buffer_t *buffer = (cinn_buffer_t *)(*value);
+  if (size < buffer->memory_size || (buffer->align && (uintptr_t)data % buffer->align)) {
+    return -1;
+  }
+  // the instructions refer to the buffer, so they use the new memory without being patched
+  buffer->memory = (uint8_t *)data;
+  return 0;
+}
+
 typedef int (*FCINNParallelLambda)(int task_id, int num_task, void *datas);
 int cinn_backend_parallel_launch(FCINNParallelLambda flambda, void *datas, int num_task) {
   int num_workers = max_num_workers;
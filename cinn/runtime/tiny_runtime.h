@@ -0,0 +1,66 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file This file contains the C API of the tiny runtime, which runs a program exported ahead of time on CPU without
+ * the compiler stack. A deployment consists of:
+ *  - the parameter file written by Program::Export, which is mapped into memory rather than read when loaded,
+ *  - the shared library of kernels written by GraphCompiler::ExportLibrary.
+ */
+#ifndef CINN_RUNTIME_TINY_RUNTIME_H_
+#define CINN_RUNTIME_TINY_RUNTIME_H_
+
+#include <stddef.h>
+
+#include "cinn_runtime.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! Load a program from \p paramfile, whose kernels are looked up in the symbols of the process. Return NULL on failure.
+void *load_program(const char *paramfile);
+
+//! Load a program from \p paramfile, whose kernels are in the shared library \p libfile. Return NULL on failure.
+void *load_program_from_library(const char *libfile, const char *paramfile);
+
+//! Release a program loaded by load_program or load_program_from_library.
+void free_program(void *ctx);
+
+//! Set the max number of threads running a kernel, return the previous one.
+int set_maxconcurrency(int c);
+
+//! Run all the instructions of a program in order.
+void run_program(void *ctx);
+
+//! Get the argument of the variable \p tname, NULL if it doesn't exist.
+cinn_pod_value_t *get_pod_value(void *ctx, const char *tname);
+
+/**
+ * Get the memory of the variable \p tname, to write an input into or read an output from, NULL if it doesn't exist.
+ * The number of bytes of the memory is stored in \p size if it is not NULL.
+ */
+void *get_tensor_data(void *ctx, const char *tname, size_t *size);
+
+/**
+ * Let the variable \p tname use the caller-owned memory \p data of \p size bytes without copy, which should hold the
+ * whole variable and outlive the runs using it. Return 0 on success.
+ */
+int set_tensor_data(void *ctx, const char *tname, void *data, size_t size);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // CINN_RUNTIME_TINY_RUNTIME_H_
@@ -16,6 +16,10 @@
 
 #include <glog/logging.h>  // for GLog
 
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
 #include <unordered_map>
 
 namespace cinn {
@@ -121,5 +125,106 @@ std::string Summary::AsStr(const std::vector<Item> &items, int data_width) {
   return os.str();
 }
 
+int HostEventRecorder::GetThreadId() {
+  static std::atomic<int> num_threads{0};
+  thread_local int thread_id = num_threads++;
+  return thread_id;
+}
+
+std::string KernelSummary::Format(const std::vector<HostEvent> &events) {
+  struct Item {
+    std::string name;
+    std::vector<double> durations;
+    double total{0.0};
+  };
+  std::vector<Item> items;
+  std::unordered_map<std::string, int> item_idx;
+  double total_cost     = 0.0;
+  size_t max_annot_size = 20;
+  for (auto &e : events) {
+    // PrepareArgs is recorded inside every instruction, it is not a kernel
+    if (e.type_ != EventType::kInstruction || e.annotation_ == "PrepareArgs") continue;
+    if (!item_idx.count(e.annotation_)) {
+      item_idx[e.annotation_] = items.size();
+      items.push_back({e.annotation_, {}, 0.0});
+    }
+    auto &item = items[item_idx.at(e.annotation_)];
+    item.durations.push_back(e.duration_);
+    item.total += e.duration_;
+    total_cost += e.duration_;
+    max_annot_size = std::max(max_annot_size, e.annotation_.size() + 1);
+  }
+  std::sort(items.begin(), items.end(), [](const Item &a, const Item &b) { return a.total > b.total; });
+
+  std::ostringstream os;
+  os << "\n\n------------------------->     Kernel Report     <-------------------------\n\n";
+  os << std::left << std::setw(max_annot_size) << "Name" << std::setw(10) << "Calls" << std::setw(16) << "Total(ms)"
+     << std::setw(16) << "Mean(ms)" << std::setw(16) << "P99(ms)" << std::setw(12) << "Ratio(%)" << std::setw(14)
+     << "GFLOP/s" << std::setw(14) << "GB/s"
+     << "\n\n";
+  for (auto &item : items) {
+    std::sort(item.durations.begin(), item.durations.end());
+    size_t p99_rank = static_cast<size_t>(std::ceil(0.99 * item.durations.size()));
+    double p99      = item.durations[std::max<size_t>(p99_rank, 1) - 1];
+    double mean     = item.total / item.durations.size();
+
+    std::string gflops = "-", gbytes = "-";
+    KernelCost cost;
+    if (KernelCostRegistry::Global().Find(item.name, &cost) && mean > 0.0) {
+      // mean is in ms, so cost / (mean * 1e-3) / 1e9 per second
+      gflops = std::to_string(cost.flops / mean * 1e-6);
+      gbytes = std::to_string(cost.bytes / mean * 1e-6);
+    }
+    os << std::left << std::setw(max_annot_size) << item.name << std::setw(10) << item.durations.size()
+       << std::setw(16) << std::to_string(item.total) << std::setw(16) << std::to_string(mean) << std::setw(16)
+       << std::to_string(p99) << std::setw(12) << std::to_string(item.total / total_cost * 100.0) << std::setw(14)
+       << gflops << std::setw(14) << gbytes << "\n";
+  }
+  os << "\n";
+  return os.str();
+}
+
+namespace {
+
+std::string EscapeJson(const std::string &str) {
+  std::string res;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      res.push_back('\\');
+      res.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      res.push_back(' ');
+    } else {
+      res.push_back(c);
+    }
+  }
+  return res;
+}
+
+}  // namespace
+
+std::string ChromeTrace::Format(const std::vector<HostEvent> &events) {
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  for (int i = 0; i < events.size(); ++i) {
+    auto &e = events[i];
+    if (i) os << ",";
+    // complete events, the timestamps and durations of which are in microseconds
+    os << "\n{\"name\": \"" << EscapeJson(e.annotation_) << "\", \"cat\": \"" << EventTypeToString(e.type_)
+       << "\", \"ph\": \"X\", \"ts\": " << e.start_ << ", \"dur\": " << e.duration_ * 1e3
+       << ", \"pid\": 0, \"tid\": " << e.thread_id_ << "}";
+  }
+  os << "\n]}\n";
+  return os.str();
+}
+
+void ChromeTrace::Save(const std::vector<HostEvent> &events, const std::string &path) {
+  std::ofstream ofs(path);
+  CHECK(ofs.is_open()) << "Failed to open " << path << " to save the chrome trace";
+  ofs << Format(events);
+  LOG(INFO) << "Saved " << events.size() << " events to the chrome trace " << path;
+}
+
 }  // namespace utils
 }  // namespace cinn
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -60,9 +61,51 @@ struct HostEvent {
   std::string annotation_;
   double duration_;  // ms
   EventType type_;
+  double start_;  // us since the first event of the process
+  int thread_id_;
 
-  HostEvent(const std::string& annotation, double duration, EventType type)
-      : annotation_(annotation), duration_(duration), type_(type) {}
+  HostEvent(const std::string& annotation, double duration, EventType type, double start = 0.0, int thread_id = 0)
+      : annotation_(annotation), duration_(duration), type_(type), start_(start), thread_id_(thread_id) {}
+};
+
+// the estimated cost of a lowered function for a single call
+struct KernelCost {
+  double flops{0.0};
+  double bytes{0.0};
+};
+
+/**
+ * KernelCostRegistry holds the estimated costs of lowered functions by their names, which are registered when the
+ * functions are compiled with the profiler enabled.
+ */
+class KernelCostRegistry {
+ public:
+  static KernelCostRegistry& Global() {
+    static KernelCostRegistry instance;
+    return instance;
+  }
+
+  void Register(const std::string& name, const KernelCost& cost) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    costs_[name] = cost;
+  }
+
+  bool Find(const std::string& name, KernelCost* cost) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = costs_.find(name);
+    if (it == costs_.end()) return false;
+    *cost = it->second;
+    return true;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    costs_.clear();
+  }
+
+ private:
+  mutable std::mutex mtx_;
+  std::unordered_map<std::string, KernelCost> costs_;
 };
 
 class Summary {
@@ -87,6 +130,24 @@ class Summary {
   static std::string AsStr(const std::vector<Item>& itemsm, int data_width);
 };
 
+/**
+ * KernelSummary aggregates the kInstruction events by the name of lowered function, and reports the number of
+ * calls, the total, mean and p99 cost, and the ratio in all instructions. The achieved GFLOP/s and GB/s are also
+ * reported for the functions with estimated costs in KernelCostRegistry.
+ */
+class KernelSummary {
+ public:
+  static std::string Format(const std::vector<HostEvent>& events);
+};
+
+// ChromeTrace formats the events as the JSON of Chrome trace format, viewable by chrome://tracing or Perfetto.
+class ChromeTrace {
+ public:
+  static std::string Format(const std::vector<HostEvent>& events);
+
+  static void Save(const std::vector<HostEvent>& events, const std::string& path);
+};
+
 class HostEventRecorder {
  public:
   // singleton
@@ -97,15 +158,33 @@ class HostEventRecorder {
 
   static std::string Table() { return Summary::Format(GetInstance().Events()); }
 
-  void Clear() { events_.clear(); }
+  static std::string KernelTable() { return KernelSummary::Format(GetInstance().Events()); }
 
-  std::vector<HostEvent>& Events() { return events_; }
+  static void SaveChromeTrace(const std::string& path) { ChromeTrace::Save(GetInstance().Events(), path); }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    events_.clear();
+  }
 
-  void RecordEvent(const std::string& annotation, double duration, EventType type) {
-    GetInstance().Events().emplace_back(annotation, duration, type);
+  // a snapshot of the events, which may be recorded by other threads meanwhile
+  std::vector<HostEvent> Events() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return events_;
   }
 
+  void RecordEvent(const std::string& annotation, double duration, EventType type, double start = 0.0) {
+    // events may be recorded by the instructions running concurrently
+    int thread_id = GetThreadId();
+    std::lock_guard<std::mutex> lock(mtx_);
+    events_.emplace_back(annotation, duration, type, start, thread_id);
+  }
+
+  // a small integer identifying the calling thread, in the order of the first event recorded by each thread
+  static int GetThreadId();
+
  private:
+  std::mutex mtx_;
   std::vector<HostEvent> events_;
 };
 
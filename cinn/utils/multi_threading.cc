@@ -16,6 +16,7 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <future>
 #include <thread>
 #include <utility>
@@ -40,7 +41,22 @@ int SequenceDispatcher::Next() const {
   return idx;
 }
 
+namespace {
+thread_local int thread_local_max_threads = 0;
+}  // namespace
+
+int SetThreadLocalMaxThreads(int num_threads) {
+  int prev                 = thread_local_max_threads;
+  thread_local_max_threads = std::max(num_threads, 0);
+  return prev;
+}
+
+int GetThreadLocalMaxThreads() { return thread_local_max_threads; }
+
 void parallel_run(const WorkerFuncType& fn, JobDispatcher&& dispatcher, int num_threads) {
+  if (num_threads == -1 && thread_local_max_threads > 0) {
+    num_threads = thread_local_max_threads;
+  }
   if (num_threads == -1 || num_threads > std::thread::hardware_concurrency()) {
     num_threads = std::thread::hardware_concurrency();
   }
@@ -50,11 +50,20 @@ class SequenceDispatcher : public JobDispatcher {
   mutable std::atomic<int> index_;
 };
 
+/**
+ * \brief Limit the number of threads of parallel_run called with num_threads = -1 from the calling thread, so that
+ * the jobs share the thread budget of the caller. 0 means the hardware concurrency.
+ * \return The previous limit.
+ */
+int SetThreadLocalMaxThreads(int num_threads);
+int GetThreadLocalMaxThreads();
+
 /**
  * \brief A general function to run a batch of jobs in parallel
  * \param fn A instance of WorkerFuncType, which defines how to complete a specified job
  * \param dispatcher A instance of JobDispatcher, which pops index of the next job
- * \param num_threads The number of threads used to run jobs, -1 means utilizing the maximum limit of hardware
+ * \param num_threads The number of threads used to run jobs, -1 means utilizing the maximum limit of hardware, or
+ * the limit set by SetThreadLocalMaxThreads
  */
 void parallel_run(const WorkerFuncType& fn, JobDispatcher&& dispatcher, int num_threads = -1);
 
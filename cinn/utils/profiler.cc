@@ -31,14 +31,25 @@ namespace utils {
 
 ProfilerState ProfilerHelper::g_state = ProfilerState::kDisabled;
 
+namespace {
+// the time point from which the start time of events are measured
+std::chrono::steady_clock::time_point GetEpoch() {
+  static const auto epoch = std::chrono::steady_clock::now();
+  return epoch;
+}
+}  // namespace
+
 RecordEvent::RecordEvent(const std::string& name, EventType type) {
   if (!ProfilerHelper::IsEnable()) return;
 
   if (ProfilerHelper::IsEnableCPU()) {
+    // initialize the epoch no later than the first event starts
+    GetEpoch();
     call_back_ = [this, tik = std::chrono::steady_clock::now(), annotation = std::move(name), type]() {
-      auto tok                               = std::chrono::steady_clock::now();
-      std::chrono::duration<double> duration = (tok - tik) * 1e3;  // ms
-      HostEventRecorder::GetInstance().RecordEvent(annotation, duration.count(), type);
+      auto tok                                        = std::chrono::steady_clock::now();
+      std::chrono::duration<double> duration          = (tok - tik) * 1e3;  // ms
+      std::chrono::duration<double, std::micro> start = tik - GetEpoch();
+      HostEventRecorder::GetInstance().RecordEvent(annotation, duration.count(), type, start.count());
     };
   }
 
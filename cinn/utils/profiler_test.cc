@@ -17,6 +17,8 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include <thread>
+
 TEST(RecordEvent, HOST) {
   using cinn::utils::EventType;
   using cinn::utils::HostEventRecorder;
@@ -35,7 +37,7 @@ TEST(RecordEvent, HOST) {
     while (counter != i * 1000) counter++;
   }
 
-  auto &events = HostEventRecorder::GetInstance().Events();
+  auto events = HostEventRecorder::GetInstance().Events();
   EXPECT_EQ(events.size(), 4U);
   for (int i = 0; i < 4; ++i) {
     auto &event      = events[i];
@@ -60,7 +62,7 @@ TEST(RecordEvent, HOST) {
 
   LOG(INFO) << "Usage 2: Nested RecordEvent for HOST";
   HostEventRecorder::GetInstance().Clear();
-  EXPECT_EQ(events.size(), 0U);
+  EXPECT_EQ(HostEventRecorder::GetInstance().Events().size(), 0U);
 
   for (int i = 0; i < 4; ++i) {
     std::string name = "ano_evs_op_" + std::to_string(i);
@@ -74,5 +76,47 @@ TEST(RecordEvent, HOST) {
       while (nested_counter != i * 100) nested_counter++;
     }
   }
-  EXPECT_EQ(events.size(), 8U);
-}
\ No newline at end of file
+  EXPECT_EQ(HostEventRecorder::GetInstance().Events().size(), 8U);
+}
+
+TEST(RecordEvent, KernelSummaryAndChromeTrace) {
+  using cinn::utils::ChromeTrace;
+  using cinn::utils::EventType;
+  using cinn::utils::HostEventRecorder;
+  using cinn::utils::KernelCost;
+  using cinn::utils::KernelCostRegistry;
+  using cinn::utils::ProfilerHelper;
+  using cinn::utils::RecordEvent;
+
+  ProfilerHelper::EnableCPU();
+  HostEventRecorder::GetInstance().Clear();
+  KernelCostRegistry::Global().Register("fn_add", KernelCost{1e6, 4e6});
+
+  std::thread worker([]() {
+    for (int i = 0; i < 10; ++i) {
+      RecordEvent record_event("fn_add", EventType::kInstruction);
+      RecordEvent record_args("PrepareArgs", EventType::kInstruction);
+    }
+  });
+  worker.join();
+  for (int i = 0; i < 5; ++i) {
+    RecordEvent record_event("fn_mul", EventType::kInstruction);
+  }
+
+  auto events = HostEventRecorder::GetInstance().Events();
+  ASSERT_EQ(events.size(), 25U);
+  // the events of different threads are on different timelines
+  EXPECT_NE(events.front().thread_id_, events.back().thread_id_);
+  EXPECT_LE(events.front().start_, events.back().start_);
+
+  std::string table = HostEventRecorder::KernelTable();
+  LOG(INFO) << table;
+  EXPECT_NE(table.find("fn_add"), std::string::npos);
+  EXPECT_NE(table.find("fn_mul"), std::string::npos);
+  EXPECT_EQ(table.find("PrepareArgs"), std::string::npos);
+
+  std::string trace = ChromeTrace::Format(events);
+  EXPECT_EQ(trace.find("{\"displayTimeUnit\""), 0UL);
+  EXPECT_NE(trace.find("\"name\": \"fn_mul\", \"cat\": \"Instruction\", \"ph\": \"X\""), std::string::npos);
+  HostEventRecorder::GetInstance().Clear();
+}
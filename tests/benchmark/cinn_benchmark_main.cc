@@ -0,0 +1,145 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmark a Paddle model compiled by CINN, for example:
+//   cinn_benchmark --model_dir=./resnet50 --input_names=inputs --input_shapes=1,3,224,224 \
+//                  --repeat=100 --per_instruction --json_output=resnet50.json
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "cinn/common/bfloat16.h"
+#include "cinn/common/float16.h"
+#include "cinn/common/target.h"
+#include "cinn/frontend/computation.h"
+#include "cinn/hlir/framework/program_benchmark.h"
+#include "cinn/utils/string.h"
+
+DEFINE_string(model_dir, "", "The directory of the Paddle model.");
+DEFINE_bool(params_combined, false, "Whether the parameters of the model are combined in a single file.");
+DEFINE_string(input_names, "", "The names of the inputs, separated by comma.");
+DEFINE_string(input_shapes, "", "The shapes of the inputs separated by semicolon, with dims separated by comma.");
+DEFINE_string(target, "x86", "The target to run on, x86 or nvgpu.");
+DEFINE_int32(warmup, 10, "The number of runs before measuring.");
+DEFINE_int32(repeat, 100, "The minimum number of measured runs.");
+DEFINE_double(min_time_ms, 0.0, "Keep measuring until the measured runs take at least this time in total.");
+DEFINE_bool(flush_cache, false, "Whether to flush the caches before every run.");
+DEFINE_bool(per_instruction, false, "Whether to also measure every instruction.");
+DEFINE_int32(int_input_max,
+             10,
+             "The integer inputs are filled by random values in [0, int_input_max), which should be a valid range "
+             "of the indices or ids they hold.");
+DEFINE_string(json_output, "", "The file to write the result as JSON, which is printed to stdout if empty.");
+
+namespace {
+
+template <typename T, typename DistT>
+void FillRandom(cinn::frontend::CinnComputation* computation, cinn::hlir::framework::Tensor& tensor, DistT dist) {
+  static std::mt19937 engine(0);
+  // not a std::vector, which packs bools into bits
+  size_t numel = tensor->shape().numel();
+  std::unique_ptr<T[]> data(new T[numel]);
+  for (size_t i = 0; i < numel; ++i) data[i] = static_cast<T>(dist(engine));
+  computation->SetTensorData(tensor, data.get(), numel * sizeof(T));
+}
+
+// fill an input according to its dtype, by floats in [-1, 1) or integers in [0, FLAGS_int_input_max)
+void FillInput(cinn::frontend::CinnComputation* computation, cinn::hlir::framework::Tensor& tensor) {
+  using cinn::common::Type;
+  auto type = tensor->type();
+  std::uniform_real_distribution<float> float_dist(-1.f, 1.f);
+  std::uniform_int_distribution<int64_t> int_dist(0, FLAGS_int_input_max - 1);
+  if (type.is_float(32)) {
+    FillRandom<float>(computation, tensor, float_dist);
+  } else if (type.is_float(64)) {
+    FillRandom<double>(computation, tensor, float_dist);
+  } else if (type.is_float(16, Type::specific_type_t::FP16)) {
+    FillRandom<cinn::common::float16>(computation, tensor, float_dist);
+  } else if (type.is_float(16, Type::specific_type_t::BF16)) {
+    FillRandom<cinn::common::bfloat16>(computation, tensor, float_dist);
+  } else if (type.is_bool()) {
+    FillRandom<bool>(computation, tensor, std::bernoulli_distribution(0.5));
+  } else if (type.is_int(8)) {
+    FillRandom<int8_t>(computation, tensor, int_dist);
+  } else if (type.is_int(16)) {
+    FillRandom<int16_t>(computation, tensor, int_dist);
+  } else if (type.is_int(32)) {
+    FillRandom<int32_t>(computation, tensor, int_dist);
+  } else if (type.is_int(64)) {
+    FillRandom<int64_t>(computation, tensor, int_dist);
+  } else if (type.is_uint(8)) {
+    FillRandom<uint8_t>(computation, tensor, int_dist);
+  } else {
+    LOG(FATAL) << "Filling the input of type " << type << " is not supported";
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+
+  using cinn::hlir::framework::shape_t;
+  CHECK(!FLAGS_model_dir.empty()) << "--model_dir is required";
+  auto input_names     = cinn::utils::Split(FLAGS_input_names, ",");
+  auto input_shape_str = cinn::utils::Split(FLAGS_input_shapes, ";");
+  CHECK_EQ(input_names.size(), input_shape_str.size()) << "The number of --input_names and --input_shapes differ";
+  std::vector<shape_t> input_shapes;
+  for (auto& str : input_shape_str) {
+    shape_t shape;
+    for (auto& dim : cinn::utils::Split(str, ",")) shape.push_back(std::stoi(dim));
+    input_shapes.push_back(shape);
+  }
+
+  cinn::common::Target target;
+  if (FLAGS_target == "x86") {
+    target = cinn::common::DefaultHostTarget();
+  } else if (FLAGS_target == "nvgpu") {
+    target = cinn::common::DefaultNVGPUTarget();
+  } else {
+    LOG(FATAL) << "Unsupported target " << FLAGS_target;
+  }
+
+  auto computation = cinn::frontend::CinnComputation::CompilePaddleModel(
+      target, FLAGS_model_dir, input_names, input_shapes, FLAGS_params_combined);
+  CHECK_GT(FLAGS_int_input_max, 0) << "--int_input_max should be positive";
+  for (auto& name : input_names) {
+    auto tensor = computation->GetTensor(name);
+    FillInput(computation.get(), tensor);
+  }
+
+  cinn::hlir::framework::BenchmarkOptions options;
+  options.warmup          = FLAGS_warmup;
+  options.repeat          = FLAGS_repeat;
+  options.min_time_ms     = FLAGS_min_time_ms;
+  options.flush_cache     = FLAGS_flush_cache;
+  options.per_instruction = FLAGS_per_instruction;
+  auto result             = cinn::hlir::framework::BenchmarkProgram(computation->GetRuntimeProgram(), options);
+
+  LOG(INFO) << "Benchmark of " << FLAGS_model_dir << ":\n" << result.ToString();
+  if (FLAGS_json_output.empty()) {
+    std::cout << result.ToJson() << std::endl;
+  } else {
+    std::ofstream ofs(FLAGS_json_output);
+    CHECK(ofs.is_open()) << "Failed to open " << FLAGS_json_output;
+    ofs << result.ToJson() << std::endl;
+  }
+  return 0;
+}